@@ -0,0 +1,107 @@
+/**
+ * @file buffer_pool_scaling_benchmark.cpp
+ * @author sheep
+ * @brief how fetch/unpin throughput scales with threads, single instance vs sharded buffer pool
+ * @version 0.1
+ * @date 2022-06-16
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * usage: buffer_pool_scaling_benchmark [num_instances] [page_num] [operation_num]
+ * pages live in a MemoryDiskManager, so we are measuring the buffer pool rather than the disk.
+ * "hit" workload fits in the pool, "miss" workload only has room for half of the pages.
+ */
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+// random page reads, return million operations per second
+double RunWorkload(BufferPoolManager *bpm, const std::vector<page_id_t> &page_list,
+                   int operation_num, int thread_num) {
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<std::thread> worker_list;
+    for (int i = 0; i < thread_num; i++) {
+        worker_list.emplace_back([&, i]() {
+            std::mt19937 mt(i);
+            std::uniform_int_distribution<size_t> page_dis(0, page_list.size() - 1);
+            int sum = 0;
+            for (int j = 0; j < operation_num / thread_num; j++) {
+                page_id_t page_id = page_list[page_dis(mt)];
+                auto page = bpm->FetchPage(page_id);
+                if (page == nullptr) {
+                    continue;
+                }
+                page->RLatch();
+                sum += page->GetData()[0];
+                page->RUnlatch();
+                bpm->UnpinPage(page_id, false);
+            }
+            // keep the reads alive
+            if (sum == -1) {
+                printf("%d\n", sum);
+            }
+        });
+    }
+    for (auto &worker : worker_list) {
+        worker.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = t2 - t1;
+    return operation_num / elapsed.count() / 1e6;
+}
+
+double RunBenchmark(const std::function<BufferPoolManager *(DiskManager *)> &create_bpm,
+                    int page_num, int operation_num, int thread_num) {
+    MemoryDiskManager disk_manager;
+    std::unique_ptr<BufferPoolManager> bpm(create_bpm(&disk_manager));
+
+    std::vector<page_id_t> page_list(page_num);
+    for (int i = 0; i < page_num; i++) {
+        auto page = bpm->NewPage(&page_list[i]);
+        page->GetData()[0] = static_cast<char>(i);
+        bpm->UnpinPage(page_list[i], true);
+    }
+
+    return RunWorkload(bpm.get(), page_list, operation_num, thread_num);
+}
+
+}
+
+int main(int argc, char **argv) {
+    size_t num_instances = argc > 1 ? atoi(argv[1]) : 16;
+    int page_num = argc > 2 ? atoi(argv[2]) : 4096;
+    int operation_num = argc > 3 ? atoi(argv[3]) : 2000000;
+
+    printf("pages: %d, operations: %d, instances: %zu, throughput in Mops/s\n",
+        page_num, operation_num, num_instances);
+    printf("%8s %14s %14s %14s %14s\n", "threads", "hit single", "hit parallel", "miss single", "miss parallel");
+    for (int thread_num = 1; thread_num <= 64; thread_num *= 2) {
+        double result[4];
+        int idx = 0;
+        // pool holds every page, or only half of them
+        for (size_t total_size : {static_cast<size_t>(page_num), static_cast<size_t>(page_num) / 2}) {
+            result[idx++] = TinyDB::RunBenchmark([&](TinyDB::DiskManager *disk_manager) {
+                return new TinyDB::BufferPoolManagerInstance(total_size, disk_manager);
+            }, page_num, operation_num, thread_num);
+            result[idx++] = TinyDB::RunBenchmark([&](TinyDB::DiskManager *disk_manager) {
+                // round up so that the parallel pool isn't smaller than the single one
+                size_t pool_size = (total_size + num_instances - 1) / num_instances;
+                return new TinyDB::ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+            }, page_num, operation_num, thread_num);
+        }
+        printf("%8d %14.2f %14.2f %14.2f %14.2f\n", thread_num, result[0], result[1], result[2], result[3]);
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file read_ahead_benchmark.cpp
+ * @author sheep
+ * @brief cold sequential scan with and without read-ahead
+ * @version 0.1
+ * @date 2022-06-24
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * usage: read_ahead_benchmark [page_num] [pool_size] [work_us]
+ * pages form a linked list like table heap does, every page stores the id of the next one.
+ * scan follows the links on a simulated device, spending work_us on every page, with
+ * read-ahead windows of different sizes. window 0 is the plain scan
+ */
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/read_ahead.h"
+#include "storage/disk/latency_disk_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace TinyDB {
+
+// scan the list starting from first_page_id, return pages per second
+double RunScan(DiskManager *disk_manager, size_t pool_size, page_id_t first_page_id,
+               size_t window, int work_us, bool use_ring) {
+    BufferPoolManagerInstance bpm(pool_size, disk_manager);
+    std::unique_ptr<BufferAccessStrategy> strategy;
+    if (use_ring) {
+        strategy = std::make_unique<BufferAccessStrategy>(BufferAccessType::BULK_READ, pool_size);
+    }
+    ReadAheadWindow read_ahead(window);
+
+    auto t1 = std::chrono::steady_clock::now();
+    size_t page_cnt = 0;
+    page_id_t page_id = first_page_id;
+    while (page_id != INVALID_PAGE_ID) {
+        auto page = bpm.FetchPage(page_id, strategy.get());
+        if (page == nullptr) {
+            fprintf(stderr, "failed to fetch page %d\n", page_id);
+            return 0;
+        }
+        page_id_t next_page_id;
+        memcpy(&next_page_id, page->GetData(), sizeof(page_id_t));
+        read_ahead.OnPage(&bpm, page_id, next_page_id, strategy.get());
+
+        // pretend we are evaluating the tuples
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(work_us);
+        while (std::chrono::steady_clock::now() < deadline) {}
+
+        bpm.UnpinPage(page_id, false);
+        page_id = next_page_id;
+        page_cnt++;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = t2 - t1;
+    return page_cnt / elapsed.count();
+}
+
+}
+
+int main(int argc, char **argv) {
+    int page_num = argc > 1 ? atoi(argv[1]) : 4096;
+    size_t pool_size = argc > 2 ? atoi(argv[2]) : 1024;
+    int work_us = argc > 3 ? atoi(argv[3]) : 20;
+
+    TinyDB::MemoryDiskManager memory_disk_manager;
+    TinyDB::LatencyDiskManager disk_manager(&memory_disk_manager, TinyDB::DeviceProfile::SSD());
+    char data[TinyDB::PAGE_SIZE] = {0};
+    for (int i = 0; i < page_num; i++) {
+        TinyDB::page_id_t page_id = memory_disk_manager.AllocatePage();
+        TinyDB::page_id_t next_page_id = i + 1 == page_num ? TinyDB::INVALID_PAGE_ID : page_id + 1;
+        memcpy(data, &next_page_id, sizeof(TinyDB::page_id_t));
+        memory_disk_manager.WritePage(page_id, data);
+    }
+
+    printf("pages: %d, pool size: %zu, work per page: %dus, ssd profile, throughput in pages/s\n",
+        page_num, pool_size, work_us);
+    printf("%8s %14s %14s\n", "window", "shared pool", "bulk read ring");
+    for (size_t window : {0, 1, 4, 16, 32, 64}) {
+        double shared = TinyDB::RunScan(&disk_manager, pool_size, 0, window, work_us, false);
+        double ring = TinyDB::RunScan(&disk_manager, pool_size, 0, window, work_us, true);
+        printf("%8zu %14.0f %14.0f\n", window, shared, ring);
+    }
+    return 0;
+}
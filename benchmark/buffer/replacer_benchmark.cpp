@@ -0,0 +1,100 @@
+/**
+ * @file replacer_benchmark.cpp
+ * @author sheep
+ * @brief lru vs clock replacer on hit-heavy workloads
+ * @version 0.1
+ * @date 2022-06-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * usage: replacer_benchmark [page_num] [pool_size] [operation_num]
+ * 80% of accesses go to 20% of pages, pool is large enough for the hot pages,
+ * so most of the fetches are hits. pages live in a MemoryDiskManager.
+ */
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+struct Result {
+    // million operations per second
+    double throughput_;
+    double hit_ratio_;
+};
+
+Result RunBenchmark(ReplacerType type, int page_num, size_t pool_size, int operation_num, int thread_num) {
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(pool_size, &disk_manager, type);
+
+    std::vector<page_id_t> page_list(page_num);
+    for (int i = 0; i < page_num; i++) {
+        auto page = bpm.NewPage(&page_list[i]);
+        page->GetData()[0] = static_cast<char>(i);
+        bpm.UnpinPage(page_list[i], true);
+    }
+    disk_manager.ResetIOStats();
+
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<std::thread> worker_list;
+    for (int i = 0; i < thread_num; i++) {
+        worker_list.emplace_back([&, i]() {
+            std::mt19937 mt(i);
+            int hot_num = std::max(1, page_num / 5);
+            std::uniform_int_distribution<int> hot_dis(0, hot_num - 1);
+            std::uniform_int_distribution<int> cold_dis(hot_num, std::max(hot_num, page_num - 1));
+            std::uniform_int_distribution<int> pick(0, 9);
+            int sum = 0;
+            for (int j = 0; j < operation_num / thread_num; j++) {
+                page_id_t page_id = page_list[pick(mt) < 8 ? hot_dis(mt) : cold_dis(mt)];
+                auto page = bpm.FetchPage(page_id);
+                if (page == nullptr) {
+                    continue;
+                }
+                page->RLatch();
+                sum += page->GetData()[0];
+                page->RUnlatch();
+                bpm.UnpinPage(page_id, false);
+            }
+            // keep the reads alive
+            if (sum == -1) {
+                printf("%d\n", sum);
+            }
+        });
+    }
+    for (auto &worker : worker_list) {
+        worker.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = t2 - t1;
+
+    auto misses = disk_manager.GetIOStats().page_read_.ops_;
+    return Result{operation_num / elapsed.count() / 1e6, 1.0 - static_cast<double>(misses) / operation_num};
+}
+
+}
+
+int main(int argc, char **argv) {
+    int page_num = argc > 1 ? atoi(argv[1]) : 10000;
+    size_t pool_size = argc > 2 ? atoi(argv[2]) : 4000;
+    int operation_num = argc > 3 ? atoi(argv[3]) : 2000000;
+
+    printf("pages: %d, buffer pool: %zu pages, operations: %d, throughput in Mops/s\n",
+        page_num, pool_size, operation_num);
+    printf("%8s %12s %12s %12s %12s\n", "threads", "lru", "lru hit", "clock", "clock hit");
+    for (int thread_num = 1; thread_num <= 64; thread_num *= 2) {
+        auto lru = TinyDB::RunBenchmark(TinyDB::ReplacerType::LRU, page_num, pool_size, operation_num, thread_num);
+        auto clock = TinyDB::RunBenchmark(TinyDB::ReplacerType::CLOCK, page_num, pool_size, operation_num, thread_num);
+        printf("%8d %12.2f %11.1f%% %12.2f %11.1f%%\n", thread_num, lru.throughput_, lru.hit_ratio_ * 100,
+            clock.throughput_, clock.hit_ratio_ * 100);
+    }
+    return 0;
+}
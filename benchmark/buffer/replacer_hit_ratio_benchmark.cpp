@@ -0,0 +1,169 @@
+/**
+ * @file replacer_hit_ratio_benchmark.cpp
+ * @author sheep
+ * @brief hit ratio of lru, clock and lru-k on page reference traces
+ * @version 0.1
+ * @date 2022-06-21
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * usage: replacer_hit_ratio_benchmark [pool_size] [trace_file]
+ * trace file is a text file, one page id per line. without it, we use a synthetic trace
+ * looking like tpcc new-order: index lookups on a b+tree, plus order-line appends, and every
+ * once in a while a burst of one-off pages, e.g. bulk inserts into history table.
+ * replacers are driven the same way buffer pool does: a hit or a miss touches the frame
+ * when its last pin is released, a miss evicts a victim and loads the page first.
+ */
+
+#include "buffer/lru_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TinyDB {
+
+// pages at and above it are one-off pages in synthetic trace
+const page_id_t ONE_OFF_PAGE_BASE = 1000000;
+
+std::vector<page_id_t> GenerateTrace() {
+    const int leaf_num = 512;
+    const int internal_num = 16;
+    const int transaction_num = 20000;
+    const int item_per_transaction = 10;
+    const int order_line_per_page = 40;
+    const int burst_interval = 500;
+    const int burst_page_num = 2000;
+    const int reference_per_burst_page = 4;
+
+    std::mt19937 mt(0);
+    // 80% of the lookups go to 20% of the leaves
+    std::uniform_int_distribution<int> pick(0, 9);
+    std::uniform_int_distribution<int> hot_leaf(0, leaf_num / 5 - 1);
+    std::uniform_int_distribution<int> any_leaf(0, leaf_num - 1);
+
+    std::vector<page_id_t> trace;
+    page_id_t next_one_off = ONE_OFF_PAGE_BASE;
+    page_id_t order_line_page = next_one_off++;
+    int order_lines = 0;
+    for (int txn = 0; txn < transaction_num; txn++) {
+        for (int item = 0; item < item_per_transaction; item++) {
+            int leaf = pick(mt) < 8 ? hot_leaf(mt) : any_leaf(mt);
+            // root, internal, leaf
+            trace.push_back(0);
+            trace.push_back(1 + leaf % internal_num);
+            trace.push_back(1 + internal_num + leaf);
+            // append an order line
+            trace.push_back(order_line_page);
+            if (++order_lines == order_line_per_page) {
+                order_line_page = next_one_off++;
+                order_lines = 0;
+            }
+        }
+        if (txn % burst_interval == burst_interval - 1) {
+            for (int i = 0; i < burst_page_num; i++) {
+                page_id_t page_id = next_one_off++;
+                for (int j = 0; j < reference_per_burst_page; j++) {
+                    trace.push_back(page_id);
+                }
+            }
+        }
+    }
+    return trace;
+}
+
+bool LoadTrace(const std::string &filename, std::vector<page_id_t> *trace) {
+    std::ifstream in(filename);
+    if (!in) {
+        return false;
+    }
+    page_id_t page_id;
+    while (in >> page_id) {
+        trace->push_back(page_id);
+    }
+    return true;
+}
+
+struct Result {
+    double hit_ratio_;
+    // hit ratio of pages below ONE_OFF_PAGE_BASE, i.e. index pages in synthetic trace
+    double hot_hit_ratio_;
+};
+
+Result Simulate(Replacer *replacer, size_t pool_size, const std::vector<page_id_t> &trace) {
+    std::unordered_map<page_id_t, frame_id_t> page_table;
+    std::vector<page_id_t> frames(pool_size, INVALID_PAGE_ID);
+    size_t used = 0;
+    size_t hits = 0;
+    size_t hot_refs = 0;
+    size_t hot_hits = 0;
+
+    for (auto page_id : trace) {
+        bool hot = page_id < ONE_OFF_PAGE_BASE;
+        hot_refs += hot;
+        auto it = page_table.find(page_id);
+        if (it != page_table.end()) {
+            hits++;
+            hot_hits += hot;
+            replacer->Touch(it->second);
+            continue;
+        }
+
+        frame_id_t frame_id;
+        if (used < pool_size) {
+            frame_id = used++;
+        } else {
+            if (!replacer->Evict(&frame_id)) {
+                continue;
+            }
+            page_table.erase(frames[frame_id]);
+        }
+        frames[frame_id] = page_id;
+        page_table[page_id] = frame_id;
+        replacer->Load(frame_id, page_id);
+        replacer->Touch(frame_id);
+    }
+    return Result{static_cast<double>(hits) / trace.size(),
+                  hot_refs == 0 ? 0 : static_cast<double>(hot_hits) / hot_refs};
+}
+
+}
+
+int main(int argc, char **argv) {
+    size_t pool_size = argc > 1 ? atoi(argv[1]) : 512;
+    std::vector<TinyDB::page_id_t> trace;
+    if (argc > 2) {
+        if (!TinyDB::LoadTrace(argv[2], &trace)) {
+            fprintf(stderr, "failed to open %s\n", argv[2]);
+            return 1;
+        }
+    } else {
+        trace = TinyDB::GenerateTrace();
+    }
+
+    using Factory = std::function<TinyDB::Replacer *()>;
+    std::vector<std::pair<std::string, Factory>> policies{
+        {"lru", [&]() { return new TinyDB::LRUReplacer(pool_size); }},
+        {"clock", [&]() { return new TinyDB::ClockReplacer(pool_size); }},
+        {"lru-2 (no crp)", [&]() { return new TinyDB::LRUKReplacer(pool_size, 2, 0); }},
+        {"lru-2", [&]() { return new TinyDB::LRUKReplacer(pool_size); }},
+        {"lru-3", [&]() { return new TinyDB::LRUKReplacer(pool_size, 3); }},
+    };
+
+    printf("references: %zu, buffer pool: %zu pages\n", trace.size(), pool_size);
+    printf("%16s %12s %12s\n", "policy", "hit ratio", "hot hit");
+    for (auto &[name, factory] : policies) {
+        std::unique_ptr<TinyDB::Replacer> replacer(factory());
+        auto result = TinyDB::Simulate(replacer.get(), pool_size, trace);
+        printf("%16s %11.2f%% %11.2f%%\n", name.c_str(), result.hit_ratio_ * 100, result.hot_hit_ratio_ * 100);
+    }
+    return 0;
+}
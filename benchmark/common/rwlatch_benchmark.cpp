@@ -0,0 +1,179 @@
+/**
+ * @file rwlatch_benchmark.cpp
+ * @author sheep
+ * @brief reader writer latch against the old mutex based one, std::shared_mutex and a spinlock
+ * @version 0.1
+ * @date 2022-06-29
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * usage: rwlatch_benchmark [operation_num]
+ * every thread hammers the same latch, reading or bumping a few counters under it,
+ * with 1 to 64 threads and different fractions of reads.
+ */
+
+#include "common/rwlatch.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+// the latch we had before, a mutex and two condition variables
+class MutexReaderWriterLatch {
+public:
+    void WLock() {
+        std::unique_lock<std::mutex> latch(mutex_);
+        reader_.wait(latch, [&]() { return !writer_entered_; });
+        writer_entered_ = true;
+        writer_.wait(latch, [&]() { return reader_count_ == 0; });
+    }
+
+    void WUnlock() {
+        std::unique_lock<std::mutex> latch(mutex_);
+        writer_entered_ = false;
+        reader_.notify_all();
+    }
+
+    void RLock() {
+        std::unique_lock<std::mutex> latch(mutex_);
+        reader_.wait(latch, [&]() { return !writer_entered_; });
+        reader_count_ += 1;
+    }
+
+    void RUnlock() {
+        std::unique_lock<std::mutex> latch(mutex_);
+        reader_count_ -= 1;
+        if (writer_entered_ && reader_count_ == 0) {
+            writer_.notify_one();
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable writer_;
+    std::condition_variable reader_;
+    uint32_t reader_count_{0};
+    bool writer_entered_{false};
+};
+
+class SharedMutexLatch {
+public:
+    void WLock() {
+        mutex_.lock();
+    }
+
+    void WUnlock() {
+        mutex_.unlock();
+    }
+
+    void RLock() {
+        mutex_.lock_shared();
+    }
+
+    void RUnlock() {
+        mutex_.unlock_shared();
+    }
+
+private:
+    std::shared_mutex mutex_;
+};
+
+// test and test-and-set, readers are exclusive as well
+class SpinLatch {
+public:
+    void WLock() {
+        while (locked_.exchange(true, std::memory_order_acquire)) {
+            while (locked_.load(std::memory_order_relaxed)) {
+                __builtin_ia32_pause();
+            }
+        }
+    }
+
+    void WUnlock() {
+        locked_.store(false, std::memory_order_release);
+    }
+
+    void RLock() {
+        WLock();
+    }
+
+    void RUnlock() {
+        WUnlock();
+    }
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+struct alignas(CACHE_LINE_SIZE) SharedData {
+    int64_t counters_[4]{0, 0, 0, 0};
+};
+
+// return million operations per second
+template <typename Latch>
+double RunBenchmark(int thread_num, int read_percent, int operation_num) {
+    Latch latch;
+    SharedData data;
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<std::thread> worker_list;
+    for (int i = 0; i < thread_num; i++) {
+        worker_list.emplace_back([&, i]() {
+            std::mt19937 mt(i);
+            int64_t sum = 0;
+            for (int j = 0; j < operation_num / thread_num; j++) {
+                if (static_cast<int>(mt() % 100) < read_percent) {
+                    latch.RLock();
+                    for (auto counter : data.counters_) {
+                        sum += counter;
+                    }
+                    latch.RUnlock();
+                } else {
+                    latch.WLock();
+                    for (auto &counter : data.counters_) {
+                        counter++;
+                    }
+                    latch.WUnlock();
+                }
+            }
+            // keep the reads alive
+            if (sum == -1) {
+                printf("%ld\n", sum);
+            }
+        });
+    }
+    for (auto &worker : worker_list) {
+        worker.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = t2 - t1;
+    return operation_num / elapsed.count() / 1e6;
+}
+
+}
+
+int main(int argc, char **argv) {
+    int operation_num = argc > 1 ? atoi(argv[1]) : 2000000;
+
+    printf("operations: %d, throughput in Mops/s\n", operation_num);
+    for (int read_percent : {100, 99, 90, 50}) {
+        printf("\nreads: %d%%\n", read_percent);
+        printf("%8s %14s %14s %14s %14s\n", "threads", "rwlatch", "mutex rwlatch", "shared_mutex", "spinlock");
+        for (int thread_num = 1; thread_num <= 64; thread_num *= 2) {
+            printf("%8d %14.2f %14.2f %14.2f %14.2f\n", thread_num,
+                TinyDB::RunBenchmark<TinyDB::ReaderWriterLatch>(thread_num, read_percent, operation_num),
+                TinyDB::RunBenchmark<TinyDB::MutexReaderWriterLatch>(thread_num, read_percent, operation_num),
+                TinyDB::RunBenchmark<TinyDB::SharedMutexLatch>(thread_num, read_percent, operation_num),
+                TinyDB::RunBenchmark<TinyDB::SpinLatch>(thread_num, read_percent, operation_num));
+        }
+    }
+    return 0;
+}
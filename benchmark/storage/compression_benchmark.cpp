@@ -0,0 +1,118 @@
+/**
+ * @file compression_benchmark.cpp
+ * @author sheep
+ * @brief trade of I/O for CPU, cold table heap scan on plain and compressed pages
+ * @version 0.1
+ * @date 2022-06-14
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * usage: compression_benchmark [tuple_num] [pool_size]
+ * table looks like a history table, i.e. increasing keys and a few distinct strings.
+ * OS page cache is dropped before each scan, so the scan really reads the disk.
+ */
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/file_disk_manager.h"
+#include "storage/disk/compressed_disk_manager.h"
+#include "storage/table/table_heap.h"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TinyDB {
+
+const char *STATUS[] = {"created", "paid", "shipped", "delivered", "refunded"};
+
+// drop the cached pages of file, they are clean after Sync
+void DropCache(const std::string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+}
+
+void RemoveFiles() {
+    RemoveDatabaseFiles("compression_benchmark.db");
+}
+
+void RunBenchmark(const std::string &name, const std::function<DiskManager *()> &create_disk_manager,
+                  int tuple_num, size_t pool_size) {
+    const std::string filename = "compression_benchmark.db";
+    RemoveFiles();
+
+    std::vector<Column> cols{Column("order_id", TypeId::BIGINT), Column("status", TypeId::VARCHAR, 20),
+                             Column("amount", TypeId::DECIMAL), Column("customer", TypeId::VARCHAR, 32)};
+    Schema schema(cols);
+
+    // load the table
+    page_id_t first_page_id;
+    {
+        std::unique_ptr<DiskManager> disk_manager(create_disk_manager());
+        auto bpm = std::make_unique<BufferPoolManagerInstance>(pool_size, disk_manager.get());
+        std::unique_ptr<TableHeap> table(TableHeap::CreateNewTableHeap(bpm.get()));
+        first_page_id = table->GetFirstPageId();
+        for (int i = 0; i < tuple_num; i++) {
+            RID rid;
+            Tuple tuple({Value(TypeId::BIGINT, static_cast<int64_t>(1000000 + i)),
+                         Value(TypeId::VARCHAR, STATUS[i % 5]),
+                         Value(TypeId::DECIMAL, (i % 1000) * 0.25),
+                         Value(TypeId::VARCHAR, "customer#" + std::to_string(i / 100))}, &schema);
+            table->InsertTuple(tuple, &rid);
+        }
+        bpm->FlushAllPages();
+        disk_manager->Sync();
+    }
+    DropCache(filename);
+
+    // cold scan
+    std::unique_ptr<DiskManager> disk_manager(create_disk_manager());
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(pool_size, disk_manager.get());
+    TableHeap table(first_page_id, bpm.get());
+    auto t1 = std::chrono::steady_clock::now();
+    int scanned = 0;
+    for (auto it = table.Begin(); !it.IsEnd(); it.Advance()) {
+        scanned++;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double> scan_time = t2 - t1;
+    if (scanned != tuple_num) {
+        fprintf(stderr, "scanned %d tuples, expected %d\n", scanned, tuple_num);
+    }
+
+    struct stat stat_buf;
+    double file_mib = stat(filename.c_str(), &stat_buf) == 0 ? stat_buf.st_size / 1048576.0 : 0;
+    auto stats = disk_manager->GetIOStats();
+    printf("%12s %12.1f %14.1f %14.0f %14s\n", name.c_str(), file_mib, stats.page_read_.bytes_ / 1048576.0,
+        tuple_num / scan_time.count(), FormatDuration(stats.page_read_.latency_.Percentile(0.5)).c_str());
+
+    bpm.reset();
+    disk_manager.reset();
+    RemoveFiles();
+}
+
+}
+
+int main(int argc, char **argv) {
+    int tuple_num = argc > 1 ? atoi(argv[1]) : 30000;
+    size_t pool_size = argc > 2 ? atoi(argv[2]) : 64;
+
+    printf("tuples: %d, buffer pool: %zu pages\n", tuple_num, pool_size);
+    printf("%12s %12s %14s %14s %14s\n", "storage", "file MiB", "read MiB", "scan tuple/s", "read p50");
+    TinyDB::RunBenchmark("plain", []() -> TinyDB::DiskManager * {
+        return new TinyDB::FileDiskManager("compression_benchmark.db");
+    }, tuple_num, pool_size);
+    TinyDB::RunBenchmark("compressed", []() -> TinyDB::DiskManager * {
+        return new TinyDB::CompressedDiskManager("compression_benchmark.db");
+    }, tuple_num, pool_size);
+    return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file disk_io_benchmark.cpp
+ * @author sheep
+ * @brief compare buffered I/O and direct I/O under different buffer pool sizes
+ * @version 0.1
+ * @date 2022-06-06
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * usage: disk_io_benchmark [page_num] [operation_num] [thread_num]
+ */
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/file_disk_manager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+// run random page accesses through buffer pool, 1/5 of them are writes
+double RunWorkload(bool direct_io, size_t pool_size, int page_num, int operation_num, int thread_num,
+                   IOStatsSnapshot *stats) {
+    const std::string filename = "disk_io_benchmark.db";
+    RemoveDatabaseFiles(filename);
+
+    auto disk_manager = new FileDiskManager(filename, IOEngineType::AUTO, direct_io);
+    auto bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+
+    // prepare the pages
+    std::vector<page_id_t> page_list(page_num);
+    for (int i = 0; i < page_num; i++) {
+        auto page = bpm->NewPage(&page_list[i]);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_list[i]);
+        bpm->UnpinPage(page_list[i], true);
+    }
+    bpm->FlushAllPages();
+    disk_manager->ResetIOStats();
+
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<std::thread> worker_list;
+    for (int i = 0; i < thread_num; i++) {
+        worker_list.emplace_back([&, i]() {
+            std::mt19937 mt(i);
+            std::uniform_int_distribution<int> page_dis(0, page_num - 1);
+            std::uniform_int_distribution<int> op_dis(0, 4);
+            for (int j = 0; j < operation_num / thread_num; j++) {
+                page_id_t page_id = page_list[page_dis(mt)];
+                auto page = bpm->FetchPage(page_id);
+                if (page == nullptr) {
+                    continue;
+                }
+                bool is_write = op_dis(mt) == 0;
+                if (is_write) {
+                    page->WLatch();
+                    page->GetData()[PAGE_SIZE - 1]++;
+                    page->WUnlatch();
+                }
+                bpm->UnpinPage(page_id, is_write);
+            }
+        });
+    }
+    for (auto &worker : worker_list) {
+        worker.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    *stats = disk_manager->GetIOStats();
+
+    delete bpm;
+    delete disk_manager;
+    RemoveDatabaseFiles(filename);
+
+    std::chrono::duration<double> elapsed = t2 - t1;
+    return operation_num / elapsed.count();
+}
+
+}
+
+int main(int argc, char **argv) {
+    int page_num = argc > 1 ? atoi(argv[1]) : 8192;
+    int operation_num = argc > 2 ? atoi(argv[2]) : 200000;
+    int thread_num = argc > 3 ? atoi(argv[3]) : 4;
+
+    printf("pages: %d (%d MiB), operations: %d, threads: %d\n",
+        page_num, static_cast<int>(static_cast<int64_t>(page_num) * TinyDB::PAGE_SIZE >> 20), operation_num, thread_num);
+    printf("%12s %16s %16s %16s %16s\n", "pool_size", "buffered ops/s", "direct ops/s", "buffered rd p99", "direct rd p99");
+    std::vector<TinyDB::IOStatsSnapshot> direct_stats;
+    for (size_t pool_size : {64, 256, 1024, 4096}) {
+        TinyDB::IOStatsSnapshot buffered_stat;
+        TinyDB::IOStatsSnapshot direct_stat;
+        double buffered = TinyDB::RunWorkload(false, pool_size, page_num, operation_num, thread_num, &buffered_stat);
+        double direct = TinyDB::RunWorkload(true, pool_size, page_num, operation_num, thread_num, &direct_stat);
+        printf("%12zu %16.0f %16.0f %16s %16s\n", pool_size, buffered, direct,
+            TinyDB::FormatDuration(buffered_stat.page_read_.latency_.Percentile(0.99)).c_str(),
+            TinyDB::FormatDuration(direct_stat.page_read_.latency_.Percentile(0.99)).c_str());
+        direct_stats.push_back(direct_stat);
+    }
+
+    // the smallest pool does the most I/O
+    printf("\ndirect I/O with pool_size 64:\n%s", direct_stats[0].ToString().c_str());
+    return 0;
+}
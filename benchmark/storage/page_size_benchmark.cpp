@@ -0,0 +1,126 @@
+/**
+ * @file page_size_benchmark.cpp
+ * @author sheep
+ * @brief measure table scan and b+tree point lookup under the configured page size
+ * @version 0.1
+ * @date 2022-06-12
+ *
+ * @copyright Copyright (c) 2022
+ *
+ * page size is a compile time constant, build it with different sizes to compare them:
+ *   for size in 4096 8192 16384 32768; do
+ *     cmake -S . -B build_$size -DTINYDB_PAGE_SIZE=$size && cmake --build build_$size --target page_size_benchmark
+ *     ./build_$size/benchmark/page_size_benchmark
+ *   done
+ *
+ * usage: page_size_benchmark [tuple_num] [lookup_num] [pool_mib] [memory|ssd|hdd]
+ * buffer pool is sized in bytes, so every page size gets the same amount of memory
+ */
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/latency_disk_manager.h"
+#include "storage/table/table_heap.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace TinyDB {
+
+void RunBenchmark(int tuple_num, int lookup_num, size_t pool_size, const std::string &device) {
+    auto memory_dm = std::make_unique<MemoryDiskManager>();
+    std::unique_ptr<LatencyDiskManager> latency_dm;
+    DiskManager *disk_manager = memory_dm.get();
+    if (device == "ssd" || device == "hdd") {
+        latency_dm = std::make_unique<LatencyDiskManager>(
+            memory_dm.get(), device == "ssd" ? DeviceProfile::SSD() : DeviceProfile::HDD());
+        disk_manager = latency_dm.get();
+    }
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(pool_size, disk_manager);
+
+    // table with 3 columns, around 40 bytes each tuple
+    std::vector<Column> cols{Column("colA", TypeId::BIGINT), Column("colB", TypeId::VARCHAR, 20), Column("colC", TypeId::DECIMAL)};
+    Schema schema(cols);
+    std::vector<Column> key_cols{Column("colA", TypeId::BIGINT)};
+    Schema key_schema(key_cols);
+
+    std::unique_ptr<TableHeap> table(TableHeap::CreateNewTableHeap(bpm.get()));
+    GenericComparator<8> comparator(&key_schema);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("page_size_benchmark", bpm.get(), comparator);
+
+    // load
+    auto t1 = std::chrono::steady_clock::now();
+    GenericKey<8> index_key;
+    BPlusTreeExecutionContext context;
+    for (int i = 0; i < tuple_num; i++) {
+        RID rid;
+        Tuple tuple({Value(TypeId::BIGINT, static_cast<int64_t>(i)), Value(TypeId::VARCHAR, "tinydb tuple"),
+                     Value(TypeId::DECIMAL, i * 0.5)}, &schema);
+        table->InsertTuple(tuple, &rid);
+
+        context.Reset();
+        index_key.SetFromKey(Tuple({Value(TypeId::BIGINT, static_cast<int64_t>(i))}, &key_schema));
+        tree.Insert(index_key, rid, &context);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double> load_time = t2 - t1;
+
+    // full scan
+    t1 = std::chrono::steady_clock::now();
+    int scanned = 0;
+    for (auto it = table->Begin(); !it.IsEnd(); it.Advance()) {
+        scanned++;
+    }
+    t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double> scan_time = t2 - t1;
+    if (scanned != tuple_num) {
+        fprintf(stderr, "scanned %d tuples, expected %d\n", scanned, tuple_num);
+    }
+
+    // random point lookups
+    std::mt19937 mt(0);
+    std::uniform_int_distribution<int64_t> key_dis(0, tuple_num - 1);
+    t1 = std::chrono::steady_clock::now();
+    int found = 0;
+    for (int i = 0; i < lookup_num; i++) {
+        std::vector<RID> result;
+        context.Reset();
+        index_key.SetFromKey(Tuple({Value(TypeId::BIGINT, key_dis(mt))}, &key_schema));
+        if (tree.GetValue(index_key, &result, &context)) {
+            Tuple tuple;
+            found += table->GetTuple(result[0], &tuple).IsOk();
+        }
+    }
+    t2 = std::chrono::steady_clock::now();
+    std::chrono::duration<double> lookup_time = t2 - t1;
+    if (found != lookup_num) {
+        fprintf(stderr, "found %d tuples, expected %d\n", found, lookup_num);
+    }
+
+    printf("%10u %10d %14.0f %14.0f %14.0f\n", PAGE_SIZE, disk_manager->GetAllocateCount(),
+        tuple_num / load_time.count(), tuple_num / scan_time.count(), lookup_num / lookup_time.count());
+    printf("\n%s", disk_manager->GetIOStats().ToString().c_str());
+}
+
+}
+
+int main(int argc, char **argv) {
+    int tuple_num = argc > 1 ? atoi(argv[1]) : 50000;
+    int lookup_num = argc > 2 ? atoi(argv[2]) : 10000;
+    size_t pool_mib = argc > 3 ? atoi(argv[3]) : 4;
+    std::string device = argc > 4 ? argv[4] : "ssd";
+
+    size_t pool_size = (pool_mib << 20) / TinyDB::PAGE_SIZE;
+    printf("tuples: %d, lookups: %d, buffer pool: %zu MiB (%zu pages), device: %s\n",
+        tuple_num, lookup_num, pool_mib, pool_size, device.c_str());
+    printf("%10s %10s %14s %14s %14s\n", "page_size", "pages", "insert/s", "scan tuple/s", "lookup/s");
+    TinyDB::RunBenchmark(tuple_num, lookup_num, pool_size, device);
+    return 0;
+}
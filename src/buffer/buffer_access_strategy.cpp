@@ -0,0 +1,52 @@
+/**
+ * @file buffer_access_strategy.cpp
+ * @author sheep
+ * @brief implementation of buffer access strategy
+ * @version 0.1
+ * @date 2022-06-22
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/buffer_access_strategy.h"
+
+#include <algorithm>
+
+namespace TinyDB {
+
+BufferAccessStrategy::BufferAccessStrategy(size_t ring_size)
+    : ring_size_(std::max<size_t>(ring_size, 1)) {}
+
+BufferAccessStrategy::BufferAccessStrategy(BufferAccessType type, size_t pool_size) {
+    size_t bytes = type == BufferAccessType::BULK_WRITE ? BULK_WRITE_RING_BYTES : BULK_READ_RING_BYTES;
+    ring_size_ = std::max<size_t>(std::min<size_t>(bytes / PAGE_SIZE, pool_size / 8), 1);
+}
+
+bool BufferAccessStrategy::GetVictim(const void *owner, page_id_t *page_id, frame_id_t *frame_id) {
+    // ring is still growing
+    if (ring_.size() < ring_size_) {
+        return false;
+    }
+
+    auto it = std::find_if(ring_.begin(), ring_.end(), [owner](const Slot &slot) {
+        return slot.owner_ == owner;
+    });
+    if (it == ring_.end()) {
+        ring_.pop_front();
+        return false;
+    }
+    *page_id = it->page_id_;
+    *frame_id = it->frame_id_;
+    ring_.erase(it);
+    return true;
+}
+
+void BufferAccessStrategy::Add(const void *owner, page_id_t page_id, frame_id_t frame_id) {
+    if (ring_.size() == ring_size_) {
+        ring_.pop_front();
+    }
+    ring_.push_back(Slot{owner, page_id, frame_id});
+}
+
+}
@@ -0,0 +1,187 @@
+/**
+ * @file buffer_pool_dumper.cpp
+ * @author sheep
+ * @brief implementation of buffer pool dumper
+ * @version 0.1
+ * @date 2022-06-28
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/buffer_pool_dumper.h"
+#include "common/exception.h"
+#include "common/logger.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace TinyDB {
+
+BufferPoolDumper::BufferPoolDumper(BufferPoolManager *bpm, std::string filename, const BufferPoolDumpConfig &config)
+    : bpm_(bpm), filename_(std::move(filename)), config_(config) {}
+
+BufferPoolDumper::~BufferPoolDumper() {
+    StopPeriodicDump();
+    if (config_.dump_on_shutdown_) {
+        try {
+            Dump();
+        } catch (...) {
+            LOG_ERROR("failed to dump buffer pool to %s on shutdown", filename_.c_str());
+        }
+    }
+}
+
+size_t BufferPoolDumper::Dump() {
+    std::vector<std::pair<page_id_t, uint32_t>> pages;
+    bpm_->GetResidentPages(&pages);
+    // hottest first, so that warm-up could simply take the head
+    std::sort(pages.begin(), pages.end(), [](const auto &a, const auto &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    std::ostringstream out;
+    for (auto [page_id, temperature] : pages) {
+        out << "page " << page_id << " " << temperature << "\n";
+    }
+    std::string content = out.str();
+
+    // write to a temporary file, sync it, then rename it. so that after a crash we've got
+    // either the previous dump or the new one, never half of it
+    std::string tmp_name = filename_ + ".tmp";
+    int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        THROW_IO_EXCEPTION("failed to open buffer pool dump " + tmp_name + ", " + strerror(errno));
+    }
+    size_t written = 0;
+    while (written < content.size()) {
+        ssize_t res = write(fd, content.data() + written, content.size() - written);
+        if (res < 0 && errno == EINTR) {
+            continue;
+        }
+        if (res < 0) {
+            break;
+        }
+        written += res;
+    }
+    if (written != content.size() || fsync(fd) != 0) {
+        std::string error = strerror(errno);
+        close(fd);
+        THROW_IO_EXCEPTION("failed to write buffer pool dump " + tmp_name + ", " + error);
+    }
+    close(fd);
+    if (rename(tmp_name.c_str(), filename_.c_str()) != 0) {
+        THROW_IO_EXCEPTION(std::string("failed to write buffer pool dump, ") + strerror(errno));
+    }
+
+    // make the rename itself durable
+    auto n = filename_.rfind('/');
+    std::string dir_name = n == std::string::npos ? "." : (n == 0 ? "/" : filename_.substr(0, n));
+    int dir_fd = open(dir_name.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd < 0 || fsync(dir_fd) != 0) {
+        LOG_WARN("failed to sync directory %s, %s", dir_name.c_str(), strerror(errno));
+    }
+    if (dir_fd >= 0) {
+        close(dir_fd);
+    }
+    return pages.size();
+}
+
+std::vector<std::pair<page_id_t, uint32_t>> BufferPoolDumper::ReadDump() {
+    std::vector<std::pair<page_id_t, uint32_t>> pages;
+    std::ifstream in(filename_);
+    if (!in.is_open()) {
+        return pages;
+    }
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string key;
+        page_id_t page_id;
+        uint32_t temperature;
+        if (!(iss >> key >> page_id >> temperature) || key != "page") {
+            LOG_WARN("invalid line in buffer pool dump %s: %s", filename_.c_str(), line.c_str());
+            continue;
+        }
+        pages.emplace_back(page_id, temperature);
+    }
+    return pages;
+}
+
+size_t BufferPoolDumper::WarmUp() {
+    auto pages = ReadDump();
+    std::stable_sort(pages.begin(), pages.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+    size_t limit = static_cast<size_t>(bpm_->GetPoolSize() * config_.warm_up_fraction_);
+    if (pages.size() > limit) {
+        pages.resize(limit);
+    }
+
+    // hottest ones are picked, but they are read in page id order
+    std::vector<page_id_t> page_ids;
+    for (auto [page_id, temperature] : pages) {
+        page_ids.push_back(page_id);
+    }
+    std::sort(page_ids.begin(), page_ids.end());
+
+    // prefetch skips pages once a quarter of the pool is being loaded
+    size_t batch_size = std::max<size_t>(std::min(config_.batch_size_, bpm_->GetPoolSize() / 4), 1);
+    for (size_t i = 0; i < page_ids.size(); i += batch_size) {
+        std::vector<page_id_t> batch(page_ids.begin() + i,
+                                     page_ids.begin() + std::min(i + batch_size, page_ids.size()));
+        bpm_->Prefetch(batch);
+        bpm_->WaitForPrefetch();
+    }
+    return page_ids.size();
+}
+
+void BufferPoolDumper::StartPeriodicDump() {
+    std::lock_guard<std::mutex> guard(dump_latch_);
+    if (dump_thread_ != nullptr) {
+        return;
+    }
+    enable_periodic_dump_ = true;
+    dump_thread_ = new std::thread(&BufferPoolDumper::RunPeriodicDump, this);
+}
+
+void BufferPoolDumper::StopPeriodicDump() {
+    std::thread *thread;
+    {
+        std::lock_guard<std::mutex> guard(dump_latch_);
+        if (dump_thread_ == nullptr) {
+            return;
+        }
+        enable_periodic_dump_ = false;
+        thread = dump_thread_;
+        dump_thread_ = nullptr;
+    }
+    dump_cv_.notify_all();
+    thread->join();
+    delete thread;
+}
+
+void BufferPoolDumper::RunPeriodicDump() {
+    std::unique_lock<std::mutex> lock(dump_latch_);
+    while (true) {
+        dump_cv_.wait_for(lock, config_.interval_, [&]() { return !enable_periodic_dump_; });
+        if (!enable_periodic_dump_) {
+            break;
+        }
+        lock.unlock();
+        try {
+            Dump();
+        } catch (...) {
+            // previous dump is still there, try again next time
+            LOG_WARN("failed to dump buffer pool to %s", filename_.c_str());
+        }
+        lock.lock();
+    }
+}
+
+}
@@ -0,0 +1,1106 @@
+/**
+ * @file buffer_pool_manager_instance.cpp
+ * @author sheep
+ * @brief implementation of buffer pool manager
+ * @version 0.1
+ * @date 2022-04-30
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BUFFER_POOL_MANAGER_INSTANCE_CPP
+#define BUFFER_POOL_MANAGER_INSTANCE_CPP
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <new>
+#include <thread>
+
+namespace TinyDB {
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     ReplacerType replacer_type,
+                                                     const FrameArenaConfig &arena_config)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, arena_config.max_pool_size_)),
+      arena_(pool_size, arena_config),
+      disk_manager_(disk_manager),
+      page_table_(max_pool_size_),
+      io_cv_(max_pool_size_) {
+    // allocate the frame descriptors, each of them is bound to its slot in the arena
+    pages_ = static_cast<Page *>(::operator new[](sizeof(Page) * max_pool_size_, std::align_val_t(alignof(Page))));
+    for (size_t i = 0; i < max_pool_size_; i++) {
+        new (&pages_[i]) Page(arena_.GetFrame(i));
+    }
+    replacer_ = Replacer::Create(replacer_type, max_pool_size_);
+
+    // initially, every page is in the free list, and the reserved ones are retired
+    for (size_t i = 0; i < pool_size; i++) {
+        free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    for (size_t i = pool_size; i < max_pool_size_; i++) {
+        pages_[i].pin_count_.store(Page::FRAME_BUSY, std::memory_order_relaxed);
+    }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+    StopPageCleaner();
+    StopPrefetcher();
+    for (size_t i = 0; i < max_pool_size_; i++) {
+        pages_[i].~Page();
+    }
+    ::operator delete[](pages_, std::align_val_t(alignof(Page)));
+}
+
+Page *BufferPoolManagerInstance::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+    // fast path, the page is cached. pin it without latch
+    auto page = FetchResidentPage(page_id);
+    if (page != nullptr) {
+        stats_.RecordHit(page_id);
+        return page;
+    }
+
+    auto lock = LockLatch();
+
+    // look again, the page might be under I/O, or lock-free lookup just missed it
+    frame_id_t frame_id = FindFrame(&lock, page_id);
+    if (frame_id != INVALID_FRAME_ID) {
+        // frame can't become busy while we are holding the latch
+        pages_[frame_id].pin_count_.fetch_add(1, std::memory_order_acq_rel);
+        stats_.RecordHit(page_id);
+        return &pages_[frame_id];
+    }
+
+    stats_.RecordMiss(page_id);
+    // maybe we should throw runtime error when there is no more slot.
+    // or sleep on conditional variable waiting for a slot
+    if (!AcquireFrame(&frame_id, strategy)) {
+        stats_.fetch_failures_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    page = LoadFrame(&lock, page_id, frame_id, true);
+    if (strategy != nullptr) {
+        strategy->Add(this, page_id, frame_id);
+    }
+    return page;
+}
+
+Page *BufferPoolManagerInstance::FetchResidentPage(page_id_t page_id) {
+    frame_id_t frame_id = page_table_.Find(page_id);
+    if (frame_id != INVALID_FRAME_ID && TryPin(frame_id, page_id)) {
+        return &pages_[frame_id];
+    }
+    return nullptr;
+}
+
+void BufferPoolManagerInstance::RecordHit(page_id_t page_id) {
+    stats_.RecordHit(page_id);
+}
+
+bool BufferPoolManagerInstance::UnpinPage(page_id_t page_id, bool is_dirty) {
+    frame_id_t frame_id = page_table_.Find(page_id);
+    if (frame_id == INVALID_FRAME_ID || pages_[frame_id].GetPageId() != page_id) {
+        // lock-free lookup may miss while the table is being modified, look again with the latch
+        auto guard = LockLatch();
+        frame_id = page_table_.Find(page_id);
+    }
+    // failed to find this page
+    if (frame_id == INVALID_FRAME_ID) {
+        return false;
+    }
+
+    auto page = &pages_[frame_id];
+    // update is_dirty flag, it should be visible before the pin is released
+    if (is_dirty) {
+        page->is_dirty_.store(true, std::memory_order_relaxed);
+    }
+
+    // failed to unpin this page.
+    // frames under I/O are only pinned by the thread performing it, so no one else could unpin them
+    int state = page->pin_count_.load(std::memory_order_relaxed);
+    do {
+        if ((state & Page::PIN_COUNT_MASK) == 0 || (state & Page::FRAME_BUSY) != 0
+            || page->GetPageId() != page_id) {
+            return false;
+        }
+    } while (!page->pin_count_.compare_exchange_weak(state, state - 1, std::memory_order_acq_rel));
+
+    OnPinReleased(frame_id, state);
+    return true;
+}
+
+bool BufferPoolManagerInstance::FlushPage(page_id_t page_id) {
+    auto lock = LockLatch();
+    // this page is not cached
+    frame_id_t frame_id = FindFrame(&lock, page_id);
+    if (frame_id == INVALID_FRAME_ID) {
+        return false;
+    }
+
+    // pin it so that it won't be evicted while we are writing it.
+    // dirty flag is cleared before the write, so modifications made during it won't be lost
+    auto page = &pages_[frame_id];
+    page->pin_count_.fetch_add(1, std::memory_order_acq_rel);
+    page->is_dirty_ = false;
+    lock.unlock();
+
+    // flush to disk
+    try {
+        disk_manager_->WritePage(page_id, page->GetData());
+    } catch (...) {
+        page->is_dirty_ = true;
+        ReleasePin(frame_id);
+        throw;
+    }
+
+    ReleasePin(frame_id);
+    return true;
+}
+
+Page *BufferPoolManagerInstance::NewPage(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy) {
+    auto lock = LockLatch();
+
+    // no more space. find the frame before allocating, so we won't leak the page
+    frame_id_t frame_id = INVALID_FRAME_ID;
+    if (!AcquireFrame(&frame_id, strategy)) {
+        stats_.new_page_failures_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // allocate new page from disk
+    *page_id = disk_manager_->AllocatePage(hint);
+    auto page = LoadFrame(&lock, *page_id, frame_id, false);
+    stats_.new_pages_.fetch_add(1, std::memory_order_relaxed);
+    if (strategy != nullptr) {
+        strategy->Add(this, *page_id, frame_id);
+    }
+    return page;
+}
+
+Page *BufferPoolManagerInstance::NewAllocatedPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+    auto lock = LockLatch();
+
+    // a prefetch might have sneaked in after the page was allocated, take over that frame
+    frame_id_t frame_id = FindFrame(&lock, page_id);
+    if (frame_id != INVALID_FRAME_ID) {
+        pages_[frame_id].pin_count_.fetch_add(1, std::memory_order_acq_rel);
+        pages_[frame_id].ZeroData();
+        stats_.new_pages_.fetch_add(1, std::memory_order_relaxed);
+        return &pages_[frame_id];
+    }
+
+    if (!AcquireFrame(&frame_id, strategy)) {
+        stats_.new_page_failures_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    auto page = LoadFrame(&lock, page_id, frame_id, false);
+    stats_.new_pages_.fetch_add(1, std::memory_order_relaxed);
+    if (strategy != nullptr) {
+        strategy->Add(this, page_id, frame_id);
+    }
+    return page;
+}
+
+bool BufferPoolManagerInstance::TryPin(frame_id_t frame_id, page_id_t page_id) {
+    auto page = &pages_[frame_id];
+    int state = page->pin_count_.fetch_add(1, std::memory_order_acq_rel);
+    // frame can't be reassigned once we pinned it, unless it's already busy.
+    // so if it still holds our page, we are done
+    if ((state & Page::FRAME_BUSY) == 0 && page->page_id_.load(std::memory_order_acquire) == page_id) {
+        return true;
+    }
+    ReleasePin(frame_id);
+    return false;
+}
+
+void BufferPoolManagerInstance::ReleasePin(frame_id_t frame_id) {
+    int state = pages_[frame_id].pin_count_.fetch_sub(1, std::memory_order_acq_rel);
+    OnPinReleased(frame_id, state, false);
+}
+
+void BufferPoolManagerInstance::OnPinReleased(frame_id_t frame_id, int state, bool access) {
+    // still pinned, or the frame is busy and the one holding it will take care of it
+    if ((state & (Page::PIN_COUNT_MASK | Page::FRAME_BUSY)) != 1) {
+        return;
+    }
+
+    if ((state & Page::FRAME_DELETE_PENDING) != 0) {
+        // someone has deleted it while we are using it
+        auto guard = LockLatch();
+        TryDeletePending(frame_id);
+        return;
+    }
+
+    if (static_cast<size_t>(frame_id) >= pool_size_.load()) {
+        // buffer pool has shrunk while the frame was pinned, the last one unpinning it retires it
+        auto lock = LockLatch();
+        try {
+            if (static_cast<size_t>(frame_id) >= pool_size_.load() && TryRetireFrame(&lock, frame_id)) {
+                if (IsRetired(frame_id)) {
+                    arena_.Release(frame_id, 1);
+                }
+                return;
+            }
+        } catch (...) {
+            // the page stays in this frame until next Resize
+            LOG_WARN("failed to retire frame %d", frame_id);
+            return;
+        }
+        // pinned again, or buffer pool has grown back
+    }
+
+    if (!access) {
+        // it's still in replacer unless someone tried to evict it while we were
+        // holding the pin, put it back in that case. it's not an access
+        replacer_->SetEvictable(frame_id);
+        return;
+    }
+
+    // put it into replacer as the most recently used one.
+    // pins don't go through replacer, so it might still be there
+    replacer_->Touch(frame_id);
+}
+
+bool BufferPoolManagerInstance::TryDeletePending(frame_id_t frame_id) {
+    int expected = Page::FRAME_DELETE_PENDING;
+    if (!pages_[frame_id].pin_count_.compare_exchange_strong(expected, Page::FRAME_BUSY | 1,
+                                                             std::memory_order_acq_rel)) {
+        // pinned again, the last one unpinning it will retry
+        return false;
+    }
+    DeleteFrame(pages_[frame_id].GetPageId(), frame_id);
+    return true;
+}
+
+frame_id_t BufferPoolManagerInstance::FindFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id) {
+    while (true) {
+        frame_id_t frame_id = page_table_.Find(page_id);
+        if (frame_id != INVALID_FRAME_ID) {
+            if ((pages_[frame_id].pin_count_.load(std::memory_order_acquire) & Page::FRAME_BUSY) == 0) {
+                return frame_id;
+            }
+            // someone is reading it in, wait for that frame only
+            io_cv_[frame_id].wait(*lock);
+            continue;
+        }
+
+        auto wb = writing_back_.find(page_id);
+        if (wb == writing_back_.end()) {
+            return INVALID_FRAME_ID;
+        }
+        // the page was evicted but it's not on disk yet, reading it now would
+        // give us the stale version. wait until the write-back completes
+        io_cv_[wb->second].wait(*lock);
+    }
+}
+
+bool BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id, BufferAccessStrategy *strategy) {
+    // ring goes before free list, so the operation stays within its ring even if
+    // buffer pool has plenty of free frames
+    if (strategy != nullptr && AcquireRingFrame(frame_id, strategy)) {
+        return true;
+    }
+
+    if (!free_list_.empty()) {
+        // we will use free slot first
+        *frame_id = free_list_.back();
+        free_list_.pop_back();
+        // lock-free lookup with a stale entry might be holding it for a moment
+        int expected = 0;
+        while (!pages_[*frame_id].pin_count_.compare_exchange_weak(expected, Page::FRAME_BUSY | 1,
+                                                                   std::memory_order_acq_rel)) {
+            expected = 0;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    // otherwise, let's evict a page and reuse it's slot.
+    // frame pinned by the lock-free path is still in replacer, skip it.
+    // it will be put back when it's unpinned
+    while (replacer_->Evict(frame_id)) {
+        if (static_cast<size_t>(*frame_id) >= pool_size_.load()) {
+            // it's being retired, leave it out of replacer
+            continue;
+        }
+        auto page = &pages_[*frame_id];
+        int expected = 0;
+        if (!page->pin_count_.compare_exchange_strong(expected, Page::FRAME_BUSY | 1, std::memory_order_acq_rel)) {
+            continue;
+        }
+        if (page->GetPageId() == INVALID_PAGE_ID) {
+            // stale entry left by a late unpin, frame is in free list now
+            page->pin_count_.fetch_sub(Page::FRAME_BUSY | 1, std::memory_order_acq_rel);
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool BufferPoolManagerInstance::AcquireRingFrame(frame_id_t *frame_id, BufferAccessStrategy *strategy) {
+    page_id_t ring_page_id;
+    frame_id_t ring_frame_id;
+    if (!strategy->GetVictim(this, &ring_page_id, &ring_frame_id)) {
+        return false;
+    }
+
+    // page id of a frame only changes under the latch. if it's still ours, the frame
+    // hasn't been evicted or deleted since we put it into the ring
+    auto page = &pages_[ring_frame_id];
+    if (page->GetPageId() != ring_page_id || static_cast<size_t>(ring_frame_id) >= pool_size_.load()) {
+        return false;
+    }
+    int expected = 0;
+    if (!page->pin_count_.compare_exchange_strong(expected, Page::FRAME_BUSY | 1, std::memory_order_acq_rel)) {
+        // someone else is using it, leave it to the shared pool
+        return false;
+    }
+    replacer_->Pin(ring_frame_id);
+    *frame_id = ring_frame_id;
+    return true;
+}
+
+page_id_t BufferPoolManagerInstance::AssignFrame(page_id_t page_id, frame_id_t frame_id) {
+    auto page = &pages_[frame_id];
+    page_id_t victim_page_id = page->GetPageId();
+    bool write_back = victim_page_id != INVALID_PAGE_ID && page->IsDirty();
+    if (victim_page_id != INVALID_PAGE_ID) {
+        stats_.evictions_.fetch_add(1, std::memory_order_relaxed);
+        page_table_.Erase(victim_page_id);
+    }
+    if (write_back) {
+        stats_.dirty_write_backs_.fetch_add(1, std::memory_order_relaxed);
+        // page cleaner is falling behind
+        if (enable_cleaner_.load(std::memory_order_relaxed)) {
+            cleaner_cv_.notify_one();
+        }
+        writing_back_[victim_page_id] = frame_id;
+    }
+
+    // reserve the frame for the new page. the frame is pinned by us and marked as
+    // busy, other threads asking for either page will wait on it
+    page_table_.Insert(page_id, frame_id);
+    page->page_id_ = page_id;
+    page->is_dirty_ = false;
+    replacer_->Load(frame_id, page_id);
+    return write_back ? victim_page_id : INVALID_PAGE_ID;
+}
+
+Page *BufferPoolManagerInstance::LoadFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id,
+                                           frame_id_t frame_id, bool read_page) {
+    auto page = &pages_[frame_id];
+    // only foreground victims count for the page cleaner, prefetch and resize evict on their own
+    if (page->GetPageId() != INVALID_PAGE_ID) {
+        victims_.fetch_add(1, std::memory_order_relaxed);
+    }
+    page_id_t victim_page_id = AssignFrame(page_id, frame_id);
+    bool write_back = victim_page_id != INVALID_PAGE_ID;
+    if (write_back) {
+        dirty_victims_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (write_back || read_page) {
+        lock->unlock();
+    }
+    bool written = false;
+    try {
+        if (write_back) {
+            disk_manager_->WritePage(victim_page_id, page->GetData());
+            written = true;
+        }
+        if (read_page) {
+            disk_manager_->ReadPage(page_id, page->data_);
+        } else {
+            page->ZeroData();
+        }
+    } catch (...) {
+        if (!lock->owns_lock()) {
+            lock->lock();
+        }
+        if (write_back) {
+            writing_back_.erase(victim_page_id);
+        }
+        // victim is still in the frame if we failed to write it, give it back to the buffer pool
+        AbortLoad(page_id, frame_id, write_back && !written ? victim_page_id : INVALID_PAGE_ID);
+        throw;
+    }
+    if (!lock->owns_lock()) {
+        lock->lock();
+    }
+
+    if (write_back) {
+        writing_back_.erase(victim_page_id);
+    }
+    // keep our pin
+    page->pin_count_.fetch_and(~Page::FRAME_BUSY, std::memory_order_acq_rel);
+    io_cv_[frame_id].notify_all();
+    return page;
+}
+
+void BufferPoolManagerInstance::AbortLoad(page_id_t page_id, frame_id_t frame_id, page_id_t victim_page_id) {
+    auto page = &pages_[frame_id];
+    page_table_.Erase(page_id);
+
+    if (victim_page_id != INVALID_PAGE_ID) {
+        page_table_.Insert(victim_page_id, frame_id);
+        page->page_id_ = victim_page_id;
+        page->is_dirty_ = true;
+        replacer_->Load(frame_id, victim_page_id);
+        replacer_->SetEvictable(frame_id);
+        page->pin_count_.fetch_sub(Page::FRAME_BUSY | 1, std::memory_order_acq_rel);
+        // waiters will look the page up again
+        io_cv_[frame_id].notify_all();
+    } else {
+        FreeFrame(frame_id);
+    }
+}
+
+bool BufferPoolManagerInstance::DeletePage(page_id_t page_id) {
+    auto lock = LockLatch();
+    frame_id_t frame_id = FindFrame(&lock, page_id);
+    if (frame_id == INVALID_FRAME_ID) {
+        // not in memory, deallocate this page, return it to disk manager
+        disk_manager_->DeallocatePage(page_id);
+        return true;
+    }
+
+    auto page = &pages_[frame_id];
+    int expected = 0;
+    if (page->pin_count_.compare_exchange_strong(expected, Page::FRAME_BUSY | 1, std::memory_order_acq_rel)) {
+        DeleteFrame(page_id, frame_id);
+        return true;
+    }
+
+    // check whether other one is still using.
+    // we can't give it back to disk manager now, otherwise it might be reused while someone is reading it.
+    // the last one unpinning it will do the deallocation
+    int state = page->pin_count_.fetch_or(Page::FRAME_DELETE_PENDING, std::memory_order_acq_rel);
+    if ((state & Page::PIN_COUNT_MASK) == 0) {
+        // the last pin was released right before we set the flag
+        return TryDeletePending(frame_id);
+    }
+    return false;
+}
+
+void BufferPoolManagerInstance::DeleteFrame(page_id_t page_id, frame_id_t frame_id) {
+    page_table_.Erase(page_id);
+    // remove it from replacer
+    replacer_->Pin(frame_id);
+    // put this slot to free list, and release the frame we've claimed
+    FreeFrame(frame_id);
+
+    // deallocate this page, return it to disk manager
+    disk_manager_->DeallocatePage(page_id);
+}
+
+void BufferPoolManagerInstance::FreeFrame(frame_id_t frame_id) {
+    auto page = &pages_[frame_id];
+    // reset page id, because this might interfere "FlushAllPages"
+    page->page_id_ = INVALID_PAGE_ID;
+    page->is_dirty_ = false;
+
+    if (static_cast<size_t>(frame_id) < pool_size_.load()) {
+        free_list_.push_front(frame_id);
+        page->pin_count_.fetch_sub(Page::FRAME_BUSY | 1, std::memory_order_acq_rel);
+    } else {
+        // keep it busy, so that lookups with a stale frame id can't pin it
+        page->pin_count_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    io_cv_[frame_id].notify_all();
+}
+
+bool BufferPoolManagerInstance::Resize(size_t pool_size) {
+    if (pool_size == 0 || pool_size > max_pool_size_) {
+        return false;
+    }
+    std::lock_guard<std::mutex> resize_guard(resize_latch_);
+    auto lock = LockLatch();
+    size_t old_size = pool_size_.load();
+
+    if (pool_size > old_size) {
+        for (size_t i = old_size; i < pool_size; i++) {
+            auto frame_id = static_cast<frame_id_t>(i);
+            if (IsRetired(frame_id)) {
+                // stale pins might be holding it for a moment, they only touch the pin count
+                pages_[i].pin_count_.fetch_sub(Page::FRAME_BUSY, std::memory_order_acq_rel);
+                free_list_.push_back(frame_id);
+            } else if (pages_[i].pin_count_.load(std::memory_order_acquire) == 0) {
+                // a page we failed to retire, it's evictable again
+                replacer_->SetEvictable(frame_id);
+            }
+            // otherwise it's still pinned, or someone is retiring it. it's a normal
+            // frame again, FreeFrame will put it into free list
+        }
+        pool_size_.store(pool_size);
+        return true;
+    }
+
+    // from now on, frames beyond pool size are never handed out
+    pool_size_.store(pool_size);
+    for (auto it = free_list_.begin(); it != free_list_.end();) {
+        if (static_cast<size_t>(*it) < pool_size) {
+            ++it;
+            continue;
+        }
+        int expected = 0;
+        while (!pages_[*it].pin_count_.compare_exchange_weak(expected, Page::FRAME_BUSY,
+                                                             std::memory_order_acq_rel)) {
+            expected = 0;
+            std::this_thread::yield();
+        }
+        it = free_list_.erase(it);
+    }
+
+    // then the ones holding pages. pages are moved to the frames we keep, so that replacer
+    // decides which ones are evicted. failures are reported after we've gone through all of them
+    std::exception_ptr error;
+    for (size_t i = pool_size; i < max_pool_size_; i++) {
+        auto frame_id = static_cast<frame_id_t>(i);
+        while (!IsRetired(frame_id)) {
+            int state = pages_[i].pin_count_.load(std::memory_order_acquire);
+            if ((state & Page::FRAME_BUSY) != 0) {
+                // it's being loaded or written back, wait for it
+                io_cv_[i].wait(lock);
+                continue;
+            }
+            if (state != 0) {
+                // pinned, or being deleted. it's retired by the last one unpinning it
+                break;
+            }
+            try {
+                if (TryRetireFrame(&lock, frame_id)) {
+                    break;
+                }
+            } catch (...) {
+                if (error == nullptr) {
+                    error = std::current_exception();
+                }
+                break;
+            }
+        }
+    }
+
+    // give the memory of retired frames back. only Resize brings them back, so it's
+    // safe to do it without the latch
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (size_t i = pool_size; i < max_pool_size_; i++) {
+        if (!IsRetired(static_cast<frame_id_t>(i))) {
+            continue;
+        }
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == i) {
+            ranges.back().second++;
+        } else {
+            ranges.emplace_back(i, 1);
+        }
+    }
+    lock.unlock();
+    for (auto [first, count] : ranges) {
+        arena_.Release(first, count);
+    }
+
+    if (error != nullptr) {
+        std::rethrow_exception(error);
+    }
+    return true;
+}
+
+bool BufferPoolManagerInstance::TryRetireFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+    auto page = &pages_[frame_id];
+    int expected = 0;
+    if (!page->pin_count_.compare_exchange_strong(expected, Page::FRAME_BUSY | 1, std::memory_order_acq_rel)) {
+        return false;
+    }
+    replacer_->Pin(frame_id);
+    try {
+        RetireFrame(lock, frame_id);
+    } catch (...) {
+        // the page stays in this frame
+        page->pin_count_.fetch_sub(Page::FRAME_BUSY | 1, std::memory_order_acq_rel);
+        replacer_->SetEvictable(frame_id);
+        io_cv_[frame_id].notify_all();
+        throw;
+    }
+    return true;
+}
+
+void BufferPoolManagerInstance::RetireFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+    auto page = &pages_[frame_id];
+    page_id_t page_id = page->GetPageId();
+    if (page_id != INVALID_PAGE_ID) {
+        frame_id_t new_frame_id;
+        if (AcquireFrame(&new_frame_id)) {
+            MoveFrame(lock, frame_id, new_frame_id);
+        } else {
+            // every frame we keep is pinned, evict the page
+            bool write_back = page->IsDirty();
+            page_table_.Erase(page_id);
+            stats_.evictions_.fetch_add(1, std::memory_order_relaxed);
+            if (write_back) {
+                stats_.dirty_write_backs_.fetch_add(1, std::memory_order_relaxed);
+                writing_back_[page_id] = frame_id;
+                lock->unlock();
+                try {
+                    disk_manager_->WritePage(page_id, page->GetData());
+                } catch (...) {
+                    lock->lock();
+                    writing_back_.erase(page_id);
+                    page_table_.Insert(page_id, frame_id);
+                    throw;
+                }
+                lock->lock();
+                writing_back_.erase(page_id);
+            }
+        }
+    }
+    FreeFrame(frame_id);
+}
+
+void BufferPoolManagerInstance::MoveFrame(std::unique_lock<std::mutex> *lock, frame_id_t from, frame_id_t to) {
+    auto src = &pages_[from];
+    auto dst = &pages_[to];
+    page_id_t page_id = src->GetPageId();
+    // lookups are redirected to the new frame, they wait there until the copy is done.
+    // no one could modify the old frame since it's claimed by us
+    page_id_t victim_page_id = AssignFrame(page_id, to);
+    if (victim_page_id != INVALID_PAGE_ID) {
+        lock->unlock();
+        try {
+            disk_manager_->WritePage(victim_page_id, dst->GetData());
+        } catch (...) {
+            lock->lock();
+            writing_back_.erase(victim_page_id);
+            AbortLoad(page_id, to, victim_page_id);
+            // page stays where it was
+            page_table_.Insert(page_id, from);
+            throw;
+        }
+        memcpy(dst->data_, src->GetData(), PAGE_SIZE);
+        lock->lock();
+        writing_back_.erase(victim_page_id);
+    } else {
+        memcpy(dst->data_, src->GetData(), PAGE_SIZE);
+    }
+    dst->is_dirty_ = src->IsDirty();
+
+    // no one has pinned it, it's evictable right away
+    dst->pin_count_.fetch_sub(Page::FRAME_BUSY | 1, std::memory_order_acq_rel);
+    replacer_->SetEvictable(to);
+    io_cv_[to].notify_all();
+}
+
+void BufferPoolManagerInstance::FlushAllPages() {
+    auto lock = LockLatch();
+
+    // write them back all together, so that contiguous pages
+    // could be flushed with a single syscall.
+    std::vector<frame_id_t> frame_ids;
+    std::vector<page_id_t> page_ids;
+    std::vector<const char *> data;
+    auto add_frame = [&](page_id_t page_id, frame_id_t frame_id) {
+        auto page = &pages_[frame_id];
+        // pin them so they stay while we are writing without the latch
+        page->pin_count_.fetch_add(1, std::memory_order_acq_rel);
+        page->is_dirty_ = false;
+        frame_ids.push_back(frame_id);
+        page_ids.push_back(page_id);
+        data.push_back(page->GetData());
+    };
+    std::vector<page_id_t> busy_page_ids;
+    page_table_.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+        if ((pages_[frame_id].pin_count_.load(std::memory_order_acquire) & Page::FRAME_BUSY) != 0) {
+            busy_page_ids.push_back(page_id);
+            return;
+        }
+        add_frame(page_id, frame_id);
+    });
+    // busy frames are being read in, moved to another frame, or their victim is being
+    // written back. wait for them, a page might be dirty once it's settled. so as the
+    // pages evicted but not on disk yet, every page should be on disk when we return
+    for (const auto &[page_id, frame_id] : writing_back_) {
+        busy_page_ids.push_back(page_id);
+    }
+    for (auto page_id : busy_page_ids) {
+        frame_id_t frame_id = FindFrame(&lock, page_id);
+        if (frame_id != INVALID_FRAME_ID
+            && std::find(frame_ids.begin(), frame_ids.end(), frame_id) == frame_ids.end()) {
+            add_frame(page_id, frame_id);
+        }
+    }
+    lock.unlock();
+
+    try {
+        disk_manager_->WritePages(page_ids, data);
+    } catch (...) {
+        for (auto frame_id : frame_ids) {
+            pages_[frame_id].is_dirty_ = true;
+            ReleasePin(frame_id);
+        }
+        throw;
+    }
+
+    for (auto frame_id : frame_ids) {
+        ReleasePin(frame_id);
+    }
+}
+
+bool BufferPoolManagerInstance::CheckPinCount() {
+    auto lock = LockLatch();
+    // frames are pinned by us until prefetch completes
+    prefetch_done_cv_.wait(lock, [&]() { return prefetching_ == 0; });
+    bool flag = true;
+    // pinned frames beyond pool size still hold pages
+    for (size_t i = 0; i < max_pool_size_; i++) {
+        if (page_table_.Find(pages_[i].GetPageId()) != static_cast<frame_id_t>(i)) {
+            continue;
+        }
+        if (pages_[i].GetPinCount() != 0) {
+            LOG_ERROR("page %d has pin count %d", pages_[i].GetPageId(), pages_[i].GetPinCount());
+            flag = false;
+        }
+    }
+    return flag;
+}
+
+void BufferPoolManagerInstance::GetResidentPages(std::vector<std::pair<page_id_t, uint32_t>> *pages) {
+    auto guard = LockLatch();
+    // evictable frames in eviction order, the others are in use
+    std::vector<frame_id_t> victims;
+    replacer_->PeekVictims(replacer_->Size(), &victims);
+    std::vector<uint32_t> temperatures(max_pool_size_, MAX_TEMPERATURE);
+    for (size_t i = 0; i < victims.size(); i++) {
+        temperatures[victims[i]] = static_cast<uint32_t>(i * MAX_TEMPERATURE / victims.size());
+    }
+    page_table_.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+        // hits don't go through replacer, pinned frames might still be among the victims
+        bool in_use = pages_[frame_id].pin_count_.load(std::memory_order_relaxed) != 0;
+        pages->emplace_back(page_id, in_use ? MAX_TEMPERATURE : temperatures[frame_id]);
+    });
+}
+
+void BufferPoolManagerInstance::Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+    // most of the time they are cached already, don't bother the latch
+    std::vector<page_id_t> missing;
+    for (auto page_id : page_ids) {
+        if (page_id != INVALID_PAGE_ID && page_table_.Find(page_id) == INVALID_FRAME_ID) {
+            missing.push_back(page_id);
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+    PrefetchJob job;
+    {
+        auto guard = LockLatch();
+        size_t max_prefetching = pool_size_.load() / 4;
+        for (auto page_id : missing) {
+            if (prefetching_ >= max_prefetching) {
+                break;
+            }
+            // someone else is loading it, or it has never been written
+            if (page_table_.Find(page_id) != INVALID_FRAME_ID || writing_back_.count(page_id) != 0
+                || !disk_manager_->IsAllocated(page_id)) {
+                continue;
+            }
+            frame_id_t frame_id;
+            if (!AcquireFrame(&frame_id, strategy)) {
+                break;
+            }
+            job.victims_.push_back(AssignFrame(page_id, frame_id));
+            job.loads_.emplace_back(page_id, frame_id);
+            if (strategy != nullptr) {
+                strategy->Add(this, page_id, frame_id);
+            }
+            prefetching_++;
+        }
+    }
+    if (job.loads_.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(prefetch_latch_);
+    if (prefetch_thread_ == nullptr) {
+        prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::RunPrefetcher, this);
+    }
+    prefetch_queue_.push_back(std::move(job));
+    prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::RunPrefetcher() {
+    std::unique_lock<std::mutex> lock(prefetch_latch_);
+    while (true) {
+        prefetch_cv_.wait(lock, [&]() { return stop_prefetcher_ || !prefetch_queue_.empty(); });
+        // queue is drained before we stop, frames in it are claimed
+        if (prefetch_queue_.empty()) {
+            return;
+        }
+        // merge everything queued into one job, so that contiguous pages are read together
+        PrefetchJob job = std::move(prefetch_queue_.front());
+        prefetch_queue_.pop_front();
+        while (!prefetch_queue_.empty()) {
+            auto &next = prefetch_queue_.front();
+            job.loads_.insert(job.loads_.end(), next.loads_.begin(), next.loads_.end());
+            job.victims_.insert(job.victims_.end(), next.victims_.begin(), next.victims_.end());
+            prefetch_queue_.pop_front();
+        }
+        lock.unlock();
+        PerformPrefetch(&job);
+        lock.lock();
+    }
+}
+
+void BufferPoolManagerInstance::PerformPrefetch(PrefetchJob *job) {
+    // victims go first, the pages are read into the same buffers
+    std::vector<page_id_t> victim_ids;
+    std::vector<const char *> victim_data;
+    for (size_t i = 0; i < job->loads_.size(); i++) {
+        if (job->victims_[i] != INVALID_PAGE_ID) {
+            victim_ids.push_back(job->victims_[i]);
+            victim_data.push_back(pages_[job->loads_[i].second].GetData());
+        }
+    }
+    bool written = false;
+    bool read = false;
+    try {
+        if (!victim_ids.empty()) {
+            disk_manager_->WritePages(victim_ids, victim_data);
+        }
+        written = true;
+        std::vector<page_id_t> page_ids;
+        std::vector<char *> data;
+        for (auto [page_id, frame_id] : job->loads_) {
+            page_ids.push_back(page_id);
+            data.push_back(pages_[frame_id].data_);
+        }
+        disk_manager_->ReadPages(page_ids, data);
+        read = true;
+    } catch (...) {
+        // it's only a hint, whoever needs them will read them again
+        LOG_WARN("failed to prefetch %zu pages", job->loads_.size());
+    }
+
+    auto guard = LockLatch();
+    for (size_t i = 0; i < job->loads_.size(); i++) {
+        auto [page_id, frame_id] = job->loads_[i];
+        if (job->victims_[i] != INVALID_PAGE_ID) {
+            writing_back_.erase(job->victims_[i]);
+        }
+        if (!read) {
+            // victims are still in the frames if we failed to write them
+            AbortLoad(page_id, frame_id, written ? INVALID_PAGE_ID : job->victims_[i]);
+            continue;
+        }
+        // no one has pinned it, it's evictable right away. reading it ahead is not a
+        // reference, pages that are never used shouldn't compete with the working set
+        pages_[frame_id].pin_count_.fetch_sub(Page::FRAME_BUSY | 1, std::memory_order_acq_rel);
+        replacer_->SetEvictable(frame_id);
+        io_cv_[frame_id].notify_all();
+    }
+    prefetching_ -= job->loads_.size();
+    if (prefetching_ == 0) {
+        prefetch_done_cv_.notify_all();
+    }
+}
+
+void BufferPoolManagerInstance::WaitForPrefetch() {
+    auto lock = LockLatch();
+    prefetch_done_cv_.wait(lock, [&]() { return prefetching_ == 0; });
+}
+
+void BufferPoolManagerInstance::StopPrefetcher() {
+    std::thread *thread;
+    {
+        std::lock_guard<std::mutex> guard(prefetch_latch_);
+        if (prefetch_thread_ == nullptr) {
+            return;
+        }
+        stop_prefetcher_ = true;
+        thread = prefetch_thread_;
+        prefetch_thread_ = nullptr;
+    }
+    prefetch_cv_.notify_all();
+    thread->join();
+    delete thread;
+}
+
+void BufferPoolManagerInstance::StartPageCleaner(const PageCleanerConfig &config) {
+    std::lock_guard<std::mutex> guard(cleaner_latch_);
+    if (cleaner_thread_ != nullptr) {
+        return;
+    }
+    cleaner_config_ = config;
+    enable_cleaner_.store(true);
+    cleaner_thread_ = new std::thread(&BufferPoolManagerInstance::RunPageCleaner, this);
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+    std::thread *thread;
+    {
+        std::lock_guard<std::mutex> guard(cleaner_latch_);
+        if (cleaner_thread_ == nullptr) {
+            return;
+        }
+        enable_cleaner_.store(false);
+        thread = cleaner_thread_;
+        cleaner_thread_ = nullptr;
+    }
+    cleaner_cv_.notify_all();
+    thread->join();
+    delete thread;
+}
+
+void BufferPoolManagerInstance::RunPageCleaner() {
+    std::unique_lock<std::mutex> lock(cleaner_latch_);
+    while (enable_cleaner_.load()) {
+        cleaner_cv_.wait_for(lock, cleaner_config_.interval_);
+        if (!enable_cleaner_.load()) {
+            break;
+        }
+        lock.unlock();
+        try {
+            CleanDirtyPages(cleaner_config_);
+        } catch (...) {
+            // keep going, pages that failed are still dirty. foreground threads will
+            // see the error if they try to write them
+            LOG_WARN("page cleaner failed to write back dirty pages");
+        }
+        lock.lock();
+    }
+}
+
+size_t BufferPoolManagerInstance::CleanDirtyPages(const PageCleanerConfig &config) {
+    cleaner_rounds_.fetch_add(1, std::memory_order_relaxed);
+    size_t max_pages = config.max_pages_per_round_ == 0 ? pool_size_.load() : config.max_pages_per_round_;
+    size_t max_batch = config.max_batch_size_ == 0 ? 1 : config.max_batch_size_;
+
+    // the ones that are going to be evicted soon
+    size_t target = (replacer_->Size() * config.clean_target_percent_ + 99) / 100;
+    std::vector<frame_id_t> candidates;
+    replacer_->PeekVictims(target, &candidates);
+    if (candidates.empty() && target != 0) {
+        // replacer doesn't tell, just look at all the frames
+        for (size_t i = 0; i < pool_size_.load(); i++) {
+            candidates.push_back(static_cast<frame_id_t>(i));
+        }
+    }
+
+    // pin the dirty ones, ordered by page id so that neighbors are next to each other
+    std::map<page_id_t, frame_id_t> dirty;
+    for (auto frame_id : candidates) {
+        if (dirty.size() >= max_pages) {
+            break;
+        }
+        page_id_t page_id = pages_[frame_id].GetPageId();
+        if (page_id != INVALID_PAGE_ID && dirty.count(page_id) == 0 && TryPinDirty(frame_id, page_id)) {
+            dirty.emplace(page_id, frame_id);
+        }
+    }
+
+    // group consecutive page ids. a batch that has room takes in the cached dirty neighbors
+    // following it, it's cheaper to write them now than in a separate request later
+    size_t written = 0;
+    std::vector<std::pair<page_id_t, frame_id_t>> batch;
+    auto it = dirty.begin();
+    try {
+        while (it != dirty.end()) {
+            batch.clear();
+            batch.emplace_back(*it);
+            it = dirty.erase(it);
+            while (batch.size() < max_batch) {
+                page_id_t next_page_id = batch.back().first + 1;
+                if (it != dirty.end() && it->first == next_page_id) {
+                    batch.emplace_back(*it);
+                    it = dirty.erase(it);
+                    continue;
+                }
+                if (written + batch.size() + dirty.size() >= max_pages) {
+                    break;
+                }
+                frame_id_t frame_id = page_table_.Find(next_page_id);
+                if (frame_id == INVALID_FRAME_ID || !TryPinDirty(frame_id, next_page_id)) {
+                    break;
+                }
+                batch.emplace_back(next_page_id, frame_id);
+            }
+            WriteBatch(batch);
+            written += batch.size();
+        }
+    } catch (...) {
+        // drop the pins of pages we haven't got to
+        for (auto [page_id, frame_id] : dirty) {
+            OnPinReleased(frame_id, pages_[frame_id].pin_count_.fetch_sub(1, std::memory_order_acq_rel), false);
+        }
+        throw;
+    }
+    return written;
+}
+
+bool BufferPoolManagerInstance::TryPinDirty(frame_id_t frame_id, page_id_t page_id) {
+    auto page = &pages_[frame_id];
+    if (!page->IsDirty()) {
+        return false;
+    }
+    // only pin it when no one is using it, someone holding it will dirty it again anyway
+    int expected = 0;
+    if (!page->pin_count_.compare_exchange_strong(expected, 1, std::memory_order_acq_rel)) {
+        return false;
+    }
+    // frame might be reassigned before we pinned it
+    if (page->page_id_.load(std::memory_order_acquire) != page_id || !page->IsDirty()) {
+        OnPinReleased(frame_id, page->pin_count_.fetch_sub(1, std::memory_order_acq_rel), false);
+        return false;
+    }
+    return true;
+}
+
+void BufferPoolManagerInstance::WriteBatch(const std::vector<std::pair<page_id_t, frame_id_t>> &batch) {
+    std::vector<page_id_t> page_ids;
+    std::vector<const char *> data;
+    for (auto [page_id, frame_id] : batch) {
+        // dirty flag is cleared before the write, so modifications made during it won't be lost
+        pages_[frame_id].is_dirty_ = false;
+        page_ids.push_back(page_id);
+        data.push_back(pages_[frame_id].GetData());
+    }
+
+    auto unpin = [&]() {
+        for (auto [page_id, frame_id] : batch) {
+            int state = pages_[frame_id].pin_count_.fetch_sub(1, std::memory_order_acq_rel);
+            OnPinReleased(frame_id, state, false);
+        }
+    };
+    try {
+        disk_manager_->WritePages(page_ids, data);
+    } catch (...) {
+        for (auto [page_id, frame_id] : batch) {
+            pages_[frame_id].is_dirty_ = true;
+        }
+        unpin();
+        throw;
+    }
+    unpin();
+
+    cleaner_pages_written_.fetch_add(batch.size(), std::memory_order_relaxed);
+    cleaner_batches_.fetch_add(1, std::memory_order_relaxed);
+}
+
+PageCleanerStats BufferPoolManagerInstance::GetPageCleanerStats() {
+    PageCleanerStats stats;
+    stats.rounds_ = cleaner_rounds_.load(std::memory_order_relaxed);
+    stats.pages_written_ = cleaner_pages_written_.load(std::memory_order_relaxed);
+    stats.batches_ = cleaner_batches_.load(std::memory_order_relaxed);
+    stats.victims_ = victims_.load(std::memory_order_relaxed);
+    stats.dirty_victims_ = dirty_victims_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * @file buffer_pool_stats.cpp
+ * @author sheep
+ * @brief implementation of buffer pool statistics
+ * @version 0.1
+ * @date 2022-06-26
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace TinyDB {
+
+std::vector<std::pair<page_id_t, uint64_t>> BufferPoolStatsSnapshot::HotPages(size_t count) const {
+    std::vector<std::pair<page_id_t, uint64_t>> pages(heatmap_.begin(), heatmap_.end());
+    count = std::min(count, pages.size());
+    // ties are broken by page id, so the result is stable
+    std::partial_sort(pages.begin(), pages.begin() + count, pages.end(), [](const auto &a, const auto &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    pages.resize(count);
+    return pages;
+}
+
+BufferPoolStatsSnapshot &BufferPoolStatsSnapshot::operator+=(const BufferPoolStatsSnapshot &other) {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    fetch_failures_ += other.fetch_failures_;
+    new_pages_ += other.new_pages_;
+    new_page_failures_ += other.new_page_failures_;
+    evictions_ += other.evictions_;
+    dirty_write_backs_ += other.dirty_write_backs_;
+    latch_wait_ += other.latch_wait_;
+    for (auto [page_id, count] : other.heatmap_) {
+        heatmap_[page_id] += count;
+    }
+    return *this;
+}
+
+std::string BufferPoolStatsSnapshot::ToString() const {
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+        "fetch     : %lu, hit %lu, miss %lu, failed %lu, hit ratio %.2f%%\n"
+        "new page  : %lu, failed %lu\n"
+        "eviction  : %lu, dirty %lu\n"
+        "latch wait: %lu, avg %s, p99 %s, max %s\n",
+        static_cast<unsigned long>(Fetches()),
+        static_cast<unsigned long>(hits_),
+        static_cast<unsigned long>(misses_),
+        static_cast<unsigned long>(fetch_failures_),
+        HitRatio() * 100,
+        static_cast<unsigned long>(new_pages_),
+        static_cast<unsigned long>(new_page_failures_),
+        static_cast<unsigned long>(evictions_),
+        static_cast<unsigned long>(dirty_write_backs_),
+        static_cast<unsigned long>(latch_wait_.count_),
+        FormatDuration(static_cast<uint64_t>(latch_wait_.Mean())).c_str(),
+        FormatDuration(latch_wait_.Percentile(0.99)).c_str(),
+        FormatDuration(latch_wait_.max_).c_str());
+    return buffer;
+}
+
+uint64_t StripedCounter::Load() const {
+    uint64_t sum = 0;
+    for (auto &stripe : stripes_) {
+        sum += stripe.value_.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void StripedCounter::Reset() {
+    for (auto &stripe : stripes_) {
+        stripe.value_.store(0, std::memory_order_relaxed);
+    }
+}
+
+void BufferPoolStats::EnableHeatmap(bool enable) {
+    std::lock_guard<std::mutex> guard(heatmap_latch_);
+    heatmap_enabled_.store(enable, std::memory_order_relaxed);
+    if (!enable) {
+        heatmap_.clear();
+    }
+}
+
+BufferPoolStatsSnapshot BufferPoolStats::Snapshot() const {
+    BufferPoolStatsSnapshot snapshot;
+    snapshot.hits_ = hits_.Load();
+    snapshot.misses_ = misses_.load(std::memory_order_relaxed);
+    snapshot.fetch_failures_ = fetch_failures_.load(std::memory_order_relaxed);
+    snapshot.new_pages_ = new_pages_.load(std::memory_order_relaxed);
+    snapshot.new_page_failures_ = new_page_failures_.load(std::memory_order_relaxed);
+    snapshot.evictions_ = evictions_.load(std::memory_order_relaxed);
+    snapshot.dirty_write_backs_ = dirty_write_backs_.load(std::memory_order_relaxed);
+    snapshot.latch_wait_ = latch_wait_.Snapshot();
+    if (heatmap_enabled_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> guard(heatmap_latch_);
+        snapshot.heatmap_ = heatmap_;
+    }
+    return snapshot;
+}
+
+void BufferPoolStats::Reset() {
+    hits_.Reset();
+    misses_.store(0, std::memory_order_relaxed);
+    fetch_failures_.store(0, std::memory_order_relaxed);
+    new_pages_.store(0, std::memory_order_relaxed);
+    new_page_failures_.store(0, std::memory_order_relaxed);
+    evictions_.store(0, std::memory_order_relaxed);
+    dirty_write_backs_.store(0, std::memory_order_relaxed);
+    latch_wait_.Reset();
+    std::lock_guard<std::mutex> guard(heatmap_latch_);
+    heatmap_.clear();
+}
+
+}
@@ -0,0 +1,101 @@
+/**
+ * @file clock_replacer.cpp
+ * @author sheep
+ * @brief implementation of clock replacer
+ * @version 0.1
+ * @date 2022-06-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/clock_replacer.h"
+
+namespace TinyDB {
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), state_(new std::atomic<uint8_t>[num_pages]) {
+    for (size_t i = 0; i < num_pages_; i++) {
+        state_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool ClockReplacer::Evict(frame_id_t *victim) {
+    // two rounds clear all the reference bits, so we will find one within them
+    // unless frames are being touched concurrently
+    for (size_t i = 0; i < 2 * num_pages_ + 1; i++) {
+        if (size_.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+
+        size_t pos = hand_.fetch_add(1, std::memory_order_relaxed) % num_pages_;
+        uint8_t state = state_[pos].load(std::memory_order_relaxed);
+        if ((state & EVICTABLE) == 0) {
+            continue;
+        }
+        if ((state & REFERENCED) != 0) {
+            // second chance
+            state_[pos].compare_exchange_strong(state, state & ~REFERENCED, std::memory_order_relaxed);
+            continue;
+        }
+        if (state_[pos].compare_exchange_strong(state, 0, std::memory_order_acq_rel)) {
+            size_.fetch_sub(1, std::memory_order_relaxed);
+            *victim = static_cast<frame_id_t>(pos);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+    uint8_t state = state_[frame_id].fetch_and(static_cast<uint8_t>(~EVICTABLE), std::memory_order_acq_rel);
+    if ((state & EVICTABLE) != 0) {
+        size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+    uint8_t state = state_[frame_id].load(std::memory_order_relaxed);
+    do {
+        if ((state & EVICTABLE) != 0) {
+            return;
+        }
+    } while (!state_[frame_id].compare_exchange_weak(state, state | EVICTABLE | REFERENCED,
+                                                      std::memory_order_acq_rel));
+    size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id) {
+    uint8_t state = state_[frame_id].fetch_or(EVICTABLE, std::memory_order_acq_rel);
+    if ((state & EVICTABLE) == 0) {
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ClockReplacer::Touch(frame_id_t frame_id) {
+    uint8_t state = state_[frame_id].fetch_or(EVICTABLE | REFERENCED, std::memory_order_acq_rel);
+    if ((state & EVICTABLE) == 0) {
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ClockReplacer::PeekVictims(size_t count, std::vector<frame_id_t> *victims) {
+    size_t hand = hand_.load(std::memory_order_relaxed);
+    size_t added = 0;
+    for (uint8_t referenced : {static_cast<uint8_t>(0), REFERENCED}) {
+        for (size_t i = 0; i < num_pages_ && added < count; i++) {
+            size_t pos = (hand + i) % num_pages_;
+            uint8_t state = state_[pos].load(std::memory_order_relaxed);
+            if ((state & EVICTABLE) != 0 && (state & REFERENCED) == referenced) {
+                victims->push_back(static_cast<frame_id_t>(pos));
+                added++;
+            }
+        }
+    }
+}
+
+size_t ClockReplacer::Size() {
+    return size_.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,152 @@
+/**
+ * @file frame_arena.cpp
+ * @author sheep
+ * @brief implementation of frame arena
+ * @version 0.1
+ * @date 2022-06-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/frame_arena.h"
+#include "common/exception.h"
+#include "common/logger.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if __has_include(<linux/mempolicy.h>) && __has_include(<sys/syscall.h>)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#ifdef SYS_mbind
+#define TINYDB_HAS_MBIND
+#endif
+#endif
+
+namespace TinyDB {
+
+// map anonymous memory, return nullptr on failure
+static char *MapAnonymous(size_t size, int extra_flags) {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : static_cast<char *>(ptr);
+}
+
+#ifdef TINYDB_HAS_MBIND
+// parse the online node list, e.g. "0-1,4"
+static std::vector<int> GetOnlineNodes() {
+    std::vector<int> nodes;
+    std::ifstream file("/sys/devices/system/node/online");
+    std::string range;
+    while (std::getline(file, range, ',')) {
+        try {
+            auto dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int node = first; node <= last; node++) {
+                nodes.push_back(node);
+            }
+        } catch (...) {
+            return {};
+        }
+    }
+    return nodes;
+}
+#endif
+
+// interleave pages of the range across every online node, before any of them is touched
+static bool Interleave(char *data, size_t size) {
+#ifdef TINYDB_HAS_MBIND
+    auto nodes = GetOnlineNodes();
+    if (nodes.size() < 2) {
+        return false;
+    }
+    const size_t bits = sizeof(unsigned long) * CHAR_BIT;
+    std::vector<unsigned long> mask(nodes.back() / bits + 1, 0);
+    for (auto node : nodes) {
+        mask[node / bits] |= 1UL << (node % bits);
+    }
+    if (syscall(SYS_mbind, data, size, MPOL_INTERLEAVE, mask.data(), mask.size() * bits + 1, 0) != 0) {
+        LOG_WARN("failed to interleave frame arena across %zu nodes", nodes.size());
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+FrameArena::FrameArena(size_t frame_num, const FrameArenaConfig &config) {
+    size_t size = std::max<size_t>({frame_num, config.max_pool_size_, 1}) * PAGE_SIZE;
+    bool use_huge_page = config.huge_pages_ && size >= HUGE_PAGE_SIZE;
+    size_t huge_size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+#ifdef MAP_HUGETLB
+    // fails right away if administrator didn't reserve enough huge pages. they are
+    // committed at mmap, don't hold them for frames we might never use
+    if (use_huge_page && config.max_pool_size_ <= frame_num) {
+        data_ = MapAnonymous(huge_size, MAP_HUGETLB);
+        if (data_ != nullptr) {
+            size_ = huge_size;
+            huge_page_ = true;
+        }
+    }
+#endif
+
+    if (data_ == nullptr && use_huge_page) {
+        // ask for transparent huge pages. mapping is aligned with huge page by hand,
+        // otherwise kernel can't back the head and tail with huge pages
+        char *raw = MapAnonymous(huge_size + HUGE_PAGE_SIZE, 0);
+        if (raw != nullptr) {
+            auto addr = reinterpret_cast<uintptr_t>(raw);
+            auto aligned = (addr + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            size_t head = aligned - addr;
+            if (head > 0) {
+                munmap(raw, head);
+            }
+            size_t tail = HUGE_PAGE_SIZE - head;
+            if (tail > 0) {
+                munmap(reinterpret_cast<char *>(aligned) + huge_size, tail);
+            }
+            data_ = reinterpret_cast<char *>(aligned);
+            size_ = huge_size;
+#ifdef MADV_HUGEPAGE
+            madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+        }
+    }
+
+    if (data_ == nullptr) {
+        data_ = MapAnonymous(size, 0);
+        size_ = size;
+    }
+    if (data_ == nullptr) {
+        THROW_OUT_OF_MEMORY_EXCEPTION("failed to map frame arena of " + std::to_string(size) + " bytes");
+    }
+
+    if (config.numa_interleave_) {
+        interleaved_ = Interleave(data_, size_);
+    }
+}
+
+void FrameArena::Release(size_t first_frame, size_t frame_num) {
+    size_t granularity = huge_page_ ? HUGE_PAGE_SIZE : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = (first_frame * PAGE_SIZE + granularity - 1) / granularity * granularity;
+    size_t end = std::min((first_frame + frame_num) * PAGE_SIZE, size_) / granularity * granularity;
+    if (begin < end && madvise(data_ + begin, end - begin, MADV_DONTNEED) != 0) {
+        LOG_WARN("failed to release %zu bytes of frame arena", end - begin);
+    }
+}
+
+FrameArena::~FrameArena() {
+    munmap(data_, size_);
+}
+
+}
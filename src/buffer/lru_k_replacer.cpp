@@ -0,0 +1,187 @@
+/**
+ * @file lru_k_replacer.cpp
+ * @author sheep
+ * @brief implementation of lru-k replacer
+ * @version 0.1
+ * @date 2022-06-21
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/lru_k_replacer.h"
+
+namespace TinyDB {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period)
+    : k_(k == 0 ? 1 : k), correlated_period_(correlated_period), retained_capacity_(num_pages) {
+    frames_.resize(num_pages);
+    for (auto &frame : frames_) {
+        frame.history_.assign(k_, 0);
+    }
+}
+
+LRUKReplacer::FrameHistory &LRUKReplacer::GetFrame(frame_id_t frame_id) {
+    // frame id might exceed num_pages, e.g. replacer is used without buffer pool
+    if (static_cast<size_t>(frame_id) >= frames_.size()) {
+        size_t old_size = frames_.size();
+        frames_.resize(frame_id + 1);
+        for (size_t i = old_size; i < frames_.size(); i++) {
+            frames_[i].history_.assign(k_, 0);
+        }
+    }
+    return frames_[frame_id];
+}
+
+bool LRUKReplacer::Evict(frame_id_t *victim) {
+    std::lock_guard<std::mutex> guard(mu_);
+
+    if (evictable_.empty()) {
+        return false;
+    }
+
+    // frames whose next reference would be correlated are not eligible,
+    // fallback to the first one when all of them are
+    auto victim_it = evictable_.begin();
+    for (auto it = evictable_.begin(); it != evictable_.end(); ++it) {
+        if (current_time_ + 1 - std::get<1>(*it) > correlated_period_) {
+            victim_it = it;
+            break;
+        }
+    }
+
+    *victim = std::get<2>(*victim_it);
+    evictable_.erase(victim_it);
+
+    // frame will hold another page, remember the history of the old one
+    auto &frame = frames_[*victim];
+    Retain(&frame);
+    frame.history_.assign(k_, 0);
+    frame.last_ = 0;
+    frame.evictable_ = false;
+    frame.page_id_ = INVALID_PAGE_ID;
+    return true;
+}
+
+void LRUKReplacer::Retain(FrameHistory *frame) {
+    if (frame->page_id_ == INVALID_PAGE_ID || frame->last_ == 0 || retained_capacity_ == 0) {
+        return;
+    }
+    auto it = retained_map_.find(frame->page_id_);
+    if (it != retained_map_.end()) {
+        retained_.erase(it->second);
+    }
+    retained_.push_front(RetainedHistory{frame->page_id_, frame->history_, frame->last_});
+    retained_map_[frame->page_id_] = retained_.begin();
+    if (retained_.size() > retained_capacity_) {
+        retained_map_.erase(retained_.back().page_id_);
+        retained_.pop_back();
+    }
+}
+
+void LRUKReplacer::Load(frame_id_t frame_id, page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(mu_);
+
+    auto &frame = GetFrame(frame_id);
+    if (frame.evictable_) {
+        evictable_.erase(KeyOf(frame_id));
+    }
+    frame.page_id_ = page_id;
+    auto it = retained_map_.find(page_id);
+    if (it != retained_map_.end()) {
+        frame.history_ = std::move(it->second->history_);
+        frame.last_ = it->second->last_;
+        retained_.erase(it->second);
+        retained_map_.erase(it);
+    } else {
+        frame.history_.assign(k_, 0);
+        frame.last_ = 0;
+    }
+    if (frame.evictable_) {
+        evictable_.insert(KeyOf(frame_id));
+    }
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> guard(mu_);
+
+    auto &frame = GetFrame(frame_id);
+    // replacer don't own this frame
+    if (!frame.evictable_) {
+        return;
+    }
+    evictable_.erase(KeyOf(frame_id));
+    frame.evictable_ = false;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> guard(mu_);
+
+    auto &frame = GetFrame(frame_id);
+    if (frame.evictable_) {
+        return;
+    }
+    RecordAccess(frame_id);
+    frame.evictable_ = true;
+    evictable_.insert(KeyOf(frame_id));
+}
+
+void LRUKReplacer::SetEvictable(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> guard(mu_);
+
+    auto &frame = GetFrame(frame_id);
+    if (frame.evictable_) {
+        return;
+    }
+    frame.evictable_ = true;
+    evictable_.insert(KeyOf(frame_id));
+}
+
+void LRUKReplacer::Touch(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> guard(mu_);
+
+    auto &frame = GetFrame(frame_id);
+    if (frame.evictable_) {
+        evictable_.erase(KeyOf(frame_id));
+    }
+    RecordAccess(frame_id);
+    frame.evictable_ = true;
+    evictable_.insert(KeyOf(frame_id));
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+    auto &frame = frames_[frame_id];
+    uint64_t now = ++current_time_;
+
+    if (frame.last_ != 0 && now - frame.last_ <= correlated_period_) {
+        // correlated reference, it only extends the current one
+        frame.last_ = now;
+        return;
+    }
+
+    // uncorrelated reference. the correlated period of the previous reference is
+    // closed, shift the older references by its length, so that the burst
+    // counts as a single point in time
+    uint64_t correlated_length = frame.last_ != 0 ? frame.last_ - frame.history_[0] : 0;
+    for (size_t i = k_ - 1; i > 0; i--) {
+        frame.history_[i] = frame.history_[i - 1] != 0 ? frame.history_[i - 1] + correlated_length : 0;
+    }
+    frame.history_[0] = now;
+    frame.last_ = now;
+}
+
+void LRUKReplacer::PeekVictims(size_t count, std::vector<frame_id_t> *victims) {
+    std::lock_guard<std::mutex> guard(mu_);
+
+    // correlated period is ignored, it's only a hint
+    for (auto it = evictable_.begin(); it != evictable_.end() && count > 0; ++it, --count) {
+        victims->push_back(std::get<2>(*it));
+    }
+}
+
+size_t LRUKReplacer::Size() {
+    std::lock_guard<std::mutex> guard(mu_);
+    return evictable_.size();
+}
+
+}
@@ -72,6 +72,15 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
     table_[frame_id] = list_.begin();
 }
 
+void LRUReplacer::PeekVictims(size_t count, std::vector<frame_id_t> *victims) {
+    std::lock_guard<std::mutex> guard(mu_);
+
+    // least recently used ones are at the back
+    for (auto it = list_.rbegin(); it != list_.rend() && count > 0; ++it, --count) {
+        victims->push_back(*it);
+    }
+}
+
 size_t LRUReplacer::Size() {
     std::lock_guard<std::mutex> guard(mu_);
     return list_.size();
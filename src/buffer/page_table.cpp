@@ -0,0 +1,94 @@
+/**
+ * @file page_table.cpp
+ * @author sheep
+ * @brief implementation of page table
+ * @version 0.1
+ * @date 2022-06-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/page_table.h"
+#include "common/logger.h"
+
+namespace TinyDB {
+
+PageTable::PageTable(size_t capacity) {
+    // keep the load factor under 0.5, so probing sequences stay short
+    size_t slot_num = 2;
+    uint32_t bits = 1;
+    while (slot_num < capacity * 2) {
+        slot_num <<= 1;
+        bits++;
+    }
+    mask_ = slot_num - 1;
+    shift_ = 64 - bits;
+    slots_.reset(new std::atomic<uint64_t>[slot_num]);
+    for (size_t i = 0; i < slot_num; i++) {
+        slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+    }
+}
+
+int64_t PageTable::Locate(page_id_t page_id) const {
+    size_t pos = Home(page_id);
+    for (size_t i = 0; i <= mask_; i++) {
+        uint64_t slot = slots_[pos].load(std::memory_order_relaxed);
+        if (slot == EMPTY_SLOT) {
+            return -1;
+        }
+        if (PageOf(slot) == page_id) {
+            return pos;
+        }
+        pos = (pos + 1) & mask_;
+    }
+    return -1;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+    size_t pos = Home(page_id);
+    for (size_t i = 0; i <= mask_; i++) {
+        uint64_t slot = slots_[pos].load(std::memory_order_relaxed);
+        if (slot == EMPTY_SLOT || PageOf(slot) == page_id) {
+            if (slot == EMPTY_SLOT) {
+                size_++;
+            }
+            slots_[pos].store(Pack(page_id, frame_id), std::memory_order_release);
+            return;
+        }
+        pos = (pos + 1) & mask_;
+    }
+    // it should never happen, since we have twice the slots as frames
+    LOG_ERROR("page table is full, failed to insert page %d", page_id);
+}
+
+bool PageTable::Erase(page_id_t page_id) {
+    int64_t hole = Locate(page_id);
+    if (hole < 0) {
+        return false;
+    }
+
+    // backward shift deletion. move the entries after the hole into it, as long as
+    // the hole is still within their probing sequence. entry being moved is visible
+    // at both places for a moment, readers could only miss it, rather than see garbage
+    size_t i = hole;
+    size_t j = hole;
+    while (true) {
+        j = (j + 1) & mask_;
+        uint64_t slot = slots_[j].load(std::memory_order_relaxed);
+        if (slot == EMPTY_SLOT) {
+            break;
+        }
+        size_t home = Home(PageOf(slot));
+        // home is cyclically outside of (i, j], i.e. the entry could live in i
+        if (((j - home) & mask_) >= ((j - i) & mask_)) {
+            slots_[i].store(slot, std::memory_order_release);
+            i = j;
+        }
+    }
+    slots_[i].store(EMPTY_SLOT, std::memory_order_release);
+    size_--;
+    return true;
+}
+
+}
@@ -0,0 +1,192 @@
+/**
+ * @file parallel_buffer_pool_manager.cpp
+ * @author sheep
+ * @brief implementation of parallel buffer pool manager
+ * @version 0.1
+ * @date 2022-06-16
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/logger.h"
+
+namespace TinyDB {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     ReplacerType replacer_type,
+                                                     const FrameArenaConfig &arena_config)
+    : disk_manager_(disk_manager) {
+    if (num_instances == 0) {
+        LOG_WARN("buffer pool should have at least one instance");
+        num_instances = 1;
+    }
+    for (size_t i = 0; i < num_instances; i++) {
+        instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(pool_size, disk_manager_, replacer_type,
+                                                                       arena_config));
+    }
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return GetInstance(page_id)->FetchPage(page_id, strategy);
+}
+
+Page *ParallelBufferPoolManager::FetchResidentPage(page_id_t page_id) {
+    return GetInstance(page_id)->FetchResidentPage(page_id);
+}
+
+void ParallelBufferPoolManager::RecordHit(page_id_t page_id) {
+    GetInstance(page_id)->RecordHit(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+    return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+    return GetInstance(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPage(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy) {
+    // ids whose instance is full. we hold them until we are done,
+    // otherwise disk manager would hand out the same id again
+    std::vector<page_id_t> skipped;
+    Page *page = nullptr;
+
+    // consecutive ids land on different instances, so trying num_instances ids
+    // will most likely visit every instance
+    for (size_t i = 0; i < instances_.size(); i++) {
+        page_id_t new_page_id = disk_manager_->AllocatePage(hint);
+        page = GetInstance(new_page_id)->NewAllocatedPage(new_page_id, strategy);
+        if (page != nullptr) {
+            *page_id = new_page_id;
+            break;
+        }
+        skipped.push_back(new_page_id);
+        // the hinted position is taken, don't bother placing the rest there
+        hint = INVALID_PAGE_ID;
+    }
+
+    for (auto skipped_page_id : skipped) {
+        disk_manager_->DeallocatePage(skipped_page_id);
+    }
+    return page;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) {
+    return GetInstance(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+    for (auto &instance : instances_) {
+        instance->FlushAllPages();
+    }
+}
+
+void ParallelBufferPoolManager::Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+    std::vector<std::vector<page_id_t>> groups(instances_.size());
+    for (auto page_id : page_ids) {
+        if (page_id != INVALID_PAGE_ID) {
+            groups[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+        }
+    }
+    for (size_t i = 0; i < instances_.size(); i++) {
+        if (!groups[i].empty()) {
+            instances_[i]->Prefetch(groups[i], strategy);
+        }
+    }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+    size_t pool_size = 0;
+    for (auto &instance : instances_) {
+        pool_size += instance->GetPoolSize();
+    }
+    return pool_size;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t pool_size) {
+    // pages are spread evenly, so are the frames. the first instances take the remainder
+    size_t num_instances = instances_.size();
+    for (size_t i = 0; i < num_instances; i++) {
+        size_t size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+        if (size == 0 || size > instances_[i]->GetMaxPoolSize()) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < num_instances; i++) {
+        instances_[i]->Resize(pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0));
+    }
+    return true;
+}
+
+void ParallelBufferPoolManager::WaitForPrefetch() {
+    for (auto &instance : instances_) {
+        instance->WaitForPrefetch();
+    }
+}
+
+bool ParallelBufferPoolManager::CheckPinCount() {
+    bool flag = true;
+    for (auto &instance : instances_) {
+        flag = instance->CheckPinCount() && flag;
+    }
+    return flag;
+}
+
+BufferPoolStatsSnapshot ParallelBufferPoolManager::GetStats() {
+    BufferPoolStatsSnapshot stats;
+    for (auto &instance : instances_) {
+        stats += instance->GetStats();
+    }
+    return stats;
+}
+
+void ParallelBufferPoolManager::ResetStats() {
+    for (auto &instance : instances_) {
+        instance->ResetStats();
+    }
+}
+
+void ParallelBufferPoolManager::EnableHeatmap(bool enable) {
+    for (auto &instance : instances_) {
+        instance->EnableHeatmap(enable);
+    }
+}
+
+void ParallelBufferPoolManager::GetResidentPages(std::vector<std::pair<page_id_t, uint32_t>> *pages) {
+    for (auto &instance : instances_) {
+        instance->GetResidentPages(pages);
+    }
+}
+
+void ParallelBufferPoolManager::StartPageCleaner(const PageCleanerConfig &config) {
+    for (auto &instance : instances_) {
+        instance->StartPageCleaner(config);
+    }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+    for (auto &instance : instances_) {
+        instance->StopPageCleaner();
+    }
+}
+
+size_t ParallelBufferPoolManager::CleanDirtyPages(const PageCleanerConfig &config) {
+    size_t written = 0;
+    for (auto &instance : instances_) {
+        written += instance->CleanDirtyPages(config);
+    }
+    return written;
+}
+
+PageCleanerStats ParallelBufferPoolManager::GetPageCleanerStats() {
+    PageCleanerStats stats;
+    for (auto &instance : instances_) {
+        stats += instance->GetPageCleanerStats();
+    }
+    return stats;
+}
+
+}
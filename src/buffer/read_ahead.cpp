@@ -0,0 +1,65 @@
+/**
+ * @file read_ahead.cpp
+ * @author sheep
+ * @brief implementation of read-ahead window
+ * @version 0.1
+ * @date 2022-06-24
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/read_ahead.h"
+#include "buffer/buffer_pool_manager.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace TinyDB {
+
+void ReadAheadWindow::OnPage(BufferPoolManager *bpm, page_id_t page_id, page_id_t next_page_id,
+                             BufferAccessStrategy *strategy) {
+    if (page_id == last_page_id_) {
+        return;
+    }
+    bool sequential = last_page_id_ != INVALID_PAGE_ID && page_id == last_page_id_ + 1
+        && next_page_id == page_id + 1;
+    last_page_id_ = page_id;
+    if (max_window_ == 0 || next_page_id == INVALID_PAGE_ID) {
+        window_ = 0;
+        issued_end_ = INVALID_PAGE_ID;
+        return;
+    }
+
+    std::vector<page_id_t> page_ids;
+    if (!sequential) {
+        // only the next one is known
+        window_ = 1;
+        page_ids.push_back(next_page_id);
+        issued_end_ = next_page_id + 1;
+        bpm->Prefetch(page_ids, strategy);
+        return;
+    }
+
+    size_t max_window = max_window_;
+    if (strategy != nullptr) {
+        max_window = std::min(max_window, std::max<size_t>(strategy->GetRingSize() / 2, 1));
+    }
+    window_ = std::min(std::max<size_t>(window_ * 2, 1), max_window);
+
+    page_id_t begin = std::max(issued_end_, next_page_id);
+    page_id_t end = next_page_id + static_cast<page_id_t>(window_);
+    // next page is already in flight, wait until we could ask for a bigger batch
+    if (begin > next_page_id && static_cast<size_t>(end - begin) < (window_ + 1) / 2) {
+        return;
+    }
+    for (page_id_t id = begin; id < end; id++) {
+        page_ids.push_back(id);
+    }
+    if (!page_ids.empty()) {
+        issued_end_ = end;
+        bpm->Prefetch(page_ids, strategy);
+    }
+}
+
+}
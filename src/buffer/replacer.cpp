@@ -0,0 +1,31 @@
+/**
+ * @file replacer.cpp
+ * @author sheep
+ * @brief factory of replacers
+ * @version 0.1
+ * @date 2022-06-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "buffer/replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+
+namespace TinyDB {
+
+std::unique_ptr<Replacer> Replacer::Create(ReplacerType type, size_t num_pages) {
+    switch (type) {
+    case ReplacerType::CLOCK:
+        return std::make_unique<ClockReplacer>(num_pages);
+    case ReplacerType::LRU_K:
+        return std::make_unique<LRUKReplacer>(num_pages);
+    case ReplacerType::LRU:
+    default:
+        return std::make_unique<LRUReplacer>(num_pages);
+    }
+}
+
+}
@@ -0,0 +1,93 @@
+/**
+ * @file histogram.cpp
+ * @author sheep
+ * @brief implementation of latency histogram
+ * @version 0.1
+ * @date 2022-06-13
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "common/histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace TinyDB {
+
+uint64_t HistogramSnapshot::Percentile(double p) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * count_)));
+    uint64_t cumulative = 0;
+    for (uint32_t i = 0; i < buckets_.size(); i++) {
+        cumulative += buckets_[i];
+        if (cumulative >= target) {
+            return std::min(LatencyHistogram::BucketUpperBound(i), max_);
+        }
+    }
+    return max_;
+}
+
+HistogramSnapshot &HistogramSnapshot::operator+=(const HistogramSnapshot &other) {
+    if (buckets_.size() < other.buckets_.size()) {
+        buckets_.resize(other.buckets_.size());
+    }
+    for (size_t i = 0; i < other.buckets_.size(); i++) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    max_ = std::max(max_, other.max_);
+    return *this;
+}
+
+HistogramSnapshot LatencyHistogram::Snapshot() const {
+    HistogramSnapshot snapshot;
+    snapshot.buckets_.resize(BUCKET_NUM);
+    for (uint32_t i = 0; i < BUCKET_NUM; i++) {
+        snapshot.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+        snapshot.count_ += snapshot.buckets_[i];
+    }
+    snapshot.sum_ = sum_.load(std::memory_order_relaxed);
+    snapshot.max_ = max_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void LatencyHistogram::Reset() {
+    for (auto &bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(uint32_t idx) {
+    if (idx < SUB_BUCKET_NUM) {
+        return idx;
+    }
+    uint32_t msb = (idx >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+    uint64_t sub = idx & (SUB_BUCKET_NUM - 1);
+    uint64_t width = 1ULL << (msb - SUB_BUCKET_BITS);
+    // for the last bucket it wraps around to UINT64_MAX, which is what we want
+    return (1ULL << msb) + (sub + 1) * width - 1;
+}
+
+std::string FormatDuration(uint64_t nanoseconds) {
+    char buffer[32];
+    if (nanoseconds < 1000) {
+        snprintf(buffer, sizeof(buffer), "%luns", static_cast<unsigned long>(nanoseconds));
+    } else if (nanoseconds < 1000000) {
+        snprintf(buffer, sizeof(buffer), "%.1fus", nanoseconds / 1e3);
+    } else if (nanoseconds < 1000000000) {
+        snprintf(buffer, sizeof(buffer), "%.1fms", nanoseconds / 1e6);
+    } else {
+        snprintf(buffer, sizeof(buffer), "%.2fs", nanoseconds / 1e9);
+    }
+    return buffer;
+}
+
+}
@@ -0,0 +1,196 @@
+/**
+ * @file lz_codec.cpp
+ * @author sheep
+ * @brief implementation of lz codec
+ * @version 0.1
+ * @date 2022-06-14
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "common/lz_codec.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace TinyDB {
+
+namespace {
+
+// size of the hash table used to find matches, 4096 entries is enough for a page
+constexpr uint32_t HASH_BITS = 12;
+constexpr uint32_t LENGTH_MASK = 15;
+
+inline uint32_t Read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t Hash(uint32_t value) {
+    return (value * 2654435761U) >> (32 - HASH_BITS);
+}
+
+// append the extension bytes of a length
+inline bool WriteLength(size_t length, uint8_t **op, const uint8_t *oend) {
+    while (length >= 255) {
+        if (*op >= oend) {
+            return false;
+        }
+        *(*op)++ = 255;
+        length -= 255;
+    }
+    if (*op >= oend) {
+        return false;
+    }
+    *(*op)++ = static_cast<uint8_t>(length);
+    return true;
+}
+
+inline bool ReadLength(const uint8_t **ip, const uint8_t *iend, size_t *length) {
+    uint8_t byte;
+    do {
+        if (*ip >= iend) {
+            return false;
+        }
+        byte = *(*ip)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// append a sequence, match_length of 0 means it's the last one
+bool WriteSequence(const uint8_t *literals, size_t literal_length, size_t offset, size_t match_length,
+                   uint8_t **op, const uint8_t *oend) {
+    if (*op >= oend) {
+        return false;
+    }
+    uint8_t *token = (*op)++;
+    size_t match_code = match_length == 0 ? 0 : match_length - LZCodec::MIN_MATCH;
+    *token = static_cast<uint8_t>((std::min<size_t>(literal_length, LENGTH_MASK) << 4)
+                                  | std::min<size_t>(match_code, LENGTH_MASK));
+
+    if (literal_length >= LENGTH_MASK && !WriteLength(literal_length - LENGTH_MASK, op, oend)) {
+        return false;
+    }
+    if (static_cast<size_t>(oend - *op) < literal_length) {
+        return false;
+    }
+    memcpy(*op, literals, literal_length);
+    *op += literal_length;
+
+    if (match_length == 0) {
+        return true;
+    }
+    if (oend - *op < 2) {
+        return false;
+    }
+    *(*op)++ = static_cast<uint8_t>(offset);
+    *(*op)++ = static_cast<uint8_t>(offset >> 8);
+    if (match_code >= LENGTH_MASK && !WriteLength(match_code - LENGTH_MASK, op, oend)) {
+        return false;
+    }
+    return true;
+}
+
+}
+
+size_t LZCodec::Compress(const char *src, size_t size, char *dst, size_t capacity) {
+    auto in = reinterpret_cast<const uint8_t *>(src);
+    auto op = reinterpret_cast<uint8_t *>(dst);
+    auto oend = op + capacity;
+
+    // position of the last occurrence of each hash.
+    // candidates are verified before we use them, so stale or truncated entries are harmless
+    uint32_t table[1 << HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    size_t ip = 0;
+    size_t anchor = 0;
+    while (size >= MIN_MATCH && ip <= size - MIN_MATCH) {
+        uint32_t sequence = Read32(in + ip);
+        uint32_t hash = Hash(sequence);
+        size_t candidate = table[hash];
+        table[hash] = static_cast<uint32_t>(ip);
+
+        if (candidate < ip && ip - candidate <= MAX_OFFSET && Read32(in + candidate) == sequence) {
+            size_t length = MIN_MATCH;
+            while (ip + length < size && in[candidate + length] == in[ip + length]) {
+                length++;
+            }
+            if (!WriteSequence(in + anchor, ip - anchor, ip - candidate, length, &op, oend)) {
+                return 0;
+            }
+            ip += length;
+            anchor = ip;
+        } else {
+            // step faster when data doesn't compress, so random data won't cost us too much
+            ip += 1 + ((ip - anchor) >> 6);
+        }
+    }
+
+    if (!WriteSequence(in + anchor, size - anchor, 0, 0, &op, oend)) {
+        return 0;
+    }
+    return op - reinterpret_cast<uint8_t *>(dst);
+}
+
+int64_t LZCodec::Decompress(const char *src, size_t size, char *dst, size_t capacity) {
+    auto ip = reinterpret_cast<const uint8_t *>(src);
+    auto iend = ip + size;
+    auto start = reinterpret_cast<uint8_t *>(dst);
+    auto op = start;
+    auto oend = start + capacity;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == LENGTH_MASK && !ReadLength(&ip, iend, &literal_length)) {
+            return -1;
+        }
+        if (static_cast<size_t>(iend - ip) < literal_length || static_cast<size_t>(oend - op) < literal_length) {
+            return -1;
+        }
+        memcpy(op, ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+
+        // last sequence doesn't have a match
+        if (ip == iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - start)) {
+            return -1;
+        }
+        size_t match_length = token & LENGTH_MASK;
+        if (match_length == LENGTH_MASK && !ReadLength(&ip, iend, &match_length)) {
+            return -1;
+        }
+        match_length += MIN_MATCH;
+        if (static_cast<size_t>(oend - op) < match_length) {
+            return -1;
+        }
+
+        const uint8_t *match = op - offset;
+        if (offset >= match_length) {
+            memcpy(op, match, match_length);
+            op += match_length;
+        } else {
+            // overlapping copy, e.g. a run of the same byte. copy it byte by byte
+            for (size_t i = 0; i < match_length; i++) {
+                *op++ = *match++;
+            }
+        }
+    }
+    return op - start;
+}
+
+}
@@ -0,0 +1,103 @@
+/**
+ * @file rwlatch.cpp
+ * @author sheep
+ * @brief slow paths of reader writer latch
+ * @version 0.1
+ * @date 2022-06-29
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "common/rwlatch.h"
+
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace TinyDB {
+
+namespace {
+
+// futex works on the raw word
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+// most latches are held for a short while, so spin a little before going to sleep
+constexpr int SPIN_LIMIT = 128;
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+}
+
+void ReaderWriterLatch::WLockSlow() {
+    bool waiting = false;
+    int spin_count = 0;
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while (true) {
+        if ((state & (WRITER | READER_MASK)) == 0) {
+            // latch is free. we are no longer waiting once we've got it
+            uint32_t target = (state | WRITER) - (waiting ? WAITING_WRITER : 0);
+            if (state_.compare_exchange_weak(state, target, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+            continue;
+        }
+        if (!waiting) {
+            // hold off the readers coming after us
+            if (state_.compare_exchange_weak(state, state + WAITING_WRITER, std::memory_order_relaxed)) {
+                waiting = true;
+                state += WAITING_WRITER;
+            }
+            continue;
+        }
+        Wait(state, &spin_count);
+        state = state_.load(std::memory_order_relaxed);
+    }
+}
+
+void ReaderWriterLatch::RLockSlow() {
+    int spin_count = 0;
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while (true) {
+        if (CanRead(state)) {
+            if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+            continue;
+        }
+        Wait(state, &spin_count);
+        state = state_.load(std::memory_order_relaxed);
+    }
+}
+
+void ReaderWriterLatch::Wait(uint32_t state, int *spin_count) {
+    if (*spin_count < SPIN_LIMIT) {
+        (*spin_count)++;
+        CpuRelax();
+        return;
+    }
+    // ask the unlocker to wake us up. if the word has changed meanwhile, go back and look again
+    if ((state & PARKED) == 0) {
+        if (!state_.compare_exchange_strong(state, state | PARKED, std::memory_order_relaxed)) {
+            return;
+        }
+        state |= PARKED;
+    }
+    // kernel checks the word again before we sleep, so the wake up can't be lost
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state_), FUTEX_WAIT_PRIVATE, state, nullptr, nullptr, 0);
+}
+
+void ReaderWriterLatch::Wake() {
+    // we don't know who is sleeping for what, wake them all, and they will go back to sleep
+    // if it's not their turn. it's rare since we've spun before sleeping
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state_), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+}
@@ -59,7 +59,8 @@ Result<> TwoPLManager::Read(TransactionContext *txn_context,
     return res;
 }
 
-void TwoPLManager::Insert(TransactionContext *txn_context, const Tuple &tuple, RID *rid, TableInfo *table_info) {
+void TwoPLManager::Insert(TransactionContext *txn_context, const Tuple &tuple, RID *rid, TableInfo *table_info,
+                          BufferAccessStrategy *strategy) {
     TINYDB_ASSERT(txn_context->IsAborted() == false, "Trying to executing aborted transaction");
     auto context = txn_context->Cast<TwoPLContext>();
     // for insertion, we will first try to acquire the exclusive lock on an empty slot
@@ -80,7 +81,7 @@ void TwoPLManager::Insert(TransactionContext *txn_context, const Tuple &tuple, R
         lock_manager->LockExclusive(context, rid);
     };
 
-    auto res = table_info->table_->InsertTuple(tuple, rid, context, callback);
+    auto res = table_info->table_->InsertTuple(tuple, rid, context, callback, strategy);
     if (res.IsErr()) {
         // we abort the transaction
         throw TransactionAbortException(context->GetTxnId(), "Failed to insert tuple");
@@ -26,6 +26,10 @@ void InsertExecutor::Init() {
     indexes_ = context_->GetCatalog()->GetTableIndexes(table_info_->name_);
     txn_manager_ = context_->GetTransactionManager();
     txn_context_ = context_->GetTransactionContext();
+    auto bpm = context_->GetBufferPoolManager();
+    if (strategy_ == nullptr && bpm != nullptr) {
+        strategy_ = std::make_unique<BufferAccessStrategy>(BufferAccessType::BULK_WRITE, bpm->GetPoolSize());
+    }
 }
 
 bool InsertExecutor::Next(Tuple *tuple) {
@@ -41,14 +45,14 @@ bool InsertExecutor::NextWithTxn(Tuple *tuple) {
     if (node.IsRawInsert()) {
         for (const auto &tuple: node.tuples_) {
             RID rid;
-            txn_manager_->Insert(txn_context_, tuple, &rid, table_info_);
+            txn_manager_->Insert(txn_context_, tuple, &rid, table_info_, strategy_.get());
         }
     } else {
         TINYDB_ASSERT(child_->GetOutputSchema()->Equal(*table_schema_), "Tuple schema not match");
         Tuple tmp_tuple;
         RID rid;
         while (child_->Next(&tmp_tuple)) {
-            txn_manager_->Insert(txn_context_, tmp_tuple, &rid, table_info_);
+            txn_manager_->Insert(txn_context_, tmp_tuple, &rid, table_info_, strategy_.get());
         }
     }
 
@@ -88,7 +92,7 @@ void InsertExecutor::NonRawValueInsertion() {
 
 void InsertExecutor::InsertTuple(const Tuple &tuple) {
     RID rid;
-    if (table_info_->table_->InsertTuple(tuple, &rid).IsOk()) {
+    if (table_info_->table_->InsertTuple(tuple, &rid, nullptr, nullptr, strategy_.get()).IsOk()) {
         // insert tuple into indexes
         for (auto index_info : indexes_) {
             index_info->index_->InsertEntryTupleSchema(tuple, rid);
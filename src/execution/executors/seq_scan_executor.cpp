@@ -19,8 +19,13 @@ void SeqScanExecutor::Init() {
     auto plan = GetPlanNode<SeqScanPlan>();
     // store table info
     table_info_ = context_->GetCatalog()->GetTable(plan.GetTableOid());
+    // keep the ring when we are initialized again, e.g. inner table of nested loop join
+    auto bpm = context_->GetBufferPoolManager();
+    if (strategy_ == nullptr && bpm != nullptr) {
+        strategy_ = std::make_unique<BufferAccessStrategy>(BufferAccessType::BULK_READ, bpm->GetPoolSize());
+    }
     // initialize the iterator
-    iterator_ = table_info_->table_->Begin();
+    iterator_ = table_info_->table_->Begin(strategy_.get());
     table_schema_ = &table_info_->schema_;
     txn_context_ = context_->GetTransactionContext();
     txn_manager_ = context_->GetTransactionManager();
@@ -0,0 +1,100 @@
+/**
+ * @file buffer_access_strategy.h
+ * @author sheep
+ * @brief private ring of frames for large sequential operations
+ * @version 0.1
+ * @date 2022-06-22
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BUFFER_ACCESS_STRATEGY_H
+#define BUFFER_ACCESS_STRATEGY_H
+
+#include "common/config.h"
+
+#include <cstddef>
+#include <deque>
+
+namespace TinyDB {
+
+enum class BufferAccessType {
+    // sequential scan, e.g. seq scan executor or populating a new index
+    BULK_READ,
+    // bulk inserts, e.g. insert ... select
+    BULK_WRITE,
+};
+
+/**
+ * @brief
+ * BufferAccessStrategy is a small ring of frames that a large sequential operation recycles
+ * by itself. when the page it asks for is not cached, buffer pool reuses the oldest frame
+ * in the ring instead of evicting a page from the shared pool, so a scan over a big table
+ * only takes ring size frames, rather than pushing out the whole working set.
+ * pages that are already cached are used as is, they don't join the ring.
+ * a ring frame is only reused if it still holds the page we put there and no one is
+ * using it, otherwise it's left to the shared pool and we get a frame in the normal way.
+ *
+ * strategy is not thread-safe, it's owned by a single operation, e.g. an executor.
+ * one strategy could be used with ParallelBufferPoolManager, each instance only reuses
+ * the frames it owns.
+ */
+class BufferAccessStrategy {
+public:
+    // 256KB ring for scans, small enough to stay in L2 cache
+    static constexpr size_t BULK_READ_RING_BYTES = 256 * 1024;
+    // bulk writes use a larger ring, so that dirty pages get some time to be written
+    // back by others before we have to write them ourselves
+    static constexpr size_t BULK_WRITE_RING_BYTES = 16 * 1024 * 1024;
+
+    /**
+     * @brief Construct a new BufferAccessStrategy object
+     * @param ring_size number of frames in the ring, at least 1
+     */
+    explicit BufferAccessStrategy(size_t ring_size);
+
+    /**
+     * @brief Construct a new BufferAccessStrategy object with the default ring size of type.
+     * ring never takes more than 1/8 of the buffer pool
+     * @param type kind of the operation
+     * @param pool_size size of the buffer pool, i.e. BufferPoolManager::GetPoolSize
+     */
+    BufferAccessStrategy(BufferAccessType type, size_t pool_size);
+
+    inline size_t GetRingSize() const {
+        return ring_size_;
+    }
+
+    /**
+     * @brief
+     * used by buffer pool. when the ring is full, take out the oldest slot owned by owner.
+     * if there is none, the oldest slot is dropped, its frame is left to the shared pool
+     * @param owner buffer pool instance asking for a frame
+     * @param page_id page we put into the frame
+     * @param frame_id the frame
+     * @return false when there is no slot to reuse
+     */
+    bool GetVictim(const void *owner, page_id_t *page_id, frame_id_t *frame_id);
+
+    /**
+     * @brief
+     * used by buffer pool. page_id is loaded into frame_id through this strategy
+     */
+    void Add(const void *owner, page_id_t page_id, frame_id_t frame_id);
+
+private:
+    struct Slot {
+        const void *owner_;
+        page_id_t page_id_;
+        frame_id_t frame_id_;
+    };
+
+    size_t ring_size_;
+    // oldest first
+    std::deque<Slot> ring_;
+};
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * @file buffer_pool_dumper.h
+ * @author sheep
+ * @brief dump resident pages of buffer pool, and load them back after restart
+ * @version 0.1
+ * @date 2022-06-28
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BUFFER_POOL_DUMPER_H
+#define BUFFER_POOL_DUMPER_H
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace TinyDB {
+
+struct BufferPoolDumpConfig {
+    // warm-up stops once this fraction of buffer pool is loaded, hottest pages go first.
+    // leave some room for whatever comes first after restart
+    double warm_up_fraction_{0.75};
+    // pages requested in a single prefetch, capped by a quarter of buffer pool.
+    // pages of a batch are sorted, so neighbors are read together
+    size_t batch_size_{256};
+    // time between two dumps of the periodic dumper
+    std::chrono::milliseconds interval_{std::chrono::minutes(5)};
+    // dump once more when the dumper is destroyed, buffer pool should still be alive by then
+    bool dump_on_shutdown_{false};
+};
+
+/**
+ * @brief
+ * BufferPoolDumper remembers which pages are cached and how hot they are, so that a
+ * restarted buffer pool doesn't have to refill itself one miss at a time.
+ * the dump is a text file, one "page <page id> <temperature>" per line, hottest first.
+ * nothing is dumped or loaded on its own: caller should call Dump on clean shutdown before
+ * the disk manager is closed (or set dump_on_shutdown_ to let the destructor do it), and
+ * WarmUp on startup before accepting traffic. the periodic dumper keeps the file fresh in
+ * case we crash
+ */
+class BufferPoolDumper {
+public:
+    BufferPoolDumper(BufferPoolManager *bpm, std::string filename,
+                     const BufferPoolDumpConfig &config = BufferPoolDumpConfig());
+
+    ~BufferPoolDumper();
+
+    DISALLOW_COPY(BufferPoolDumper);
+
+    /**
+     * @brief
+     * write the resident pages. it's written to a temporary file, synced, then renamed
+     * and the directory is synced, so a crash in the middle leaves the previous dump
+     * @return number of pages dumped
+     */
+    size_t Dump();
+
+    /**
+     * @brief
+     * load the hottest pages in the dump. they are prefetched in batches sorted by page id,
+     * and we wait until all of them are loaded. pages that no longer exist are skipped.
+     * it's fine if there is no dump
+     * @return number of pages requested
+     */
+    size_t WarmUp();
+
+    /**
+     * @brief
+     * read the dump, hottest first. empty when there is no dump
+     */
+    std::vector<std::pair<page_id_t, uint32_t>> ReadDump();
+
+    /**
+     * @brief
+     * dump every interval in background. it's stopped when the dumper is destroyed,
+     * without a final dump unless dump_on_shutdown_ is set
+     */
+    void StartPeriodicDump();
+
+    void StopPeriodicDump();
+
+private:
+    void RunPeriodicDump();
+
+    BufferPoolManager *bpm_;
+    std::string filename_;
+    BufferPoolDumpConfig config_;
+
+    // periodic dumper
+    bool enable_periodic_dump_{false};
+    std::thread *dump_thread_{nullptr};
+    std::mutex dump_latch_;
+    std::condition_variable dump_cv_;
+};
+
+}
+
+#endif
@@ -1,129 +1,188 @@
 /**
  * @file buffer_pool_manager.h
  * @author sheep
- * @brief simple buffer pool manager that very likely to become the bottleneck
+ * @brief interface of buffer pool manager
+ * different implementation should own it's own file
  * @version 0.1
  * @date 2022-04-30
- * 
+ *
  * @copyright Copyright (c) 2022
- * 
+ *
  */
 
 #ifndef BUFFER_POOL_MANAGER_H
 #define BUFFER_POOL_MANAGER_H
 
-#include "buffer/replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
 #include "storage/page/page.h"
-#include "storage/disk/disk_manager.h"
 #include "common/config.h"
 
-#include <unordered_map>
-#include <list>
-#include <mutex>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace TinyDB {
 
+/**
+ * @brief
+ * buffer pool manager caches disk pages in memory. upper layers (table heap, b+tree, catalog)
+ * only talk to this interface, so they don't care whether pages are cached by a single
+ * instance or spread across several of them.
+ * BufferPoolManagerInstance is the basic implementation, ParallelBufferPoolManager shards
+ * pages across multiple instances.
+ */
 class BufferPoolManager {
 public:
+    BufferPoolManager() = default;
+    virtual ~BufferPoolManager() = default;
+
     /**
-     * @brief Construct a new Buffer Pool Manager object
-     * 
-     * @param pool_size size of buffer pool
-     * @param disk_manager disk manager
+     * @brief
+     * fetch a page though page id ignoring whether it's from disk or memory
+     * @param page_id
+     * @param strategy when the page is not cached, read it into a frame of this ring
+     * instead of evicting a page from the shared pool. nullptr means the normal way
+     * @return pointer pointing to corresponding page, or nullptr when we don't have more slots
      */
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+    virtual Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) = 0;
 
     /**
-     * @brief Destroy the Buffer Pool Manager object
-     * 
+     * @brief
+     * pin the page only when it's cached, never go to disk for it.
+     * optimistic readers use it to follow a page id before they could make sure the page is
+     * still alive, loading a page that was deleted meanwhile would bring it back to life.
+     * it's not counted in stats, see RecordHit
+     * @param page_id
+     * @return pointer pointing to corresponding page, or nullptr when it's not cached
      */
-    ~BufferPoolManager();
+    virtual Page *FetchResidentPage(page_id_t page_id) = 0;
 
     /**
-     * @brief 
-     * fetch a page though page id ignoring whether it's from disk or memory
-     * @param page_id 
-     * @return pointer pointing to corresponding page, or nullptr when we don't have more slots
+     * @brief
+     * count a hit on the page. optimistic readers may give up and start over several times,
+     * so they count the pages they've got from FetchResidentPage once the read succeeds
      */
-    Page *FetchPage(page_id_t page_id);
+    virtual void RecordHit(page_id_t page_id) = 0;
 
     /**
-     * @brief 
+     * @brief
      * unpin the page. Now it can be swapped out from memory.
      * if we've modified it, then is_dirty should set to true
-     * @param page_id 
-     * @param is_dirty 
+     * @param page_id
+     * @param is_dirty
      * @return true when we successfully unpined the page
      * @return false when page is not in memory, or the pin count is zero
      */
-    bool UnpinPage(page_id_t page_id, bool is_dirty);
+    virtual bool UnpinPage(page_id_t page_id, bool is_dirty) = 0;
 
     /**
-     * @brief 
+     * @brief
      * flush the page to disk
-     * @param page_id 
+     * @param page_id
      * @return true when we successfully flushed the page
      * @return false when the page is not in memory
      */
-    bool FlushPage(page_id_t page_id);
+    virtual bool FlushPage(page_id_t page_id) = 0;
 
     /**
-     * @brief 
+     * @brief
      * create a new page in the buffer pool. return the new page id
-     * @param page_id 
+     * @param page_id
+     * @param hint page that new page is logically followed, disk manager will try to place
+     * the new page right after it
+     * @param strategy ring the new page is placed in, see FetchPage
      * @return pointer pointing to new page, or nullptr if we don't have more space
      */
-    Page *NewPage(page_id_t *page_id);
+    virtual Page *NewPage(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID,
+                          BufferAccessStrategy *strategy = nullptr) = 0;
 
     /**
-     * @brief 
+     * @brief
      * delete the page, return it back to disk
-     * @param page_id 
+     * @param page_id
      * @return true when deletion succeed
-     * @return false when someone is still using this page
+     * @return false when someone is still using this page. the page will be deallocated
+     * once it's unpinned by the last user
      */
-    bool DeletePage(page_id_t page_id);
+    virtual bool DeletePage(page_id_t page_id) = 0;
 
     /**
-     * @brief 
+     * @brief
      * flush all pages to disk
      */
-    void FlushAllPages();
+    virtual void FlushAllPages() = 0;
+
+    /**
+     * @brief
+     * start loading the pages that are not cached, without waiting for them and without
+     * pinning them. it's only a hint, pages might be skipped when buffer pool is busy,
+     * and prefetched pages might be evicted before anyone asks for them.
+     * by default it does nothing
+     * @param page_ids pages we are going to fetch soon
+     * @param strategy ring the pages are loaded into, see FetchPage
+     */
+    virtual void Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) {}
+
+    /**
+     * @brief
+     * block until every page prefetched so far is either loaded or given up.
+     * by default there is nothing to wait for
+     */
+    virtual void WaitForPrefetch() {}
 
     /**
      * @brief
      * return the size of buffer pool
-     * @return size_t 
+     * @return size_t
+     */
+    virtual size_t GetPoolSize() = 0;
+
+    /**
+     * @brief
+     * grow or shrink the buffer pool online. shrinking never invalidates pinned pages,
+     * frames being removed are released once they are unpinned
+     * @param pool_size new size of buffer pool
+     * @return false when the size is not supported, e.g. beyond the reserved capacity
      */
-    size_t GetPoolSize() {
-        return pool_size_;
-    }
+    virtual bool Resize(size_t pool_size) = 0;
 
     /**
-     * @brief 
+     * @brief
      * for debug purposes, it will check the refcnt of in-memory pages.
      * @return true when refcnt of all pages are zero
      */
-    bool CheckPinCount();
-
-private:
-    // number of pages in the buffer pool
-    size_t pool_size_;
-    // array of in-memory pages
-    Page *pages_;
-    // pointer to disk manager
-    DiskManager *disk_manager_;
-    // mapping from page id to frame id
-    std::unordered_map<page_id_t, frame_id_t> page_table_;
-    // replacer used to find victim pages
-    Replacer *replacer_;
-    // list of free pages
-    std::list<frame_id_t> free_list_;
-    // big latch, currently it will protect whole buffer pool manager
-    // i.e. no fine-grained locking
-    std::mutex latch_;
+    virtual bool CheckPinCount() = 0;
+
+    /**
+     * @brief
+     * snapshot of statistics, summed over the shards
+     */
+    virtual BufferPoolStatsSnapshot GetStats() = 0;
+
+    virtual void ResetStats() = 0;
+
+    /**
+     * @brief
+     * count fetches of every page id, see BufferPoolStatsSnapshot::heatmap_.
+     * it's for debugging hot pages, every fetch takes a latch while it's enabled.
+     * disabling it drops the heatmap
+     */
+    virtual void EnableHeatmap(bool enable) = 0;
+
+    /**
+     * @brief
+     * pages cached right now and their temperatures, it's what BufferPoolDumper dumps.
+     * temperature comes from the eviction order of replacer, it's relative within an
+     * instance: 0 is the next victim, MAX_TEMPERATURE is never evicted soon, e.g. pinned
+     * @param pages (page id, temperature) are appended to it
+     */
+    virtual void GetResidentPages(std::vector<std::pair<page_id_t, uint32_t>> *pages) = 0;
+
+    static constexpr uint32_t MAX_TEMPERATURE = 100;
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,420 @@
+/**
+ * @file buffer_pool_manager_instance.h
+ * @author sheep
+ * @brief simple buffer pool manager that very likely to become the bottleneck
+ * @version 0.1
+ * @date 2022-04-30
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BUFFER_POOL_MANAGER_INSTANCE_H
+#define BUFFER_POOL_MANAGER_INSTANCE_H
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
+#include "storage/page/page.h"
+#include "storage/disk/disk_manager.h"
+#include "common/config.h"
+
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * knobs of background page cleaner. it writes at most
+ * max_pages_per_round_ pages every interval_, that's the rate limit
+ */
+struct PageCleanerConfig {
+    // percentage of evictable frames we want to keep clean, counted from the next victim
+    size_t clean_target_percent_{25};
+    // max pages written in a round, 0 means no limit
+    size_t max_pages_per_round_{64};
+    // max pages written in a single request. dirty pages with consecutive ids are
+    // written together, including cached neighbors that are not going to be evicted yet
+    size_t max_batch_size_{16};
+    // time between two rounds. foreground threads wake the cleaner up early when
+    // they have to write back a dirty victim by themselves
+    std::chrono::milliseconds interval_{10};
+};
+
+struct PageCleanerStats {
+    // rounds performed by page cleaner
+    uint64_t rounds_{0};
+    // pages written by page cleaner, and number of requests they took
+    uint64_t pages_written_{0};
+    uint64_t batches_{0};
+    // victims evicted by foreground threads in FetchPage and NewPage, and how many of
+    // them were dirty, i.e. the foreground thread had to pay for the write. victims of
+    // prefetch and resize are not counted
+    uint64_t victims_{0};
+    uint64_t dirty_victims_{0};
+
+    inline PageCleanerStats &operator+=(const PageCleanerStats &other) {
+        rounds_ += other.rounds_;
+        pages_written_ += other.pages_written_;
+        batches_ += other.batches_;
+        victims_ += other.victims_;
+        dirty_victims_ += other.dirty_victims_;
+        return *this;
+    }
+};
+
+/**
+ * @brief
+ * a single buffer pool.
+ * hit path is latch-free: page is looked up in a lock-free page table, and pinned by
+ * incrementing the pin count of the frame. pin count shares a word with the busy flag,
+ * which is set when the frame is being loaded, evicted or deleted, so a single atomic
+ * add tells us whether we've pinned a stable frame.
+ * misses take the latch. disk I/O happens outside the latch: the frame is claimed as busy,
+ * threads asking for the same page wait on that frame, while others keep going.
+ * optionally, a background page cleaner writes dirty pages that are about to be evicted,
+ * so foreground threads find clean victims and don't have to wait for the write.
+ * prefetched pages are read by a background thread, it's started by the first Prefetch.
+ * frame descriptors are packed in an array of their own, page data lives in the frame arena.
+ * descriptors and arena are reserved for the max pool size, frames beyond the current size
+ * are retired: they are marked as busy forever, so stale lock-free lookups can't pin them
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+public:
+    /**
+     * @brief Construct a new Buffer Pool Manager Instance object
+     *
+     * @param pool_size size of buffer pool
+     * @param disk_manager disk manager
+     * @param replacer_type replacement policy
+     * @param arena_config backing memory of page data
+     */
+    BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                              ReplacerType replacer_type = ReplacerType::LRU,
+                              const FrameArenaConfig &arena_config = FrameArenaConfig());
+
+    /**
+     * @brief Destroy the Buffer Pool Manager Instance object
+     *
+     */
+    ~BufferPoolManagerInstance() override;
+
+    Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) override;
+
+    Page *FetchResidentPage(page_id_t page_id) override;
+
+    void RecordHit(page_id_t page_id) override;
+
+    bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+    bool FlushPage(page_id_t page_id) override;
+
+    Page *NewPage(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID,
+                  BufferAccessStrategy *strategy = nullptr) override;
+
+    /**
+     * @brief
+     * cache a page that is already allocated from disk manager, the page is zeroed and pinned.
+     * used by ParallelBufferPoolManager, which picks the instance by page id, so the page
+     * has to be allocated before we know which instance is caching it
+     * @param page_id id of the allocated page
+     * @param strategy ring the new page is placed in
+     * @return pointer pointing to new page, or nullptr if we don't have more space
+     */
+    Page *NewAllocatedPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+    bool DeletePage(page_id_t page_id) override;
+
+    void FlushAllPages() override;
+
+    /**
+     * @brief
+     * frames are claimed right away, the reads are performed by the prefetch thread.
+     * prefetching pages never take more than a quarter of the pool, so that foreground
+     * threads always find a frame
+     */
+    void Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+    void WaitForPrefetch() override;
+
+    BufferPoolStatsSnapshot GetStats() override {
+        return stats_.Snapshot();
+    }
+
+    void ResetStats() override {
+        stats_.Reset();
+    }
+
+    void EnableHeatmap(bool enable) override {
+        stats_.EnableHeatmap(enable);
+    }
+
+    void GetResidentPages(std::vector<std::pair<page_id_t, uint32_t>> *pages) override;
+
+    size_t GetPoolSize() override {
+        return pool_size_.load();
+    }
+
+    /**
+     * @brief
+     * frames are added to free list when growing. when shrinking, pages in the removed
+     * frames are moved into frames we keep, so the coldest pages are the ones evicted.
+     * pinned frames are retired by the last one unpinning them.
+     * resizing to the current size retries the frames that failed to retire
+     * @return false when pool_size is zero or larger than the max pool size
+     */
+    bool Resize(size_t pool_size) override;
+
+    inline size_t GetMaxPoolSize() const {
+        return max_pool_size_;
+    }
+
+    bool CheckPinCount() override;
+
+    /**
+     * @brief
+     * start the background page cleaner. it's stopped when buffer pool is destroyed
+     */
+    void StartPageCleaner(const PageCleanerConfig &config = PageCleanerConfig());
+
+    void StopPageCleaner();
+
+    /**
+     * @brief
+     * a single round of page cleaner: write dirty unpinned pages among the next victims
+     * until clean target is met. it's performed by the background thread, but it could be
+     * called directly as well, cleaner doesn't need to be running
+     * @param config knobs of this round
+     * @return number of pages written
+     */
+    size_t CleanDirtyPages(const PageCleanerConfig &config = PageCleanerConfig());
+
+    PageCleanerStats GetPageCleanerStats();
+
+private:
+    /**
+     * @brief
+     * pin the frame if it's still holding page_id, without latch.
+     * frame id comes from lock-free lookup, so it might be stale
+     * @return false when frame is busy or holding another page
+     */
+    bool TryPin(frame_id_t frame_id, page_id_t page_id);
+
+    /**
+     * @brief
+     * drop a pin taken by us, e.g. to flush the page. it's not an access.
+     * latch shouldn't be held
+     */
+    void ReleasePin(frame_id_t frame_id);
+
+    /**
+     * @brief
+     * called after a pin is dropped, state is the value before it. when it's the last pin,
+     * frame goes to replacer, or it's deleted if someone asked for it. latch shouldn't be held.
+     * access is false when the pin was not a real access, e.g. taken by page cleaner,
+     * then the frame keeps its position in replacer
+     */
+    void OnPinReleased(frame_id_t frame_id, int state, bool access = true);
+
+    /**
+     * @brief
+     * delete the page marked as delete pending if it's no longer pinned. latch should be held
+     */
+    bool TryDeletePending(frame_id_t frame_id);
+
+    /**
+     * @brief
+     * look up the frame caching page_id. if the frame is busy, or the page is being
+     * written back, wait for it and look again. latch should be held, it's released while waiting
+     * @return INVALID_FRAME_ID when the page is not cached
+     */
+    frame_id_t FindFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id);
+
+    /**
+     * @brief
+     * claim a frame for a new page, either from the ring of strategy, free list or by
+     * evicting a victim. claimed frame is marked as busy and pinned by us. latch should be held
+     * @return false when all frames are pinned
+     */
+    bool AcquireFrame(frame_id_t *frame_id, BufferAccessStrategy *strategy = nullptr);
+
+    /**
+     * @brief
+     * claim the frame we put into the ring of strategy earlier, if it's still holding
+     * the same page and no one is using it. latch should be held
+     */
+    bool AcquireRingFrame(frame_id_t *frame_id, BufferAccessStrategy *strategy);
+
+    /**
+     * @brief
+     * map page_id to the claimed frame, replacing the victim in it. latch should be held
+     * @return the victim that should be written back, INVALID_PAGE_ID if there is none
+     */
+    page_id_t AssignFrame(page_id_t page_id, frame_id_t frame_id);
+
+    /**
+     * @brief
+     * map page_id to the claimed frame. dirty victim is written back and the page is read in
+     * (or zeroed) without holding the latch. latch should be held
+     * @return the page, pinned
+     */
+    Page *LoadFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id, frame_id_t frame_id, bool read_page);
+
+    /**
+     * @brief
+     * undo LoadFrame when the I/O failed. victim_page_id is the victim we failed to write back,
+     * it's still in the frame so we keep it. latch should be held
+     */
+    void AbortLoad(page_id_t page_id, frame_id_t frame_id, page_id_t victim_page_id);
+
+    /**
+     * @brief
+     * drop the claimed page from buffer pool and deallocate it. latch should be held
+     */
+    void DeleteFrame(page_id_t page_id, frame_id_t frame_id);
+
+    /**
+     * @brief
+     * release a claimed frame that no longer holds a page. it goes to free list, or it's
+     * retired if it's beyond pool size. latch should be held
+     */
+    void FreeFrame(frame_id_t frame_id);
+
+    /**
+     * @brief
+     * claim an unused frame beyond pool size and retire it. latch should be held,
+     * it's released while we are moving or writing back the page
+     * @return false when the frame is in use
+     */
+    bool TryRetireFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+    /**
+     * @brief
+     * move the page out of the claimed frame, into a frame we keep if there is one,
+     * otherwise it's evicted. latch should be held
+     */
+    void RetireFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+    /**
+     * @brief
+     * copy the page in frame from to the frame to, which is claimed by AcquireFrame.
+     * victim of to is written back first. latch should be held
+     */
+    void MoveFrame(std::unique_lock<std::mutex> *lock, frame_id_t from, frame_id_t to);
+
+    /**
+     * @brief
+     * pin the frame for page cleaner if it's holding a dirty page and no one is using it.
+     * latch shouldn't be held
+     */
+    bool TryPinDirty(frame_id_t frame_id, page_id_t page_id);
+
+    /**
+     * @brief
+     * write the pinned pages with consecutive ids in a single request, then unpin them
+     */
+    void WriteBatch(const std::vector<std::pair<page_id_t, frame_id_t>> &batch);
+
+    // background page cleaner
+    void RunPageCleaner();
+
+    struct PrefetchJob {
+        // (page id, frame id) of pages to be read
+        std::vector<std::pair<page_id_t, frame_id_t>> loads_;
+        // dirty victim of each frame that should be written back first, or INVALID_PAGE_ID
+        std::vector<page_id_t> victims_;
+    };
+
+    // background prefetch thread
+    void RunPrefetcher();
+
+    /**
+     * @brief
+     * write back the victims and read the pages, then release the frames. latch shouldn't be held
+     */
+    void PerformPrefetch(PrefetchJob *job);
+
+    void StopPrefetcher();
+
+    // frame is beyond pool size and doesn't hold a page. latch should be held
+    inline bool IsRetired(frame_id_t frame_id) {
+        return (pages_[frame_id].pin_count_.load(std::memory_order_acquire) & Page::FRAME_BUSY) != 0
+            && pages_[frame_id].GetPageId() == INVALID_PAGE_ID;
+    }
+
+    // acquire latch_, time spent waiting for it is recorded
+    inline std::unique_lock<std::mutex> LockLatch() {
+        return LockAndRecordWait(&latch_, &stats_);
+    }
+
+    // number of frames in use, frames in [pool_size_, max_pool_size_) are retired.
+    // it's modified with latch_ held, and read without it when a pin is released
+    std::atomic<size_t> pool_size_;
+    // number of reserved frames, everything indexed by frame id is sized by it
+    size_t max_pool_size_;
+    // page data of the frames
+    FrameArena arena_;
+    // frame descriptors, pointing into the arena
+    Page *pages_;
+    // pointer to disk manager
+    DiskManager *disk_manager_;
+    // mapping from page id to frame id. lookups are lock-free, modifications need the latch
+    PageTable page_table_;
+    // replacer used to find victim pages
+    std::unique_ptr<Replacer> replacer_;
+    // list of free pages
+    std::list<frame_id_t> free_list_;
+    // evicted dirty pages that are being written back, page id -> frame id.
+    // they are no longer in page table, but they can't be read from disk yet
+    std::unordered_map<page_id_t, frame_id_t> writing_back_;
+    // threads waiting for a busy frame sleep here, one per frame
+    std::vector<std::condition_variable> io_cv_;
+    // big latch, serializing modifications of page table, free list and frame assignment.
+    // hits and unpins don't need it, disk I/O is performed without it
+    std::mutex latch_;
+    // serializes Resize, frames are only brought back from retirement under it
+    std::mutex resize_latch_;
+
+    // page cleaner
+    PageCleanerConfig cleaner_config_;
+    std::atomic<bool> enable_cleaner_{false};
+    std::thread *cleaner_thread_{nullptr};
+    // protects cleaner thread state, cleaner sleeps on cleaner_cv_ between rounds
+    std::mutex cleaner_latch_;
+    std::condition_variable cleaner_cv_;
+
+    // number of frames claimed by Prefetch that are not loaded yet, protected by latch_
+    size_t prefetching_{0};
+    // notified with latch_ held when prefetching_ drops to zero
+    std::condition_variable prefetch_done_cv_;
+    // prefetch thread. queue and thread state are protected by prefetch_latch_
+    std::deque<PrefetchJob> prefetch_queue_;
+    std::thread *prefetch_thread_{nullptr};
+    bool stop_prefetcher_{false};
+    std::mutex prefetch_latch_;
+    std::condition_variable prefetch_cv_;
+
+    // statistics of page cleaner. victims here are the foreground ones only, stats_
+    // also counts the frames evicted by prefetch and resize
+    std::atomic<uint64_t> cleaner_rounds_{0};
+    std::atomic<uint64_t> cleaner_pages_written_{0};
+    std::atomic<uint64_t> cleaner_batches_{0};
+    std::atomic<uint64_t> victims_{0};
+    std::atomic<uint64_t> dirty_victims_{0};
+
+    BufferPoolStats stats_;
+};
+
+}
+
+#endif
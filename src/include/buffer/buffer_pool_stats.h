@@ -0,0 +1,179 @@
+/**
+ * @file buffer_pool_stats.h
+ * @author sheep
+ * @brief statistics of buffer pool
+ * @version 0.1
+ * @date 2022-06-26
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef BUFFER_POOL_STATS_H
+#define BUFFER_POOL_STATS_H
+
+#include "common/config.h"
+#include "common/histogram.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * snapshot of buffer pool statistics. snapshots of shards could be summed up
+ */
+struct BufferPoolStatsSnapshot {
+    // FetchPage found the page in buffer pool, including the ones still being read in
+    uint64_t hits_{0};
+    // FetchPage had to read the page, including the failed ones
+    uint64_t misses_{0};
+    // FetchPage failed since every frame is pinned
+    uint64_t fetch_failures_{0};
+    uint64_t new_pages_{0};
+    // NewPage failed since every frame is pinned
+    uint64_t new_page_failures_{0};
+    // pages pushed out of buffer pool to make room for others
+    uint64_t evictions_{0};
+    // evicted pages that were written back by foreground threads
+    uint64_t dirty_write_backs_{0};
+    // time spent waiting on the buffer pool latch in nanoseconds, only contended
+    // acquisitions are recorded
+    HistogramSnapshot latch_wait_;
+    // page id -> number of fetches. it's empty unless heatmap is enabled
+    std::unordered_map<page_id_t, uint64_t> heatmap_;
+
+    inline uint64_t Fetches() const {
+        return hits_ + misses_;
+    }
+
+    inline double HitRatio() const {
+        return Fetches() == 0 ? 0 : static_cast<double>(hits_) / Fetches();
+    }
+
+    /**
+     * @brief
+     * the hottest pages in the heatmap, hottest first
+     */
+    std::vector<std::pair<page_id_t, uint64_t>> HotPages(size_t count) const;
+
+    BufferPoolStatsSnapshot &operator+=(const BufferPoolStatsSnapshot &other);
+
+    /**
+     * @brief
+     * multi-line report
+     */
+    std::string ToString() const;
+};
+
+/**
+ * @brief
+ * counter incremented by many threads at once. it's split into stripes on their own
+ * cache lines, each thread always adds to the same one. reading it sums them up,
+ * so it's only consistent when no one is adding
+ */
+class StripedCounter {
+public:
+    static constexpr size_t STRIPE_NUM = 16;
+
+    inline void Add(uint64_t value) {
+        stripes_[StripeIndex()].value_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t Load() const;
+
+    void Reset();
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Stripe {
+        std::atomic<uint64_t> value_{0};
+    };
+
+    // threads are assigned to stripes round robin when they first show up
+    static inline size_t StripeIndex() {
+        static std::atomic<size_t> next_stripe{0};
+        static thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % STRIPE_NUM;
+        return stripe;
+    }
+
+    Stripe stripes_[STRIPE_NUM];
+};
+
+/**
+ * @brief
+ * counters of a buffer pool shard. counters are lock-free, heatmap takes a latch
+ * and is only maintained when it's enabled
+ */
+class BufferPoolStats {
+public:
+    inline void RecordHit(page_id_t page_id) {
+        hits_.Add(1);
+        RecordAccess(page_id);
+    }
+
+    inline void RecordMiss(page_id_t page_id) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        RecordAccess(page_id);
+    }
+
+    inline void RecordLatchWait(uint64_t nanoseconds) {
+        latch_wait_.Record(nanoseconds);
+    }
+
+    void EnableHeatmap(bool enable);
+
+    BufferPoolStatsSnapshot Snapshot() const;
+
+    void Reset();
+
+    std::atomic<uint64_t> fetch_failures_{0};
+    std::atomic<uint64_t> new_pages_{0};
+    std::atomic<uint64_t> new_page_failures_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> dirty_write_backs_{0};
+
+private:
+    inline void RecordAccess(page_id_t page_id) {
+        if (heatmap_enabled_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> guard(heatmap_latch_);
+            heatmap_[page_id]++;
+        }
+    }
+
+    // hits are counted on the lock-free path by every thread, they don't share a cache line.
+    // misses are counted under the latch
+    StripedCounter hits_;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> misses_{0};
+    LatencyHistogram latch_wait_;
+
+    std::atomic<bool> heatmap_enabled_{false};
+    mutable std::mutex heatmap_latch_;
+    std::unordered_map<page_id_t, uint64_t> heatmap_;
+};
+
+/**
+ * @brief
+ * lock the mutex, and record how long we've waited if someone else is holding it.
+ * uncontended acquisitions don't read the clock
+ */
+inline std::unique_lock<std::mutex> LockAndRecordWait(std::mutex *mutex, BufferPoolStats *stats) {
+    std::unique_lock<std::mutex> lock(*mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        auto start = std::chrono::steady_clock::now();
+        lock.lock();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        stats->RecordLatchWait(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    return lock;
+}
+
+}
+
+#endif
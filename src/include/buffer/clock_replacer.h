@@ -0,0 +1,95 @@
+/**
+ * @file clock_replacer.h
+ * @author sheep
+ * @brief clock sweep replacer used in buffer pool manager
+ * @version 0.1
+ * @date 2022-06-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef CLOCK_REPLACER_H
+#define CLOCK_REPLACER_H
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * ClockReplacer approximates LRU with a reference bit per frame. frames are arranged in
+ * a circle, clock hand sweeps over them looking for a victim: frame with reference bit
+ * set is given a second chance, i.e. its bit is cleared and hand moves on.
+ *
+ * state of each frame is a single byte, every operation is a few atomic instructions,
+ * there is no mutex. accessing a frame only sets its bit, so hits don't write to
+ * any shared structure other than the frame itself.
+ */
+class ClockReplacer : public Replacer {
+public:
+    /**
+     * @brief Construct a new ClockReplacer object
+     * @param num_pages number of frames, frame id should be less than it
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer() override = default;
+
+    // inherited methods from Replacer
+
+    bool Evict(frame_id_t *victim) override;
+
+    void Pin(frame_id_t frame_id) override;
+
+    /**
+     * @brief
+     * frame is evictable and referenced. only first time unpin is valid,
+     * it doesn't set reference bit of a frame we already own
+     */
+    void Unpin(frame_id_t frame_id) override;
+
+    /**
+     * @brief
+     * frame is evictable, reference bit is left alone
+     */
+    void SetEvictable(frame_id_t frame_id) override;
+
+    size_t Size() override;
+
+    /**
+     * @brief
+     * frame is evictable and referenced
+     */
+    void Touch(frame_id_t frame_id) override;
+
+    /**
+     * @brief
+     * frames the hand will take if nothing is touched meanwhile: unreferenced ones in
+     * front of the hand, then the referenced ones
+     */
+    void PeekVictims(size_t count, std::vector<frame_id_t> *victims) override;
+
+private:
+    // frame is owned by replacer, i.e. it can be evicted
+    static constexpr uint8_t EVICTABLE = 1;
+    // frame is accessed since hand passed it last time
+    static constexpr uint8_t REFERENCED = 2;
+
+    size_t num_pages_;
+    std::unique_ptr<std::atomic<uint8_t>[]> state_;
+    // position of clock hand, modulo num_pages_
+    std::atomic<size_t> hand_{0};
+    // number of evictable frames
+    std::atomic<size_t> size_{0};
+};
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file frame_arena.h
+ * @author sheep
+ * @brief contiguous memory holding the data of buffer pool frames
+ * @version 0.1
+ * @date 2022-06-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include "common/config.h"
+#include "common/macros.h"
+
+#include <cstddef>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * how the memory of frame arena is backed
+ */
+struct FrameArenaConfig {
+    // back the arena with 2MiB pages, one TLB entry covers 512 frames instead of one.
+    // explicit huge pages are tried first, then transparent huge pages.
+    // arena smaller than a huge page always uses regular pages.
+    // explicit huge pages are taken from the pool as soon as they are mapped, so they are
+    // not used for arenas reserving frames to grow into (see max_pool_size_), which get
+    // transparent huge pages committed on first touch instead
+    bool huge_pages_{true};
+    // spread the arena across every NUMA node in round-robin, so that threads on any
+    // socket get the same bandwidth. ignored on machines without NUMA support
+    bool numa_interleave_{false};
+    // upper bound of BufferPoolManagerInstance::Resize. address space and frame descriptors
+    // are reserved for that many frames upfront, page memory is committed when frames are
+    // first used. 0 means the initial size, i.e. the pool could shrink and grow back only
+    size_t max_pool_size_{0};
+};
+
+/**
+ * @brief
+ * FrameArena is a page-aligned chunk of anonymous memory mapped for the page data of a
+ * buffer pool instance. frame descriptors are kept elsewhere, so walking over frame
+ * metadata doesn't drag page data into cache and TLB.
+ * every option is best-effort, we fall back to plain pages when the system refuses,
+ * IsHugePage and IsInterleaved tell what we actually got
+ */
+class FrameArena {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+    /**
+     * @brief Construct a new Frame Arena object
+     * @param frame_num number of PAGE_SIZE frames in use initially. address space is
+     * reserved for config.max_pool_size_ frames if it's larger
+     * @param config backing of the memory
+     */
+    explicit FrameArena(size_t frame_num, const FrameArenaConfig &config = FrameArenaConfig());
+
+    ~FrameArena();
+
+    DISALLOW_COPY(FrameArena);
+
+    /**
+     * @brief
+     * get data of a frame, it's aligned with PAGE_ALIGNMENT
+     */
+    inline char *GetFrame(size_t frame_id) {
+        return data_ + frame_id * PAGE_SIZE;
+    }
+
+    /**
+     * @brief
+     * give the memory of frames back to the system, the next access sees zeroed frames.
+     * only whole pages of the backing memory are released. for explicit huge page arenas
+     * it's whole huge pages, releasing fewer frames than a huge page holds does nothing,
+     * the frames keep their memory and content
+     * @param first_frame first frame to release
+     * @param frame_num number of frames
+     */
+    void Release(size_t first_frame, size_t frame_num);
+
+    inline size_t GetSize() const {
+        return size_;
+    }
+
+    /**
+     * @brief
+     * whether the arena is backed by explicit huge pages (MAP_HUGETLB)
+     */
+    inline bool IsHugePage() const {
+        return huge_page_;
+    }
+
+    /**
+     * @brief
+     * whether the arena is interleaved across NUMA nodes
+     */
+    inline bool IsInterleaved() const {
+        return interleaved_;
+    }
+
+private:
+    // mapped memory
+    char *data_{nullptr};
+    // size of mapped memory, it might be larger than requested
+    size_t size_{0};
+    bool huge_page_{false};
+    bool interleaved_{false};
+};
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * @file lru_k_replacer.h
+ * @author sheep
+ * @brief lru-k replacer used in buffer pool manager
+ * @version 0.1
+ * @date 2022-06-21
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef LRU_K_REPLACER_H
+#define LRU_K_REPLACER_H
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * LRUKReplacer evicts the frame whose K-th most recent reference is the oldest, i.e. the
+ * one with the largest backward K-distance. frames referenced less than K times have
+ * infinite distance and go first, the least recently used of them is picked.
+ * compared to LRU, a page touched once by a scan or a burst of inserts won't push out
+ * the pages that are referenced again and again, e.g. index root and internal pages.
+ *
+ * references within correlated period of the last one are considered correlated,
+ * e.g. inserting several tuples into the same page back to back. they are collapsed
+ * into a single reference, so that a page doesn't look hot just because one operation
+ * has touched it multiple times. frames referenced within correlated period are not
+ * eligible for eviction, unless all the frames are.
+ *
+ * time is logical, it advances on every reference. so correlated period is measured
+ * in the number of references the replacer has seen.
+ * history is kept per frame. when the frame is evicted, the history is retained under the
+ * page id it was holding (if we were told about it by Load), and given back when the page
+ * is loaded again. otherwise a page coming back would always have infinite distance, and be
+ * evicted again before its second reference. we retain as many pages as there are frames,
+ * the ones evicted earliest are forgotten first.
+ */
+class LRUKReplacer : public Replacer {
+public:
+    static constexpr size_t DEFAULT_K = 2;
+    // consecutive references to the same frame are correlated
+    static constexpr uint64_t DEFAULT_CORRELATED_PERIOD = 2;
+
+    /**
+     * @brief Construct a new LRUKReplacer object
+     * @param num_pages number of frames
+     * @param k number of references we remember for each frame
+     * @param correlated_period references within it are considered correlated, 0 means
+     * every reference counts
+     */
+    explicit LRUKReplacer(size_t num_pages, size_t k = DEFAULT_K,
+                          uint64_t correlated_period = DEFAULT_CORRELATED_PERIOD);
+
+    ~LRUKReplacer() override = default;
+
+    // inherited methods from Replacer
+
+    bool Evict(frame_id_t *victim) override;
+
+    void Pin(frame_id_t frame_id) override;
+
+    /**
+     * @brief
+     * record a reference and make the frame evictable, only first time unpin is valid
+     */
+    void Unpin(frame_id_t frame_id) override;
+
+    /**
+     * @brief
+     * make the frame evictable without recording a reference
+     */
+    void SetEvictable(frame_id_t frame_id) override;
+
+    size_t Size() override;
+
+    /**
+     * @brief
+     * record a reference and make the frame evictable
+     */
+    void Touch(frame_id_t frame_id) override;
+
+    /**
+     * @brief
+     * restore the history of page if we still remember it
+     */
+    void Load(frame_id_t frame_id, page_id_t page_id) override;
+
+    void PeekVictims(size_t count, std::vector<frame_id_t> *victims) override;
+
+private:
+    struct FrameHistory {
+        // time of the last K uncorrelated references, most recent first. 0 means none
+        std::vector<uint64_t> history_;
+        // time of the last reference, correlated or not
+        uint64_t last_{0};
+        bool evictable_{false};
+        // page held by this frame, if we know it
+        page_id_t page_id_{INVALID_PAGE_ID};
+    };
+
+    struct RetainedHistory {
+        page_id_t page_id_;
+        std::vector<uint64_t> history_;
+        uint64_t last_;
+    };
+
+    // (K-th reference, last reference, frame id). smaller one is evicted first
+    using key_t = std::tuple<uint64_t, uint64_t, frame_id_t>;
+
+    // mutex should be held
+    FrameHistory &GetFrame(frame_id_t frame_id);
+
+    // mutex should be held
+    void RecordAccess(frame_id_t frame_id);
+
+    // mutex should be held
+    void Retain(FrameHistory *frame);
+
+    inline key_t KeyOf(frame_id_t frame_id) {
+        auto &frame = frames_[frame_id];
+        return key_t(frame.history_.back(), frame.last_, frame_id);
+    }
+
+    size_t k_;
+    uint64_t correlated_period_;
+    // logical clock
+    uint64_t current_time_{0};
+    std::vector<FrameHistory> frames_;
+    // evictable frames ordered by eviction priority
+    std::set<key_t> evictable_;
+    // history of evicted pages, most recently evicted first
+    std::list<RetainedHistory> retained_;
+    std::unordered_map<page_id_t, std::list<RetainedHistory>::iterator> retained_map_;
+    size_t retained_capacity_;
+    std::mutex mu_;
+};
+
+}
+
+#endif
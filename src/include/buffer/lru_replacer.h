@@ -18,6 +18,7 @@
 #include <list>
 #include <unordered_map>
 #include <mutex>
+#include <vector>
 
 namespace TinyDB {
 
@@ -49,6 +50,8 @@ public:
 
     size_t Size() override;
 
+    void PeekVictims(size_t count, std::vector<frame_id_t> *victims) override;
+
 private:
     using list_t = std::list<frame_id_t>;
     list_t list_;
@@ -0,0 +1,134 @@
+/**
+ * @file page_table.h
+ * @author sheep
+ * @brief fixed-capacity open addressing hash table mapping page id to frame id
+ * @version 0.1
+ * @date 2022-06-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef PAGE_TABLE_H
+#define PAGE_TABLE_H
+
+#include "common/config.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * PageTable maps page id to frame id with linear probing. each slot is a single
+ * 64 bits atomic word packing (page id, frame id), so slots are read and written
+ * as a whole and probing walks contiguous memory.
+ *
+ * Find is lock-free. Insert and Erase should be serialized by the caller, i.e. buffer
+ * pool latch. Erase shifts the following entries backward instead of leaving tombstones,
+ * so a lock-free Find racing with it may miss a key that is in the table, but it never
+ * returns a mapping that has never been there. callers of lock-free Find must validate
+ * the frame, and look again with the latch held when it misses.
+ *
+ * the number of entries can't exceed the capacity, table is at most half full.
+ */
+class PageTable {
+public:
+    /**
+     * @brief Construct a new Page Table object
+     * @param capacity maximum number of entries, i.e. buffer pool size
+     */
+    explicit PageTable(size_t capacity);
+
+    /**
+     * @brief
+     * look up the frame holding page_id without locking
+     * @return INVALID_FRAME_ID when page is not found
+     */
+    inline frame_id_t Find(page_id_t page_id) const {
+        size_t pos = Home(page_id);
+        for (size_t i = 0; i <= mask_; i++) {
+            uint64_t slot = slots_[pos].load(std::memory_order_acquire);
+            if (slot == EMPTY_SLOT) {
+                return INVALID_FRAME_ID;
+            }
+            if (PageOf(slot) == page_id) {
+                return FrameOf(slot);
+            }
+            pos = (pos + 1) & mask_;
+        }
+        return INVALID_FRAME_ID;
+    }
+
+    /**
+     * @brief
+     * insert or update the mapping. caller should hold the latch
+     */
+    void Insert(page_id_t page_id, frame_id_t frame_id);
+
+    /**
+     * @brief
+     * remove the mapping. caller should hold the latch
+     * @return false when page is not found
+     */
+    bool Erase(page_id_t page_id);
+
+    /**
+     * @brief
+     * number of entries. caller should hold the latch
+     */
+    inline size_t Size() const {
+        return size_;
+    }
+
+    /**
+     * @brief
+     * call func(page_id, frame_id) for every entry. caller should hold the latch
+     */
+    template <typename Func>
+    void ForEach(Func &&func) const {
+        for (size_t i = 0; i <= mask_; i++) {
+            uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+            if (slot != EMPTY_SLOT) {
+                func(PageOf(slot), FrameOf(slot));
+            }
+        }
+    }
+
+private:
+    static constexpr uint64_t EMPTY_SLOT = ~0ULL;
+
+    static inline uint64_t Pack(page_id_t page_id, frame_id_t frame_id) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+    }
+
+    static inline page_id_t PageOf(uint64_t slot) {
+        return static_cast<page_id_t>(slot >> 32);
+    }
+
+    static inline frame_id_t FrameOf(uint64_t slot) {
+        return static_cast<frame_id_t>(slot & 0xffffffffULL);
+    }
+
+    // fibonacci hashing, consecutive page ids are scattered across the table
+    inline size_t Home(page_id_t page_id) const {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> shift_;
+    }
+
+    // position of page_id, or -1 when it's not in table
+    int64_t Locate(page_id_t page_id) const;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+    // number of slots - 1, number of slots is a power of 2
+    size_t mask_;
+    // 64 - log2(number of slots)
+    uint32_t shift_;
+    size_t size_{0};
+};
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * @file parallel_buffer_pool_manager.h
+ * @author sheep
+ * @brief buffer pool manager sharding pages across multiple instances
+ * @version 0.1
+ * @date 2022-06-16
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef PARALLEL_BUFFER_POOL_MANAGER_H
+#define PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/disk_manager.h"
+
+#include <memory>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * ParallelBufferPoolManager splits the buffer pool into several independent
+ * BufferPoolManagerInstance, each of them has its own page table, free list, replacer
+ * and latch. page is always cached by instance page_id % num_instances, so threads
+ * touching different pages rarely contend on the same latch.
+ *
+ * replacement decisions are made within an instance, i.e. a hot instance may evict
+ * its pages while another one still has free frames. with enough instances and
+ * sequentially allocated page ids, pages are spread evenly so it doesn't matter much.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+public:
+    /**
+     * @brief Construct a new Parallel Buffer Pool Manager object
+     *
+     * @param num_instances number of instances
+     * @param pool_size size of buffer pool of each instance
+     * @param disk_manager disk manager shared by all instances
+     * @param replacer_type replacement policy of each instance
+     * @param arena_config backing memory of each instance, max pool size is per instance as well
+     */
+    ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                              ReplacerType replacer_type = ReplacerType::LRU,
+                              const FrameArenaConfig &arena_config = FrameArenaConfig());
+
+    ~ParallelBufferPoolManager() override = default;
+
+    Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) override;
+
+    Page *FetchResidentPage(page_id_t page_id) override;
+
+    void RecordHit(page_id_t page_id) override;
+
+    bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+    bool FlushPage(page_id_t page_id) override;
+
+    /**
+     * @brief
+     * page id is allocated first, then the page is cached by the instance it hashed to.
+     * if that instance is full, we keep allocating until we hit an instance with space,
+     * and return the ids we've skipped to disk manager
+     */
+    Page *NewPage(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID,
+                  BufferAccessStrategy *strategy = nullptr) override;
+
+    bool DeletePage(page_id_t page_id) override;
+
+    void FlushAllPages() override;
+
+    /**
+     * @brief
+     * pages are grouped by instance, each instance prefetches its own
+     */
+    void Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+    void WaitForPrefetch() override;
+
+    /**
+     * @brief
+     * total size of all instances
+     */
+    size_t GetPoolSize() override;
+
+    /**
+     * @brief
+     * pool_size is the total size, it's split evenly across the instances.
+     * nothing is resized unless every instance could take its share
+     */
+    bool Resize(size_t pool_size) override;
+
+    bool CheckPinCount() override;
+
+    /**
+     * @brief
+     * sum of all instances, use GetInstance(page_id)->GetStats() to look at a single shard
+     */
+    BufferPoolStatsSnapshot GetStats() override;
+
+    void ResetStats() override;
+
+    void EnableHeatmap(bool enable) override;
+
+    void GetResidentPages(std::vector<std::pair<page_id_t, uint32_t>> *pages) override;
+
+    /**
+     * @brief
+     * start a page cleaner for each instance
+     */
+    void StartPageCleaner(const PageCleanerConfig &config = PageCleanerConfig());
+
+    void StopPageCleaner();
+
+    /**
+     * @brief
+     * a round of page cleaner on every instance
+     * @return number of pages written
+     */
+    size_t CleanDirtyPages(const PageCleanerConfig &config = PageCleanerConfig());
+
+    /**
+     * @brief
+     * sum of all instances
+     */
+    PageCleanerStats GetPageCleanerStats();
+
+    /**
+     * @brief
+     * instance responsible for page_id
+     */
+    inline BufferPoolManagerInstance *GetInstance(page_id_t page_id) {
+        return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+    }
+
+private:
+    DiskManager *disk_manager_;
+    std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+};
+
+}
+
+#endif
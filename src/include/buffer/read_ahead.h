@@ -0,0 +1,78 @@
+/**
+ * @file read_ahead.h
+ * @author sheep
+ * @brief adaptive read-ahead for scans following page links
+ * @version 0.1
+ * @date 2022-06-24
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef READ_AHEAD_H
+#define READ_AHEAD_H
+
+#include "buffer/buffer_access_strategy.h"
+#include "common/config.h"
+
+#include <cstddef>
+
+namespace TinyDB {
+
+class BufferPoolManager;
+
+/**
+ * @brief
+ * ReadAheadWindow keeps the pages a scan is going to read next in flight. scans over table
+ * heap and b+tree leaves follow next page links, so the only page we know for sure is the
+ * next one, it's prefetched as soon as we land on a page, while we are busy with the
+ * current one. but pages are usually allocated right after their predecessor, so when the
+ * scan turns out to be sequential, i.e. page ids keep going up by one, we also prefetch the
+ * pages following the next one. the window doubles every sequential step, up to max_window,
+ * and falls back to a single page as soon as the scan jumps.
+ * prefetch requests are batched, we only ask for more when half of the window is consumed.
+ *
+ * it's a plain value, copied along with the iterator owning it
+ */
+class ReadAheadWindow {
+public:
+    // 128KB with 4KB pages
+    static constexpr size_t DEFAULT_MAX_WINDOW = 32;
+
+    /**
+     * @brief Construct a new ReadAheadWindow object
+     * @param max_window max number of pages in flight, 0 disables read-ahead
+     */
+    explicit ReadAheadWindow(size_t max_window = DEFAULT_MAX_WINDOW)
+        : max_window_(max_window) {}
+
+    /**
+     * @brief
+     * the scan is on page_id now, prefetch what's coming. it does nothing if we are
+     * still on the same page
+     * @param bpm buffer pool
+     * @param page_id current page
+     * @param next_page_id next page of the current one
+     * @param strategy ring the scan is using. window never exceeds half of the ring,
+     * otherwise prefetched pages would be recycled before we get to them
+     */
+    void OnPage(BufferPoolManager *bpm, page_id_t page_id, page_id_t next_page_id,
+                BufferAccessStrategy *strategy = nullptr);
+
+    inline size_t GetWindow() const {
+        return window_;
+    }
+
+private:
+    size_t max_window_;
+    // current window size
+    size_t window_{0};
+    // last page we've seen
+    page_id_t last_page_id_{INVALID_PAGE_ID};
+    // pages before it are prefetched in the current sequential run
+    page_id_t issued_end_{INVALID_PAGE_ID};
+};
+
+}
+
+#endif
@@ -15,8 +15,20 @@
 
 #include "common/config.h"
 
+#include <memory>
+#include <vector>
+
 namespace TinyDB {
 
+enum class ReplacerType {
+    // exact lru, every unpin reorders a list under mutex
+    LRU,
+    // clock sweep, unpin only sets a reference bit
+    CLOCK,
+    // lru-2 with correlated reference period, resists scans and bursts of one-off pages
+    LRU_K,
+};
+
 /**
  * @brief 
  * whenever the page is not pinned, which means that page
@@ -54,11 +66,63 @@ public:
     virtual void Unpin(frame_id_t frame_id) = 0;
 
     /**
-     * @brief 
+     * @brief
+     * frame is evictable again, but no one has accessed it. e.g. page cleaner released it
+     * after writing it back, or a prefetched page was read in. replacers keeping track of
+     * references (e.g. lru-k, clock) shouldn't count it as one.
+     * by default, it's the same as Unpin
+     * @param frame_id id of frame
+     */
+    virtual void SetEvictable(frame_id_t frame_id) {
+        Unpin(frame_id);
+    }
+
+    /**
+     * @brief
      * return the number of elements in the replacer that can be victim
      * @return size_t 
      */
     virtual size_t Size() = 0;
+
+    /**
+     * @brief
+     * the last pin of a frame is released, i.e. frame was just used and it's evictable again.
+     * hits don't go through replacer, so frame might still be owned by replacer.
+     * by default, it's moved to the most recently used position
+     * @param frame_id id of frame being accessed
+     */
+    virtual void Touch(frame_id_t frame_id) {
+        Pin(frame_id);
+        Unpin(frame_id);
+    }
+
+    /**
+     * @brief
+     * frame is going to hold page_id. it's called before the first Touch of the page.
+     * replacers remembering pages after they are evicted (e.g. lru-k) need it,
+     * others don't care
+     * @param frame_id id of frame
+     * @param page_id id of page
+     */
+    virtual void Load(frame_id_t frame_id, page_id_t page_id) {}
+
+    /**
+     * @brief
+     * frames that are going to be evicted next, in eviction order, without evicting them.
+     * it's only a hint for page cleaner, it might be stale as soon as we return.
+     * by default replacer doesn't tell
+     * @param count max number of frames
+     * @param victims frames are appended to it
+     */
+    virtual void PeekVictims(size_t count, std::vector<frame_id_t> *victims) {}
+
+    /**
+     * @brief
+     * create a replacer
+     * @param type replacement policy
+     * @param num_pages number of frames of buffer pool
+     */
+    static std::unique_ptr<Replacer> Create(ReplacerType type, size_t num_pages);
 };
 
 }
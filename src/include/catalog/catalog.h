@@ -142,7 +142,10 @@ public:
         // TODO: should we use another abstraction layer to do the population?
         // i.e. hide the population detail which is decided by storage engine
         auto table = GetTableHelper(table_names_[table_name]);
-        for (auto it = table->table_->Begin(); it != table->table_->End(); ++it) {
+        // scan through a ring, so that building an index on a big table won't flush the buffer pool.
+        // index pages are created in the shared pool as usual
+        BufferAccessStrategy strategy(BufferAccessType::BULK_READ, bpm_->GetPoolSize());
+        for (auto it = table->table_->Begin(&strategy); it != table->table_->End(); ++it) {
             index->InsertEntryTupleSchema(*it, it->GetRID());
         }
 
@@ -18,17 +18,40 @@
 
 namespace TinyDB {
 
-// size of a page, which is the basic unit of our database
-static constexpr uint32_t PAGE_SIZE = 4096;
+// size of a page, which is the basic unit of our database.
+// it's configured at compile time, see TINYDB_PAGE_SIZE in CMakeLists.txt
+#ifndef TINYDB_PAGE_SIZE
+#define TINYDB_PAGE_SIZE 4096
+#endif
+static constexpr uint32_t PAGE_SIZE = TINYDB_PAGE_SIZE;
+static_assert(PAGE_SIZE >= 4096 && PAGE_SIZE <= 65536 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+              "page size should be power of 2 within [4KiB, 64KiB]");
+
+// alignment of in-memory page frames. direct I/O requires the buffer
+// to be aligned with logical block size of the device
+static constexpr uint32_t PAGE_ALIGNMENT = 4096;
+
+// size of cpu cache line. data shared by threads is padded to it to avoid false sharing
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+// number of pages that db file grows at a time
+static constexpr uint32_t EXTENT_SIZE = 64;
 
 // size of buffer pool, should be configured based on your memory
 static constexpr uint32_t BUFFER_POOL_SIZE = 10;
 
+// maximum number of in-flight asynchronous page I/O requests
+static constexpr uint32_t IO_QUEUE_DEPTH = 64;
+
+// optimistic page reads that fail validation this many times fall back to the read latch
+static constexpr int OPTIMISTIC_READ_RETRY = 3;
+
 // size of log buffer
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);
 
 // special values
 static constexpr int INVALID_PAGE_ID = -1;
+static constexpr int INVALID_FRAME_ID = -1;
 static constexpr int INVALID_TXN_ID = -1;
 static constexpr int INVALID_LSN = -1;
 
@@ -0,0 +1,116 @@
+/**
+ * @file histogram.h
+ * @author sheep
+ * @brief lock-free log-bucketed histogram for latency
+ * @version 0.1
+ * @date 2022-06-13
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * immutable copy of a histogram, used for reporting
+ */
+struct HistogramSnapshot {
+    uint64_t count_{0};
+    uint64_t sum_{0};
+    uint64_t max_{0};
+    std::vector<uint64_t> buckets_;
+
+    inline double Mean() const {
+        return count_ == 0 ? 0 : static_cast<double>(sum_) / count_;
+    }
+
+    /**
+     * @brief
+     * estimate the percentile. result is the upper bound of the bucket it falls in,
+     * so it's at most 25% larger than the real value
+     * @param p within [0, 1], e.g. 0.99
+     */
+    uint64_t Percentile(double p) const;
+
+    /**
+     * @brief
+     * merge another histogram into this one
+     */
+    HistogramSnapshot &operator+=(const HistogramSnapshot &other);
+};
+
+/**
+ * @brief
+ * LatencyHistogram records values (e.g. nanoseconds) into logarithmic buckets.
+ * every power of 2 is split into 4 sub-buckets, so 256 buckets cover the whole uint64_t.
+ * Record is lock-free and could be called concurrently, it's a few relaxed atomic adds.
+ */
+class LatencyHistogram {
+public:
+    // number of bits used to split a power of 2
+    static constexpr uint32_t SUB_BUCKET_BITS = 2;
+    static constexpr uint32_t SUB_BUCKET_NUM = 1 << SUB_BUCKET_BITS;
+    static constexpr uint32_t BUCKET_NUM = 64 * SUB_BUCKET_NUM;
+
+    LatencyHistogram() = default;
+
+    inline void Record(uint64_t value) {
+        buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     * @brief
+     * take a snapshot. it's not atomic with respect to concurrent Record,
+     * which is fine for statistics
+     */
+    HistogramSnapshot Snapshot() const;
+
+    void Reset();
+
+    /**
+     * @brief
+     * bucket of the value. values smaller than SUB_BUCKET_NUM have their own bucket,
+     * otherwise bucket is decided by the most significant bit and SUB_BUCKET_BITS bits after it
+     */
+    static inline uint32_t BucketIndex(uint64_t value) {
+        if (value < SUB_BUCKET_NUM) {
+            return static_cast<uint32_t>(value);
+        }
+        uint32_t msb = 63 - __builtin_clzll(value);
+        uint32_t sub = (value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKET_NUM - 1);
+        return ((msb - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + sub;
+    }
+
+    /**
+     * @brief
+     * largest value that falls in the bucket
+     */
+    static uint64_t BucketUpperBound(uint32_t idx);
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKET_NUM]{};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * @brief
+ * format nanoseconds in a human readable way, e.g. 12.3us
+ */
+std::string FormatDuration(uint64_t nanoseconds);
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file lz_codec.h
+ * @author sheep
+ * @brief a small LZ77 family codec used for page compression
+ * @version 0.1
+ * @date 2022-06-14
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * LZCodec is a byte oriented LZ77 codec, the format is similar to LZ4 block format.
+ * it favors speed over ratio, since it's sitting on the I/O path.
+ *
+ * compressed data is a sequence of:
+ * -------------------------------------------------------------------------------------
+ * | token | literal length ext | literals | offset (2 bytes) | match length ext |
+ * -------------------------------------------------------------------------------------
+ * high 4 bits of token is the literal length, low 4 bits is match length - MIN_MATCH.
+ * 15 means the length continues in the following bytes, each of them is added to it
+ * until we meet a byte that is not 255.
+ * the last sequence only contains literals, decoder knows it since input ends there.
+ */
+class LZCodec {
+public:
+    // shortest match we will encode
+    static constexpr uint32_t MIN_MATCH = 4;
+    // offset is stored in 2 bytes
+    static constexpr uint32_t MAX_OFFSET = 65535;
+
+    /**
+     * @brief
+     * worst case size of compressed data, i.e. when input is not compressible at all
+     */
+    static constexpr size_t MaxCompressedSize(size_t size) {
+        return size + size / 255 + 16;
+    }
+
+    /**
+     * @brief
+     * compress the data
+     * @param src data to compress
+     * @param size size of data
+     * @param dst buffer storing the compressed data
+     * @param capacity size of dst
+     * @return size_t size of compressed data, 0 when it doesn't fit in dst
+     */
+    static size_t Compress(const char *src, size_t size, char *dst, size_t capacity);
+
+    /**
+     * @brief
+     * decompress the data
+     * @param src compressed data
+     * @param size size of compressed data
+     * @param dst buffer storing the original data
+     * @param capacity size of dst
+     * @return int64_t size of original data, -1 when compressed data is corrupted
+     * or original data doesn't fit in dst
+     */
+    static int64_t Decompress(const char *src, size_t size, char *dst, size_t capacity);
+};
+
+}
+
+#endif
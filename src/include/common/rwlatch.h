@@ -1,28 +1,42 @@
 /**
  * @file rwlatch.h
  * @author sheep (ysj1173886760@gmail.com)
- * @brief rwlatch from bustub, thanks to andy pavlo
+ * @brief reader writer latch built on a single atomic word
  * @version 0.1
  * @date 2022-04-29
- * 
+ *
  * @copyright Copyright (c) 2022
- * 
+ *
  */
 
 #ifndef RWLATCH_H
 #define RWLATCH_H
 
-#include <mutex>
-#include <condition_variable>
-#include <climits>
+#include <atomic>
+#include <cstdint>
 
+#include "common/config.h"
 #include "common/macros.h"
 
 namespace TinyDB {
 
-class ReaderWriterLatch {
-    // constants
-    const uint32_t MAX_READERS = UINT_MAX;
+/**
+ * @brief
+ * reader writer latch. the whole state lives in one 32 bit word, so uncontended
+ * lock and unlock are a single atomic instruction each. contended threads spin
+ * for a while, then sleep on the word with futex.
+ * writers are preferred, once a writer is waiting, new readers wait behind it.
+ * latch is padded to a cache line, so neighbors won't suffer from its traffic
+ */
+class alignas(CACHE_LINE_SIZE) ReaderWriterLatch {
+    // layout of the state word. up to 2^20 - 1 readers holding it, and
+    // 2^10 - 1 writers waiting for it
+    static constexpr uint32_t READER_MASK = (1u << 20) - 1;
+    static constexpr uint32_t WAITING_WRITER = 1u << 20;
+    static constexpr uint32_t WAITING_WRITER_MASK = ((1u << 10) - 1) << 20;
+    static constexpr uint32_t WRITER = 1u << 30;
+    // someone is sleeping on the word, unlocker has to wake them up
+    static constexpr uint32_t PARKED = 1u << 31;
 public:
     ReaderWriterLatch() = default;
     ~ReaderWriterLatch() = default;
@@ -30,105 +44,100 @@ public:
     DISALLOW_COPY(ReaderWriterLatch);
 
     /**
-     * @brief 
+     * @brief
      * acquire writer latch
      */
     void WLock() {
-        std::unique_lock<std::mutex> latch(mutex_);
-        if (writer_entered_) {
-            // wait as a reader. i.e. race with other readers
-            reader_.wait(latch, [&]() { return !writer_entered_; });
-        }
-
-        writer_entered_ = true;
-        if (reader_count_ > 0) {
-            // wait as writer
-            writer_.wait(latch, [&]() { return reader_count_ == 0; });
+        uint32_t expected = 0;
+        if (!state_.compare_exchange_strong(expected, WRITER, std::memory_order_acquire)) {
+            WLockSlow();
         }
     }
 
     /**
-     * @brief 
+     * @brief
      * release writer latch
      */
     void WUnlock() {
-        std::unique_lock<std::mutex> latch(mutex_);
-        writer_entered_ = false;
-
-        // noticy other readers
-        reader_.notify_all();
+        uint32_t state = state_.fetch_and(~(WRITER | PARKED), std::memory_order_release);
+        if (state & PARKED) {
+            Wake();
+        }
     }
 
     /**
-     * @brief 
+     * @brief
      * Try to acquire the WLatch
      * @return true when we successfully acquired the lock, we will return while lock is holding
      */
     bool TryWLock() {
-        std::unique_lock<std::mutex> latch(mutex_);
-        if (writer_entered_ || reader_count_ > 0) {
-            return false;
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        while ((state & (WRITER | READER_MASK)) == 0) {
+            if (state_.compare_exchange_weak(state, state | WRITER, std::memory_order_acquire)) {
+                return true;
+            }
         }
-
-        writer_entered_ = true;
+        return false;
     }
 
     /**
-     * @brief 
+     * @brief
      * acquire reader latch
      */
     void RLock() {
-        std::unique_lock<std::mutex> latch(mutex_);
-        if (writer_entered_ || reader_count_ == MAX_READERS) {
-            reader_.wait(latch, [&]() {
-                return writer_entered_ == false && reader_count_ < MAX_READERS; });
+        if (!TryRLock()) {
+            RLockSlow();
         }
-
-        reader_count_ += 1;
     }
 
     /**
-     * @brief 
+     * @brief
      * release reader latch
      */
     void RUnlock() {
-        std::unique_lock<std::mutex> latch(mutex_);
-        reader_count_ -= 1;
-
-        if (writer_entered_) {
-            // if we are the last reader, then wake up writer
-            if (reader_count_ == 0) {
-                writer_.notify_one();
-            }
-        } else {
-            // allow one more reader
-            if (reader_count_ == MAX_READERS - 1) {
-                reader_.notify_one();
-            }
+        uint32_t state = state_.fetch_sub(1, std::memory_order_release);
+        // the last reader lets writer in, and a full latch lets one more reader in
+        uint32_t readers = state & READER_MASK;
+        if ((state & PARKED) && (readers == 1 || readers == READER_MASK)) {
+            state_.fetch_and(~PARKED, std::memory_order_relaxed);
+            Wake();
         }
     }
 
     /**
-     * @brief 
+     * @brief
      * try to acquire the RLock
      * @return true when we successfully acquired the lock
      */
     bool TryRLock() {
-        std::unique_lock<std::mutex> latch(mutex_);
-        if (writer_entered_ || reader_count_ == MAX_READERS) {
-            return false;
+        uint32_t state = state_.load(std::memory_order_relaxed);
+        while (CanRead(state)) {
+            if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+                return true;
+            }
         }
-
-        reader_count_ += 1;
-        return true;
+        return false;
     }
 
 private:
-    std::mutex mutex_;
-    std::condition_variable writer_;
-    std::condition_variable reader_;
-    uint32_t reader_count_{0};
-    bool writer_entered_{false};
+    static inline bool CanRead(uint32_t state) {
+        return (state & (WRITER | WAITING_WRITER_MASK)) == 0 && (state & READER_MASK) != READER_MASK;
+    }
+
+    void WLockSlow();
+
+    void RLockSlow();
+
+    /**
+     * @brief
+     * spin for a while, then sleep until the word is changed
+     * @param state the word we've seen, we sleep only when it's still the same
+     */
+    void Wait(uint32_t state, int *spin_count);
+
+    void Wake();
+
+    std::atomic<uint32_t> state_{0};
 };
 
 class ReaderGuard {
@@ -157,4 +166,4 @@ private:
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -81,8 +81,10 @@ public:
      * @param tuple tuple that we want to insert
      * @param rid location of new tuple
      * @param[in] table_info table metadata
+     * @param strategy ring used by table heap, see TableHeap::InsertTuple
      */
-    virtual void Insert(TransactionContext *txn_context, const Tuple &tuple, RID *rid, TableInfo *table_info) = 0;
+    virtual void Insert(TransactionContext *txn_context, const Tuple &tuple, RID *rid, TableInfo *table_info,
+                        BufferAccessStrategy *strategy = nullptr) = 0;
 
     /**
      * @brief 
@@ -101,8 +101,10 @@ public:
      * @param tuple tuple that we want to insert
      * @param rid location of new tuple
      * @param[in] table_info table metadata
+     * @param strategy ring used by table heap, see TableHeap::InsertTuple
      */
-    void Insert(TransactionContext *txn_context, const Tuple &tuple, RID *rid, TableInfo *table_info) override;
+    void Insert(TransactionContext *txn_context, const Tuple &tuple, RID *rid, TableInfo *table_info,
+                        BufferAccessStrategy *strategy = nullptr) override;
 
     /**
      * @brief 
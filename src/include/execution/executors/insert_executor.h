@@ -52,6 +52,8 @@ private:
     std::unique_ptr<AbstractExecutor> child_;
     // caching all the indexes that we need to insert
     std::vector<IndexInfo *> indexes_;
+    // ring of frames used by table heap, we might be inserting lots of tuples
+    std::unique_ptr<BufferAccessStrategy> strategy_;
     // cache txn manager to avoid indirection
     TransactionManager *txn_manager_;
     // cache txn context to avoid indirection
@@ -16,6 +16,8 @@
 #include "execution/plans/seq_scan_plan.h"
 #include "catalog/catalog.h"
 
+#include <memory>
+
 namespace TinyDB {
 
 /**
@@ -41,6 +43,8 @@ private:
 
     // stored the pointer to table metadata to avoid additional indirection
     TableInfo *table_info_;
+    // ring of frames the scan reads pages into, so it won't flush the buffer pool
+    std::unique_ptr<BufferAccessStrategy> strategy_;
     // iterator used to scan table
     TableIterator iterator_;
     // cache the table schema
@@ -0,0 +1,214 @@
+/**
+ * @file compressed_disk_manager.h
+ * @author sheep
+ * @brief disk manager storing pages compressed
+ * @version 0.1
+ * @date 2022-06-14
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef COMPRESSED_DISK_MANAGER_H
+#define COMPRESSED_DISK_MANAGER_H
+
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/page_allocator.h"
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * CompressedDiskManager compresses pages with LZCodec before they hit the disk, and
+ * decompresses them when they are read back. It's meant for tables that are written once
+ * and rarely read, where we'd rather spend some CPU than disk space and I/O bandwidth.
+ *
+ * compressed page is stored in a variable-size slot of data file, slot size is rounded up
+ * to SLOT_UNIT. pages that don't compress well are stored as is, in a slot of PAGE_SIZE.
+ * page id is mapped to its slot with the page map:
+ *
+ * page id:    |   0   |   1   |   2   | ...
+ * page map:   | 0, 1K | -     | 1K, 2K| ...    (offset, length) of the slot
+ * data file:  | page 0 | page 2  | free | ...
+ *
+ * rewriting a page is performed in place when it needs the same number of units, otherwise
+ * it moves to a new slot and the old one is freed. entry of page map is written right after
+ * the page, the same way PageAllocator persists its bitmap, so free slots could be rebuilt
+ * from page map when we open the database.
+ *
+ * page ids are handed out by PageAllocator, pages without a slot read as zero.
+ *
+ * page map file:
+ * ----------------------------------------------------------------------
+ * | header | (offset, length, compressed) of page 0 | ... of page n-1 |
+ * ----------------------------------------------------------------------
+ */
+class CompressedDiskManager : public DiskManager {
+    // location of a page within data file
+    struct PageLocation {
+        // byte offset of the slot
+        uint64_t offset_{0};
+        // number of bytes stored, 0 means page doesn't have a slot
+        uint32_t length_{0};
+        // whether page is stored compressed
+        uint32_t compressed_{0};
+    };
+
+    struct PageMapHeader {
+        uint32_t magic_;
+        uint32_t version_;
+        uint32_t page_size_;
+        uint32_t slot_unit_;
+    };
+
+    static constexpr uint32_t PAGE_MAP_MAGIC = 0x5a424454;  // "TDBZ"
+    static constexpr uint32_t PAGE_MAP_VERSION = 1;
+    // entries start after the header
+    static constexpr uint32_t PAGE_MAP_HEADER_SIZE = 64;
+
+public:
+    // granularity of slots in data file
+    static constexpr uint32_t SLOT_UNIT = 256;
+
+    /**
+     * @brief Construct a new Compressed Disk Manager object
+     * @param filename the file name of the database, page map, metadata and log
+     * are stored next to it
+     */
+    explicit CompressedDiskManager(const std::string &filename);
+
+    /**
+     * @brief Destroy the Compressed Disk Manager object, close the files
+     */
+    ~CompressedDiskManager() override;
+
+    /**
+     * @brief compress the page and write it to its slot
+     * it's safe to call this function concurrently with other page reads and writes
+     */
+    void WritePage(page_id_t pageId, const char *data) override;
+
+    /**
+     * @brief read the slot and decompress it
+     * it's safe to call this function concurrently with other page reads and writes
+     */
+    void ReadPage(page_id_t pageId, char *data) override;
+
+    /**
+     * @brief
+     * fdatasync the data file, page map and metadata file
+     */
+    void Sync() override;
+
+    page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID) override;
+
+    page_id_t AllocateExtent(uint32_t count) override;
+
+    /**
+     * @brief
+     * Deallocate the page, its slot will be freed
+     */
+    void DeallocatePage(page_id_t page_id) override;
+
+    inline bool IsAllocated(page_id_t page_id) override {
+        return allocator_->IsAllocated(page_id);
+    }
+
+    inline page_id_t GetPageCount() override {
+        return allocator_->GetPageCount();
+    }
+
+    inline page_id_t GetFreePageCount() override {
+        return allocator_->GetFreePageCount();
+    }
+
+    bool ReadLog(char *log_data, int size, int64_t offset) override;
+
+    void WriteLog(char *log_data, int size) override;
+
+    /**
+     * @brief
+     * number of bytes used by slots of live pages
+     */
+    uint64_t GetStoredBytes();
+
+    /**
+     * @brief
+     * number of bytes data file is taking, including the free slots
+     */
+    uint64_t GetDataFileSize();
+
+private:
+    // load page map and rebuild the free slots, return false if it's missing or corrupted
+    bool LoadPageMap();
+
+    // persist the entry of page map. latch should be held
+    void WritePageMapEntry(page_id_t page_id);
+
+    // find a free slot of length bytes, data file grows when there isn't one.
+    // latch should be held
+    uint64_t AllocateSlot(uint64_t length);
+
+    // give the slot back, merge it with its neighbours. latch should be held
+    void FreeSlot(uint64_t offset, uint64_t length);
+
+    void InsertFreeSlot(uint64_t offset, uint64_t length);
+
+    void EraseFreeSlot(uint64_t offset, uint64_t length);
+
+    // wait until we could read or write the page. writers of the same page are serialized,
+    // and they exclude readers, so a slot can't be freed and reused by another page while
+    // someone is still doing I/O on it. latch should be held by lock
+    void BeginPageIO(std::unique_lock<std::mutex> *lock, page_id_t page_id, bool write);
+
+    // latch should be held
+    void EndPageIO(page_id_t page_id, bool write);
+
+    static inline uint64_t RoundUp(uint64_t length) {
+        return (length + SLOT_UNIT - 1) / SLOT_UNIT * SLOT_UNIT;
+    }
+
+    std::string db_name_;
+    std::string map_name_;
+    std::string meta_name_;
+    std::string log_name_;
+    int db_fd_{-1};
+    int map_fd_{-1};
+    int meta_fd_{-1};
+    int log_fd_{-1};
+
+    std::unique_ptr<PageAllocator> allocator_;
+
+    // page id -> slot
+    std::vector<PageLocation> page_map_;
+    // free slots, offset -> length, used to merge neighbours
+    std::map<uint64_t, uint64_t> free_slots_;
+    // free slots ordered by (length, offset), used to find the best fit
+    std::set<std::pair<uint64_t, uint64_t>> free_slots_by_length_;
+    // end of used space within data file, new slots are appended here
+    uint64_t data_end_{0};
+    // bytes of slots referenced by page map
+    uint64_t stored_bytes_{0};
+    // pages with I/O in flight
+    struct PageIOState {
+        uint32_t reader_count_{0};
+        bool writing_{false};
+    };
+    std::unordered_map<page_id_t, PageIOState> page_io_;
+    std::condition_variable page_io_cv_;
+    // protects the page map, slots and page I/O states. page I/O is performed without it
+    std::mutex latch_;
+};
+
+}
+
+#endif
@@ -4,129 +4,232 @@
  * @brief disk manager
  * @version 0.1
  * @date 2021-10-20
- * 
+ *
  * @copyright Copyright (c) 2021
- * 
+ *
  */
 
 #ifndef DISK_MANAGER_H
 #define DISK_MANAGER_H
 
 #include <string>
-#include <fstream>
 #include <chrono>
+#include <atomic>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/io_engine.h"
+#include "storage/disk/io_stats.h"
 
 namespace TinyDB {
 
+/**
+ * @brief
+ * asynchronous page I/O request. after it's submitted, handle_ will be set
+ * and caller could wait on it
+ */
+struct DiskRequest {
+    // whether this is a write request
+    bool is_write_;
+    // page to read or write
+    page_id_t page_id_;
+    // buffer, should stay valid until the request is finished
+    char *data_;
+    // completion handle
+    IOHandle handle_{nullptr};
+};
+
+/**
+ * @brief
+ * DiskManager takes care of the allocation and deallocation of pages within a database,
+ * as well as page I/O and log I/O. This is the interface, there are several backends:
+ * FileDiskManager: the real one, pages are stored in files
+ * MemoryDiskManager: pages are stored in memory, used for testing and benchmarking
+ * LatencyDiskManager: wrapper that simulates the latency and bandwidth of a device
+ *
+ * page I/O methods should be safe to call concurrently.
+ * every backend records its I/O in stats_, which could be read by GetIOStats.
+ */
 class DiskManager {
 public:
+    DiskManager() = default;
+
+    virtual ~DiskManager() = default;
+
     /**
-     * @brief Construct a new Disk Manager object
-     * 
-     * @param filename the file name of the database
+     * @brief flush the data to the page.
+     *
+     * @param pageId id of the page you want to write
+     * @param data corresponding data you want to write
      */
-    explicit DiskManager(const std::string &filename);
+    virtual void WritePage(page_id_t pageId, const char *data) = 0;
 
     /**
-     * @brief Destroy the Disk Manager object, close the file resources
-     * 
+     * @brief read the page from disk.
+     *
+     * @param pageId id of the page you want to read
+     * @param data buffer which will store the result
      */
-    ~DiskManager();
+    virtual void ReadPage(page_id_t pageId, char *data) = 0;
 
     /**
-     * @brief flush the data to the page
-     * 
-     * @param pageId id of the page you want to write
-     * @param data corresponding data you want to write
+     * @brief read multiple pages from disk. default implementation reads them one by one
+     *
+     * @param page_ids ids of the pages you want to read
+     * @param data buffers which will store the result, one for each page
+     */
+    virtual void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &data);
+
+    /**
+     * @brief write multiple pages to disk. order of writes on the same page is undefined.
+     * default implementation writes them one by one
+     *
+     * @param page_ids ids of the pages you want to write
+     * @param data data you want to write, one for each page
+     */
+    virtual void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &data);
+
+    /**
+     * @brief
+     * submit a batch of page I/O with a single submission.
+     * handle_ of every request will be set.
+     * default implementation performs them synchronously
+     * @param requests
      */
-    void WritePage(page_id_t pageId, const char *data);
+    virtual void SubmitBatch(std::vector<DiskRequest> &requests);
 
     /**
-     * @brief read the page from disk
-     * 
+     * @brief
+     * submit an asynchronous page read.
      * @param pageId id of the page you want to read
-     * @param data buffer which will store the result
+     * @param data buffer which will store the result, should stay valid until completion
+     * @return IOHandle completion handle
+     */
+    IOHandle SubmitRead(page_id_t pageId, char *data);
+
+    /**
+     * @brief
+     * submit an asynchronous page write.
+     * @param pageId id of the page you want to write
+     * @param data data you want to write, should stay valid until completion
+     * @return IOHandle completion handle
+     */
+    IOHandle SubmitWrite(page_id_t pageId, const char *data);
+
+    /**
+     * @brief
+     * make the page writes durable
      */
-    void ReadPage(page_id_t pageId, char *data);
+    virtual void Sync() = 0;
 
     /**
-     * @brief allocate a new page
-     * 
+     * @brief allocate a new page. content of new page is zero
+     *
+     * @param hint the page that new page is logically followed. e.g. previous page of table heap.
+     * we will try to place them physically sequential
      * @return page_id_t the id of allocated page
      */
-    page_id_t AllocatePage();
+    virtual page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID) = 0;
 
     /**
-     * @brief 
-     * Deallocate a page on disk
-     * @param page_id 
+     * @brief
+     * allocate count contiguous pages. content of new pages is zero
+     * @param count number of pages
+     * @return page_id_t id of the first page
      */
-    void DeallocatePage(page_id_t page_id);
+    virtual page_id_t AllocateExtent(uint32_t count) = 0;
 
-    inline int GetAllocateCount() {
-        return allocate_count_;
-    }
+    /**
+     * @brief
+     * Deallocate a page on disk, it could be reused by later allocation
+     * @param page_id
+     */
+    virtual void DeallocatePage(page_id_t page_id) = 0;
 
-    inline int GetDeallocateCount() {
-        return deallocate_count_;
-    }
+    /**
+     * @brief
+     * whether the page is allocated
+     */
+    virtual bool IsAllocated(page_id_t page_id) = 0;
+
+    /**
+     * @brief
+     * number of pages we could hold without growing
+     */
+    virtual page_id_t GetPageCount() = 0;
+
+    /**
+     * @brief
+     * number of free pages that could be reused
+     */
+    virtual page_id_t GetFreePageCount() = 0;
 
     /**
-     * @brief 
+     * @brief
      * Read log from disk. could be many log at a time
-     * @param log_data 
-     * @param size 
-     * @param offset 
+     * @param log_data
+     * @param size
+     * @param offset
      * @return return false means we are reaching the end
      */
-    bool ReadLog(char *log_data, int size, int offset);
+    virtual bool ReadLog(char *log_data, int size, int64_t offset) = 0;
 
     /**
-     * @brief 
+     * @brief
      * Flush the log buffer into disk
-     * @param log_data 
-     * @param size 
+     * @param log_data
+     * @param size
+     */
+    virtual void WriteLog(char *log_data, int size) = 0;
+
+    /**
+     * @brief
+     * snapshot of page I/O, log I/O and sync statistics
      */
-    void WriteLog(char *log_data, int size);
+    inline IOStatsSnapshot GetIOStats() const {
+        return stats_.Snapshot();
+    }
+
+    inline void ResetIOStats() {
+        stats_.Reset();
+    }
+
+    inline int GetAllocateCount() {
+        return allocate_count_.load();
+    }
+
+    inline int GetDeallocateCount() {
+        return deallocate_count_.load();
+    }
 
     // for analysis
     std::chrono::milliseconds log_write_time_{0};
     std::chrono::milliseconds log_read_time_{0};
-    
-private:
-    /**
-     * @brief helper function to get file size
-     * 
-     * @param filename 
-     * @return int size of file
-     */
-    int GetFileSize(const std::string &filename);
-
-private:
-    // file name for db file
-    std::string db_name_;
-    // file stream for db file
-    std::fstream db_file_;
-    // file name for log file
-    std::string log_name_;
-    // file stream for log file
-    std::fstream log_file_;
-    // id for next page
-    page_id_t next_page_id_;
-    // record the previous buffer we used to enforce
-    // swapping buffer
-    char *buffer_used_;
-    // whether we are flushing the log
-    // std::atomic<bool> is_flushing_;
-    
-    // for debug purpose
-    int allocate_count_;
-    int deallocate_count_;
 
+protected:
+    // implementations are responsible for recording their own I/O
+    IOStats stats_;
+
+    // for debug purpose
+    std::atomic<int> allocate_count_{0};
+    std::atomic<int> deallocate_count_{0};
 };
 
+/**
+ * @brief
+ * name of a file belonging to the database, e.g. ("test.db", ".meta") -> "test.meta".
+ * disk managers derive the names of their log and metadata files from db file this way
+ */
+std::string GetDatabaseFileName(const std::string &db_file, const std::string &extension);
+
+/**
+ * @brief
+ * remove db file and every file derived from it: log, allocator metadata, page map,
+ * tablespace descriptor and the data files it lists. missing files are ignored.
+ * database shouldn't be open
+ */
+void RemoveDatabaseFiles(const std::string &db_file);
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,278 @@
+/**
+ * @file file_disk_manager.h
+ * @author sheep
+ * @brief disk manager backed by files
+ * @version 0.1
+ * @date 2021-10-20
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#ifndef FILE_DISK_MANAGER_H
+#define FILE_DISK_MANAGER_H
+
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/io_engine.h"
+#include "storage/disk/page_allocator.h"
+#include "storage/disk/tablespace.h"
+
+namespace TinyDB {
+
+/**
+ * @brief 
+ * FileDiskManager stores pages in files.
+ * page I/O is performed with positional pread/pwrite on a raw file descriptor, so there is
+ * no shared file cursor and multiple threads can read and write pages concurrently.
+ * log I/O is still serialized since only the log flush thread is writing it.
+ * page I/O could also be submitted asynchronously through io engine. (io_uring or thread pool)
+ * when direct I/O is enabled, db file is opened with O_DIRECT to bypass the OS page cache,
+ * since we are caching the pages in buffer pool already.
+ * page allocation state is kept in a bitmap persisted in a metadata file next to db file,
+ * so deallocated pages could be reused, even after restart.
+ * pages could be striped across several data files, see Tablespace. it's transparent to the callers.
+ */
+class FileDiskManager : public DiskManager {
+public:
+    /**
+     * @brief Construct a new File Disk Manager object
+     * 
+     * @param filename the file name of the database
+     * @param io_engine_type io engine used for asynchronous page I/O
+     * @param direct_io whether to bypass OS page cache. buffers are expected to be
+     * aligned to PAGE_ALIGNMENT, otherwise we will copy it through an aligned buffer
+     * @param data_files additional data files that pages are striped across, could be placed
+     * on different devices. it's only used when creating a new database, layout of existing
+     * database is read from its tablespace descriptor
+     */
+    explicit FileDiskManager(const std::string &filename, 
+                              IOEngineType io_engine_type = IOEngineType::AUTO,
+                              bool direct_io = false,
+                              const std::vector<std::string> &data_files = {});
+
+    /**
+     * @brief Destroy the File Disk Manager object, close the file resources
+     * 
+     */
+    ~FileDiskManager() override;
+
+    /**
+     * @brief flush the data to the page.
+     * it's safe to call this function concurrently with other page reads and writes
+     * 
+     * @param pageId id of the page you want to write
+     * @param data corresponding data you want to write
+     */
+    void WritePage(page_id_t pageId, const char *data) override;
+
+    /**
+     * @brief read the page from disk.
+     * it's safe to call this function concurrently with other page reads and writes
+     * 
+     * @param pageId id of the page you want to read
+     * @param data buffer which will store the result
+     */
+    void ReadPage(page_id_t pageId, char *data) override;
+
+    /**
+     * @brief read multiple pages from disk.
+     * pages are sorted and contiguous runs are read with a single preadv,
+     * so reading sequential pages costs one syscall rather than one per page
+     * 
+     * @param page_ids ids of the pages you want to read
+     * @param data buffers which will store the result, one for each page
+     */
+    void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &data) override;
+
+    /**
+     * @brief write multiple pages to disk.
+     * contiguous runs are written with a single pwritev. order of writes on the same page is undefined
+     * 
+     * @param page_ids ids of the pages you want to write
+     * @param data data you want to write, one for each page
+     */
+    void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &data) override;
+
+    /**
+     * @brief
+     * submit a batch of page I/O with a single submission.
+     * handle_ of every request will be set
+     * @param requests
+     */
+    void SubmitBatch(std::vector<DiskRequest> &requests) override;
+
+    /**
+     * @brief allocate a new page. content of new page is zero
+     * 
+     * @param hint the page that new page is logically followed. e.g. previous page of table heap.
+     * we will try to place them physically sequential
+     * @return page_id_t the id of allocated page
+     */
+    page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID) override;
+
+    /**
+     * @brief 
+     * allocate count contiguous pages. content of new pages is zero
+     * @param count number of pages
+     * @return page_id_t id of the first page
+     */
+    page_id_t AllocateExtent(uint32_t count) override;
+
+    /**
+     * @brief 
+     * Deallocate a page on disk, it could be reused by later allocation
+     * @param page_id 
+     */
+    void DeallocatePage(page_id_t page_id) override;
+
+    /**
+     * @brief 
+     * whether the page is allocated
+     */
+    inline bool IsAllocated(page_id_t page_id) override {
+        return allocator_->IsAllocated(page_id);
+    }
+
+    /**
+     * @brief 
+     * number of pages data files could hold without growing
+     */
+    inline page_id_t GetPageCount() override {
+        return allocator_->GetPageCount();
+    }
+
+    /**
+     * @brief 
+     * number of free pages within db file
+     */
+    inline page_id_t GetFreePageCount() override {
+        return allocator_->GetFreePageCount();
+    }
+
+    /**
+     * @brief 
+     * number of data files that pages are striped across
+     */
+    inline size_t GetDataFileNum() const {
+        return tablespace_->GetFileNum();
+    }
+
+    /**
+     * @brief 
+     * whether db file is opened with O_DIRECT
+     */
+    inline bool IsDirectIO() const {
+        return direct_io_;
+    }
+
+    /**
+     * @brief 
+     * Read log from disk. could be many log at a time
+     * @param log_data 
+     * @param size 
+     * @param offset 
+     * @return return false means we are reaching the end
+     */
+    bool ReadLog(char *log_data, int size, int64_t offset) override;
+
+    /**
+     * @brief 
+     * Flush the log buffer into disk
+     * @param log_data 
+     * @param size 
+     */
+    void WriteLog(char *log_data, int size) override;
+
+    /**
+     * @brief 
+     * fdatasync all the data files
+     */
+    void Sync() override;
+
+private:
+    /**
+     * @brief helper function to get file size
+     * 
+     * @param filename 
+     * @return int64_t size of file, -1 when the file doesn't exist
+     */
+    int64_t GetFileSize(const std::string &filename);
+
+    /**
+     * @brief 
+     * get the io engine, create it when we are using it for the first time.
+     * so synchronous user won't pay for the background threads
+     * @return IOEngine* 
+     */
+    IOEngine *GetIOEngine();
+
+    /**
+     * @brief 
+     * whether the buffer could be used for I/O on db file directly
+     */
+    inline bool IsAligned(const char *data) const {
+        return !direct_io_ || reinterpret_cast<uintptr_t>(data) % PAGE_ALIGNMENT == 0;
+    }
+
+    /**
+     * @brief 
+     * grow db file to cover pages [begin, end). we preallocate the space
+     * so that pages are more likely to be physically contiguous
+     */
+    void ExtendFile(page_id_t begin, page_id_t end);
+
+    /**
+     * @brief 
+     * wipe out the content of pages [begin, end)
+     */
+    void ZeroPages(page_id_t begin, page_id_t end);
+
+    /**
+     * @brief 
+     * shared implementation of ReadPages and WritePages
+     */
+    void TransferPages(bool is_write, const std::vector<page_id_t> &page_ids, const std::vector<char *> &data);
+
+    // raw page I/O without alignment handling
+    void ReadPageInternal(page_id_t pageId, char *data);
+    void WritePageInternal(page_id_t pageId, const char *data);
+
+private:
+    // file name for db file
+    std::string db_name_;
+    // data files, all page I/O goes through pread/pwrite on them
+    std::unique_ptr<Tablespace> tablespace_;
+    // whether db file is opened with O_DIRECT
+    bool direct_io_;
+    // io engine for asynchronous page I/O, created lazily
+    IOEngineType io_engine_type_;
+    std::unique_ptr<IOEngine> io_engine_;
+    std::once_flag io_engine_flag_;
+    // file name for metadata file
+    std::string meta_name_;
+    // file descriptor for metadata file
+    int meta_fd_{-1};
+    // page allocation bitmap
+    std::unique_ptr<PageAllocator> allocator_;
+    // file name for log file
+    std::string log_name_;
+    // file stream for log file
+    std::fstream log_file_;
+    // record the previous buffer we used to enforce
+    // swapping buffer
+    char *buffer_used_;
+
+};
+
+}
+
+#endif
\ No newline at end of file
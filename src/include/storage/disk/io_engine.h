@@ -0,0 +1,172 @@
+/**
+ * @file io_engine.h
+ * @author sheep
+ * @brief abstraction of asynchronous file I/O engine
+ * @version 0.1
+ * @date 2022-06-05
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef IO_ENGINE_H
+#define IO_ENGINE_H
+
+#include <sys/types.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace TinyDB {
+
+enum class IOEngineType {
+    // use io_uring when kernel supports it, otherwise fallback to thread pool
+    AUTO,
+    IO_URING,
+    THREAD_POOL,
+};
+
+enum class IOType {
+    READ,
+    WRITE,
+};
+
+/**
+ * @brief
+ * completion handle of a submitted I/O request.
+ * submitter could poll it with IsDone or block on Wait.
+ */
+class IOCompletion {
+public:
+    // invoked by io engine right before waking up the waiters
+    using Callback = std::function<void(bool success)>;
+
+    IOCompletion() = default;
+
+    /**
+     * @brief
+     * set the callback, should be called before the request is submitted
+     */
+    inline void SetCallback(Callback callback) {
+        callback_ = std::move(callback);
+    }
+
+    /**
+     * @brief
+     * whether the I/O has finished. won't block
+     */
+    inline bool IsDone() const {
+        return done_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief
+     * block until the I/O has finished
+     * @return true when the I/O succeed
+     */
+    bool Wait() {
+        if (!IsDone()) {
+            std::unique_lock<std::mutex> latch(mutex_);
+            cv_.wait(latch, [&]() { return IsDone(); });
+        }
+        return success_;
+    }
+
+    /**
+     * @brief
+     * mark the request as finished and wakeup the waiters. called by io engine
+     * @param success whether the I/O succeed
+     */
+    void Complete(bool success) {
+        if (callback_) {
+            callback_(success);
+        }
+        {
+            std::lock_guard<std::mutex> latch(mutex_);
+            success_ = success;
+            done_.store(true, std::memory_order_release);
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::atomic<bool> done_{false};
+    bool success_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    Callback callback_;
+};
+
+using IOHandle = std::shared_ptr<IOCompletion>;
+
+/**
+ * @brief
+ * a single file I/O request. buffer should stay valid until the request is completed
+ */
+struct IORequest {
+    IOType type_;
+    int fd_;
+    char *data_;
+    size_t size_;
+    off_t offset_;
+    IOHandle handle_;
+};
+
+/**
+ * @brief
+ * IOEngine performs file I/O asynchronously. Submission could be batched,
+ * so that we can issue many requests with a single syscall.
+ * Reading past the end of file is not an error, the rest of buffer will be zeroed.
+ */
+class IOEngine {
+public:
+    IOEngine() = default;
+    virtual ~IOEngine() = default;
+
+    /**
+     * @brief
+     * submit a batch of requests. completion will be notified through the handle within each request
+     * @param requests
+     */
+    virtual void Submit(const std::vector<IORequest> &requests) = 0;
+
+    /**
+     * @brief
+     * submit a single request
+     */
+    inline void Submit(const IORequest &request) {
+        Submit(std::vector<IORequest>{request});
+    }
+
+    /**
+     * @brief
+     * return the real type of this engine
+     */
+    virtual IOEngineType GetType() const = 0;
+
+    /**
+     * @brief
+     * create a io engine, AUTO will try io_uring first
+     * @param type type of io engine
+     * @param queue_depth maximum number of in-flight requests (io_uring), or number of workers (thread pool)
+     * @return std::unique_ptr<IOEngine>, nullptr when the requested engine is not supported
+     */
+    static std::unique_ptr<IOEngine> Create(IOEngineType type, uint32_t queue_depth);
+
+protected:
+    /**
+     * @brief
+     * perform (the rest of) a request synchronously.
+     * @param request
+     * @param done number of bytes that has been transferred already
+     * @return true when succeed
+     */
+    static bool PerformSync(const IORequest &request, size_t done = 0);
+};
+
+}
+
+#endif
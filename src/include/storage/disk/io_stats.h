@@ -0,0 +1,120 @@
+/**
+ * @file io_stats.h
+ * @author sheep
+ * @brief I/O statistics of disk manager
+ * @version 0.1
+ * @date 2022-06-13
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef IO_STATS_H
+#define IO_STATS_H
+
+#include "common/histogram.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * snapshot of a single kind of I/O
+ */
+struct IOStatSnapshot {
+    // number of I/O requests, a vectored request is counted once
+    uint64_t ops_{0};
+    uint64_t bytes_{0};
+    // latency in nanoseconds
+    HistogramSnapshot latency_;
+
+    /**
+     * @brief
+     * e.g. ops 1024, 4.0MiB, avg 80.1us, p50 79.0us, p99 120.0us, p999 1.0ms, max 1.2ms
+     */
+    std::string ToString() const;
+};
+
+/**
+ * @brief
+ * counters of a single kind of I/O. all lock-free
+ */
+class IOStat {
+public:
+    inline void Record(uint64_t bytes, uint64_t nanoseconds) {
+        ops_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        latency_.Record(nanoseconds);
+    }
+
+    IOStatSnapshot Snapshot() const;
+
+    void Reset();
+
+private:
+    std::atomic<uint64_t> ops_{0};
+    std::atomic<uint64_t> bytes_{0};
+    LatencyHistogram latency_;
+};
+
+/**
+ * @brief
+ * snapshot of all the I/O statistics of a disk manager
+ */
+struct IOStatsSnapshot {
+    IOStatSnapshot page_read_;
+    IOStatSnapshot page_write_;
+    IOStatSnapshot log_read_;
+    IOStatSnapshot log_write_;
+    IOStatSnapshot sync_;
+
+    /**
+     * @brief
+     * multi-line report, one line for each kind of I/O
+     */
+    std::string ToString() const;
+};
+
+/**
+ * @brief
+ * I/O statistics of a disk manager
+ */
+class IOStats {
+public:
+    IOStatsSnapshot Snapshot() const;
+
+    void Reset();
+
+    IOStat page_read_;
+    IOStat page_write_;
+    IOStat log_read_;
+    IOStat log_write_;
+    IOStat sync_;
+};
+
+/**
+ * @brief
+ * measure the I/O within the scope and record it when we leave
+ */
+class IOTimer {
+public:
+    IOTimer(IOStat *stat, uint64_t bytes)
+        : stat_(stat), bytes_(bytes), start_(std::chrono::steady_clock::now()) {}
+
+    ~IOTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        stat_->Record(bytes_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+private:
+    IOStat *stat_;
+    uint64_t bytes_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file io_uring_io_engine.h
+ * @author sheep
+ * @brief io engine based on linux io_uring
+ * @version 0.1
+ * @date 2022-06-05
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef IO_URING_IO_ENGINE_H
+#define IO_URING_IO_ENGINE_H
+
+#include "storage/disk/io_engine.h"
+
+#include <sys/uio.h>
+#include <thread>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * io engine built on io_uring. we don't depend on liburing, ring is set up with raw syscalls.
+ * submitters fill the submission queue and enter the kernel once per batch,
+ * a background thread reaps the completion queue and notifies the handles.
+ */
+class IOUringIOEngine : public IOEngine {
+    // in-flight request, address of it is used as user_data of sqe
+    struct InflightIO {
+        IORequest request_;
+        struct iovec iov_;
+    };
+
+public:
+    /**
+     * @brief
+     * Construct a new IOUringIOEngine. check IsValid before using it
+     * @param queue_depth size of submission queue
+     */
+    explicit IOUringIOEngine(uint32_t queue_depth);
+
+    ~IOUringIOEngine() override;
+
+    /**
+     * @brief
+     * whether the ring is successfully set up. it might fail on old kernels
+     * or when io_uring is disabled
+     */
+    inline bool IsValid() const {
+        return ring_fd_ >= 0;
+    }
+
+    void Submit(const std::vector<IORequest> &requests) override;
+
+    IOEngineType GetType() const override {
+        return IOEngineType::IO_URING;
+    }
+
+private:
+    bool SetupRing(uint32_t queue_depth);
+
+    void ReapThread();
+
+    // number of requests that kernel has not completed yet
+    uint32_t inflight_{0};
+    // protect submission queue and inflight_
+    std::mutex latch_;
+    // wait for free slots of submission queue
+    std::condition_variable cv_;
+
+    int ring_fd_{-1};
+    uint32_t sq_entries_{0};
+
+    // mapped rings
+    void *sq_ring_ptr_{nullptr};
+    size_t sq_ring_size_{0};
+    void *cq_ring_ptr_{nullptr};
+    size_t cq_ring_size_{0};
+    void *sqes_ptr_{nullptr};
+    size_t sqes_size_{0};
+
+    // pointers into the submission ring
+    unsigned *sq_head_{nullptr};
+    unsigned *sq_tail_{nullptr};
+    unsigned *sq_mask_{nullptr};
+    unsigned *sq_array_{nullptr};
+    // pointers into the completion ring
+    unsigned *cq_head_{nullptr};
+    unsigned *cq_tail_{nullptr};
+    unsigned *cq_mask_{nullptr};
+    void *cqes_{nullptr};
+
+    std::thread *reap_thread_{nullptr};
+    std::atomic<bool> enable_reaping_{false};
+};
+
+}
+
+#endif
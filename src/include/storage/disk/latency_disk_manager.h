@@ -0,0 +1,229 @@
+/**
+ * @file latency_disk_manager.h
+ * @author sheep
+ * @brief disk manager wrapper that simulates the latency and bandwidth of a device
+ * @version 0.1
+ * @date 2022-06-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef LATENCY_DISK_MANAGER_H
+#define LATENCY_DISK_MANAGER_H
+
+#include "storage/disk/disk_manager.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * performance characteristics of a simulated device
+ */
+struct DeviceProfile {
+    // time to serve a single request, excluding the transfer
+    std::chrono::microseconds read_latency_{0};
+    std::chrono::microseconds write_latency_{0};
+    // time to make the writes durable
+    std::chrono::microseconds sync_latency_{0};
+    // bytes per second, 0 means unlimited
+    uint64_t read_bandwidth_{0};
+    uint64_t write_bandwidth_{0};
+    // number of requests device could serve in parallel
+    uint32_t queue_depth_{1};
+
+    /**
+     * @brief
+     * a typical NVMe SSD
+     */
+    static DeviceProfile SSD() {
+        return DeviceProfile{std::chrono::microseconds(80), std::chrono::microseconds(20),
+                             std::chrono::microseconds(500), 2000ULL << 20, 1000ULL << 20, 32};
+    }
+
+    /**
+     * @brief
+     * a typical 7200rpm HDD, every random access pays a seek
+     */
+    static DeviceProfile HDD() {
+        return DeviceProfile{std::chrono::microseconds(8000), std::chrono::microseconds(8000),
+                             std::chrono::microseconds(10000), 150ULL << 20, 150ULL << 20, 1};
+    }
+};
+
+/**
+ * @brief
+ * LatencyDiskManager forwards everything to another disk manager, and delays the caller
+ * as if the I/O is served by the device described in the profile.
+ * Typically it's used on top of MemoryDiskManager, so the cost of I/O is under control.
+ *
+ * cost model:
+ * every contiguous run of pages in a call is a request paying the latency. device serves
+ * queue_depth_ requests at a time, the queue is shared by all the callers, and excess
+ * requests wait for the earlier ones. data transfer is serialized on a single channel
+ * shared by all the callers, that's how bandwidth limit is enforced.
+ * sync waits for all the requests accepted before it, including the submitted batches,
+ * then holds the whole device for the sync latency. log writes pay a sync as well.
+ * asynchronous submission returns right away, the device is reserved at submission and
+ * a device thread completes the batch when it's served. like a real device, batches
+ * complete in the order they are served, not the one they are submitted.
+ */
+class LatencyDiskManager : public DiskManager {
+public:
+    /**
+     * @brief Construct a new Latency Disk Manager object
+     * @param disk_manager disk manager doing the real work, it's not owned by us
+     * @param profile the device we are simulating
+     */
+    LatencyDiskManager(DiskManager *disk_manager, const DeviceProfile &profile);
+
+    /**
+     * @brief Destroy the Latency Disk Manager object, submitted batches are completed first
+     */
+    ~LatencyDiskManager() override;
+
+    void WritePage(page_id_t pageId, const char *data) override;
+
+    void ReadPage(page_id_t pageId, char *data) override;
+
+    void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &data) override;
+
+    void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &data) override;
+
+    void SubmitBatch(std::vector<DiskRequest> &requests) override;
+
+    void Sync() override;
+
+    page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID) override;
+
+    page_id_t AllocateExtent(uint32_t count) override;
+
+    void DeallocatePage(page_id_t page_id) override;
+
+    bool IsAllocated(page_id_t page_id) override {
+        return disk_manager_->IsAllocated(page_id);
+    }
+
+    page_id_t GetPageCount() override {
+        return disk_manager_->GetPageCount();
+    }
+
+    page_id_t GetFreePageCount() override {
+        return disk_manager_->GetFreePageCount();
+    }
+
+    /**
+     * @brief
+     * reading log is sequential, it pays a read request
+     */
+    bool ReadLog(char *log_data, int size, int64_t offset) override;
+
+    /**
+     * @brief
+     * writing log is forcing it, it pays a write request and a sync
+     */
+    void WriteLog(char *log_data, int size) override;
+
+    inline const DeviceProfile &GetProfile() const {
+        return profile_;
+    }
+
+    /**
+     * @brief
+     * stall the device, requests and syncs reaching it from now on wait until Resume, so as the
+     * submitted batches being completed. e.g. tests use it to keep a request in flight
+     * as long as they need
+     */
+    void Pause();
+
+    /**
+     * @brief
+     * let the stalled requests go, they pay their cost as usual
+     */
+    void Resume();
+
+    /**
+     * @brief
+     * block until at least count requests are stalled by Pause
+     */
+    void WaitForStalled(size_t count);
+
+private:
+    /**
+     * @brief
+     * block the caller as if the device is serving the requests
+     * @param is_write
+     * @param request_num number of requests
+     * @param bytes total bytes to transfer
+     * @param sync whether the requests are followed by a sync
+     */
+    void Delay(bool is_write, size_t request_num, size_t bytes, bool sync = false);
+
+    /**
+     * @brief
+     * occupy the queue and the channel, device_latch_ should be held
+     * @return time when the requests are served
+     */
+    std::chrono::steady_clock::time_point Reserve(bool is_write, size_t request_num, size_t bytes,
+                                                  std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief
+     * occupy the whole device for a sync, device_latch_ should be held
+     * @return time when the sync is done
+     */
+    std::chrono::steady_clock::time_point ReserveSync(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief
+     * wait until the device is resumed, device_latch_ should be held
+     */
+    void WaitForResume(std::unique_lock<std::mutex> *lock);
+
+    // completes the submitted batches once they are served
+    void DeviceThread();
+
+    struct PendingBatch {
+        std::chrono::steady_clock::time_point submit_time_;
+        // handles are ours, they are completed after the underlying ones
+        std::vector<DiskRequest> requests_;
+    };
+
+    /**
+     * @brief
+     * number of contiguous runs within the pages
+     */
+    static size_t CountRuns(std::vector<page_id_t> page_ids);
+
+    DiskManager *disk_manager_;
+    DeviceProfile profile_;
+    // time when the transfer channel becomes free
+    std::chrono::steady_clock::time_point channel_free_time_;
+    // time when each slot of the device queue becomes free, min heap
+    std::vector<std::chrono::steady_clock::time_point> queue_free_time_;
+    // time when all the requests accepted so far are served
+    std::chrono::steady_clock::time_point idle_time_;
+    // submitted batches ordered by the time they are served
+    std::multimap<std::chrono::steady_clock::time_point, PendingBatch> pending_;
+    bool enable_running_{true};
+    std::condition_variable device_cv_;
+    std::thread device_thread_;
+    // device is stalled by Pause
+    bool paused_{false};
+    // number of calls waiting for Resume
+    size_t stalled_{0};
+    std::condition_variable pause_cv_;
+    // protects the channel, the queue and the pause state
+    std::mutex device_latch_;
+};
+
+}
+
+#endif
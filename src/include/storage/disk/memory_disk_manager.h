@@ -0,0 +1,88 @@
+/**
+ * @file memory_disk_manager.h
+ * @author sheep
+ * @brief disk manager that keeps everything in memory
+ * @version 0.1
+ * @date 2022-06-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef MEMORY_DISK_MANAGER_H
+#define MEMORY_DISK_MANAGER_H
+
+#include "storage/disk/disk_manager.h"
+#include "common/rwlatch.h"
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * MemoryDiskManager stores pages and log in memory, nothing survives the destruction.
+ * Page I/O is just a memcpy, so benchmarks running on it measure the engine itself
+ * rather than the disk and OS page cache. Wrap it with LatencyDiskManager to simulate a device.
+ * pages are materialized on the first write, pages that have never been written read as zero.
+ */
+class MemoryDiskManager : public DiskManager {
+public:
+    MemoryDiskManager() = default;
+
+    ~MemoryDiskManager() override = default;
+
+    void WritePage(page_id_t pageId, const char *data) override;
+
+    void ReadPage(page_id_t pageId, char *data) override;
+
+    /**
+     * @brief
+     * nothing to do, memory is as durable as it could be
+     */
+    void Sync() override {
+        IOTimer timer(&stats_.sync_, 0);
+    }
+
+    page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID) override;
+
+    page_id_t AllocateExtent(uint32_t count) override;
+
+    void DeallocatePage(page_id_t page_id) override;
+
+    bool IsAllocated(page_id_t page_id) override;
+
+    page_id_t GetPageCount() override;
+
+    page_id_t GetFreePageCount() override;
+
+    bool ReadLog(char *log_data, int size, int64_t offset) override;
+
+    void WriteLog(char *log_data, int size) override;
+
+private:
+    // mark the page as used. latch should be held in write mode
+    void MarkAllocated(page_id_t page_id);
+
+    // page content, nullptr means the page is zero.
+    std::vector<std::unique_ptr<char[]>> pages_;
+    // allocation state, size of it is the number of pages we have
+    std::vector<bool> allocated_;
+    // free pages below allocated_.size(), ordered so that we reuse the lowest one first
+    std::set<page_id_t> free_pages_;
+    // protects the vectors above. page I/O holds it in read mode,
+    // growing the page store and allocation hold it in write mode
+    ReaderWriterLatch latch_;
+
+    // log records
+    std::string log_;
+    std::mutex log_latch_;
+};
+
+}
+
+#endif
@@ -0,0 +1,178 @@
+/**
+ * @file page_allocator.h
+ * @author sheep
+ * @brief persistent free page bitmap used by disk manager
+ * @version 0.1
+ * @date 2022-06-08
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef PAGE_ALLOCATOR_H
+#define PAGE_ALLOCATOR_H
+
+#include "common/config.h"
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * PageAllocator keeps track of which pages are in use with a bitmap, so that deallocated
+ * pages could be reused. The bitmap is persisted in a separate metadata file, every time
+ * we flip a bit we will write the corresponding word back, so the state survives a restart.
+ *
+ * Free pages are expected to read as zero, so a new page could be handed out without writing it.
+ * Data file grows in extents. i.e. EXTENT_SIZE pages at a time, and we will try to place
+ * pages of a single chain (e.g. table heap, leaves of b+tree) physically sequential by
+ * allocating right after the hint page, or starting a new extent for it if there is a free one.
+ * otherwise the lowest free page is reused, data file only grows when there is no free page.
+ *
+ * layout of metadata file:
+ * ---------------------------------------------------------------------------
+ * | header (META_HEADER_SIZE) | bitmap words (8 bytes each, 1 bit per page) |
+ * ---------------------------------------------------------------------------
+ */
+class PageAllocator {
+    // metadata file header
+    struct MetaHeader {
+        uint32_t magic_;
+        uint32_t version_;
+        uint32_t page_size_;
+        uint32_t extent_size_;
+        // number of pages covered by data file
+        int32_t page_count_;
+    };
+
+    static constexpr uint32_t META_MAGIC = 0x4d424454;  // "TDBM"
+    static constexpr uint32_t META_VERSION = 1;
+    static constexpr uint32_t META_HEADER_SIZE = 4096;
+    static constexpr uint32_t BITS_PER_WORD = 64;
+
+public:
+    // callback used to extend the data file to cover pages [begin, end)
+    using ExtendCallback = std::function<void(page_id_t begin, page_id_t end)>;
+
+    /**
+     * @brief Construct a new Page Allocator object. call Load or Format before using it
+     * @param meta_fd file descriptor of metadata file, it's owned by caller
+     * @param extent_size number of pages that data file grows at a time
+     * @param extend_callback called when we need more space in data file
+     */
+    PageAllocator(int meta_fd, uint32_t extent_size, ExtendCallback extend_callback);
+
+    ~PageAllocator() = default;
+
+    /**
+     * @brief
+     * load the bitmap from metadata file
+     * @return false when metadata is missing or corrupted
+     */
+    bool Load();
+
+    /**
+     * @brief
+     * initialize the metadata file. first page_count pages are treated as allocated,
+     * which is used to adopt an existing data file without metadata
+     * @param page_count
+     */
+    void Format(page_id_t page_count);
+
+    /**
+     * @brief
+     * allocate a single page
+     * @param hint the page that new page is logically followed. e.g. previous page in the chain.
+     * we will try to allocate the page right after it
+     * @return page_id_t id of new page
+     */
+    page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID);
+
+    /**
+     * @brief
+     * allocate count contiguous pages
+     * @param count number of pages
+     * @return page_id_t id of the first page
+     */
+    page_id_t AllocateExtent(uint32_t count);
+
+    /**
+     * @brief
+     * give the page back. caller should make sure the content of page is wiped out,
+     * since we assume free pages are zero
+     * @return false when the page is not allocated
+     */
+    bool DeallocatePage(page_id_t page_id);
+
+    /**
+     * @brief
+     * whether page is in use
+     */
+    bool IsAllocated(page_id_t page_id);
+
+    /**
+     * @brief
+     * number of pages covered by data file, including free ones
+     */
+    page_id_t GetPageCount();
+
+    /**
+     * @brief
+     * number of free pages that could be reused without growing the data file
+     */
+    page_id_t GetFreePageCount();
+
+private:
+    inline bool TestBit(page_id_t page_id) const {
+        return (bitmap_[page_id / BITS_PER_WORD] >> (page_id % BITS_PER_WORD)) & 1;
+    }
+
+    // set the bit and persist the corresponding word
+    void SetBit(page_id_t page_id, bool used);
+
+    // find a free page within [begin, end), return INVALID_PAGE_ID when there isn't one
+    page_id_t FindFree(page_id_t begin, page_id_t end) const;
+
+    // find count contiguous free pages within data file
+    page_id_t FindFreeRun(uint32_t count) const;
+
+    // find an extent without any page in use, return INVALID_PAGE_ID when there isn't one
+    page_id_t FindFreeExtent();
+
+    // count the pages in use of each extent from the bitmap
+    void RebuildExtents();
+
+    // grow data file so that it could cover at least page_count pages
+    void Extend(page_id_t page_count);
+
+    void WriteHeader();
+
+    void WriteWord(size_t word_idx);
+
+    int meta_fd_;
+    uint32_t extent_size_;
+    ExtendCallback extend_callback_;
+
+    // number of pages covered by data file
+    page_id_t page_count_{0};
+    // number of pages in use
+    page_id_t used_count_{0};
+    // all the words before this one are full
+    size_t first_free_word_{0};
+    // 1 means the page is in use
+    std::vector<uint64_t> bitmap_;
+    // number of pages in use within each extent
+    std::vector<uint32_t> extent_used_;
+    // number of extents without any page in use
+    size_t free_extent_count_{0};
+    // all the extents before this one have pages in use
+    size_t first_free_extent_{0};
+    std::mutex latch_;
+};
+
+}
+
+#endif
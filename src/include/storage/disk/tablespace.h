@@ -0,0 +1,149 @@
+/**
+ * @file tablespace.h
+ * @author sheep
+ * @brief mapping from page id to data files
+ * @version 0.1
+ * @date 2022-06-10
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef TABLESPACE_H
+#define TABLESPACE_H
+
+#include "common/config.h"
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * Tablespace spreads the pages of a database across one or more data files, so that I/O
+ * could be distributed among several devices. Pages are striped in units of stripe_size
+ * pages, i.e. stripe i is stored in file i % N:
+ *
+ * page id:  | 0 .. s-1 | s .. 2s-1 | 2s .. 3s-1 | 3s .. 4s-1 | ...
+ * file:     |  file 0  |  file 1   |   file 0   |   file 1   | ...
+ *
+ * The first data file is always the db file itself, with a single file the mapping is identity.
+ * Layout is persisted in a descriptor file next to db file, and will be used whenever we reopen
+ * the database, since changing it would scramble the pages.
+ *
+ * descriptor file is plain text:
+ * stripe_size <pages>
+ * file <path of data file 0>
+ * file <path of data file 1>
+ * ...
+ */
+class Tablespace {
+public:
+    /**
+     * @brief Construct a new Tablespace object, open or create the data files
+     * @param db_file the first data file
+     * @param data_files additional data files, could be in different directories.
+     * it's ignored when we are opening an existing database
+     * @param stripe_size number of contiguous pages stored in a single file
+     * @param direct_io whether to open data files with O_DIRECT. it will be turned off
+     * when file system doesn't support it
+     * @param has_metadata whether metadata of page allocator exists. database is new only
+     * if neither it nor the descriptor exists, and db file is empty
+     */
+    Tablespace(const std::string &db_file,
+               const std::vector<std::string> &data_files,
+               uint32_t stripe_size,
+               bool direct_io,
+               bool has_metadata);
+
+    /**
+     * @brief Destroy the Tablespace object, close the data files
+     */
+    ~Tablespace();
+
+    /**
+     * @brief
+     * find where the page is stored
+     * @param page_id
+     * @param offset byte offset of the page within the data file
+     * @return int file descriptor of the data file
+     */
+    inline int Locate(page_id_t page_id, off_t *offset) const {
+        page_id_t stripe = page_id / stripe_size_;
+        page_id_t file_num = static_cast<page_id_t>(fds_.size());
+        page_id_t local_page_id = stripe / file_num * stripe_size_ + page_id % stripe_size_;
+        // always compute offset in 64-bit, it would overflow once data file is larger than 2GiB
+        *offset = static_cast<off_t>(local_page_id) * PAGE_SIZE;
+        return fds_[stripe % file_num];
+    }
+
+    /**
+     * @brief
+     * number of pages that are stored contiguously in the same file starting from page_id
+     */
+    inline page_id_t GetRunLength(page_id_t page_id) const {
+        return fds_.size() == 1 ? INT32_MAX - page_id : stripe_size_ - page_id % stripe_size_;
+    }
+
+    inline size_t GetFileNum() const {
+        return fds_.size();
+    }
+
+    inline int GetFd(size_t idx) const {
+        return fds_[idx];
+    }
+
+    inline const std::string &GetFileName(size_t idx) const {
+        return file_names_[idx];
+    }
+
+    inline uint32_t GetStripeSize() const {
+        return stripe_size_;
+    }
+
+    inline bool IsDirectIO() const {
+        return direct_io_;
+    }
+
+    /**
+     * @brief
+     * whether we are creating a new database, i.e. there was neither descriptor, allocator
+     * metadata nor pages in db file
+     */
+    inline bool IsNew() const {
+        return is_new_;
+    }
+
+    /**
+     * @brief
+     * read the layout persisted in descriptor file
+     * @param descriptor_name path of descriptor file
+     * @param stripe_size stripe size in pages
+     * @param file_names data files, the first one is the db file it's created with
+     * @return false if there isn't a valid one
+     */
+    static bool ReadDescriptor(const std::string &descriptor_name, uint32_t *stripe_size,
+                               std::vector<std::string> *file_names);
+
+private:
+    // read the layout from descriptor file, return false if there isn't one
+    bool LoadDescriptor();
+
+    void WriteDescriptor();
+
+    // open a data file, O_DIRECT might be turned off
+    int OpenFile(const std::string &filename, bool truncate);
+
+    std::string descriptor_name_;
+    std::vector<std::string> file_names_;
+    std::vector<int> fds_;
+    uint32_t stripe_size_;
+    bool direct_io_;
+    bool is_new_{false};
+};
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * @file thread_pool_io_engine.h
+ * @author sheep
+ * @brief io engine that performs blocking I/O in a pool of worker threads
+ * @version 0.1
+ * @date 2022-06-05
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef THREAD_POOL_IO_ENGINE_H
+#define THREAD_POOL_IO_ENGINE_H
+
+#include "storage/disk/io_engine.h"
+
+#include <deque>
+#include <thread>
+
+namespace TinyDB {
+
+/**
+ * @brief
+ * fallback io engine for kernels without io_uring.
+ * requests are queued and served by worker threads using pread/pwrite,
+ * so the number of in-flight requests is bounded by the number of workers
+ */
+class ThreadPoolIOEngine : public IOEngine {
+public:
+    /**
+     * @brief Construct a new ThreadPoolIOEngine
+     * @param worker_num number of I/O threads
+     */
+    explicit ThreadPoolIOEngine(uint32_t worker_num);
+
+    ~ThreadPoolIOEngine() override;
+
+    void Submit(const std::vector<IORequest> &requests) override;
+
+    IOEngineType GetType() const override {
+        return IOEngineType::THREAD_POOL;
+    }
+
+private:
+    void WorkerThread();
+
+    std::deque<IORequest> queue_;
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::vector<std::thread *> worker_list_;
+    bool enable_running_{true};
+};
+
+}
+
+#endif
@@ -17,6 +17,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "storage/index/b_plus_tree_iterator.h"
 
+#include <atomic>
 #include <string>
 #include <unordered_set>
 #include <deque>
@@ -161,6 +162,18 @@ private:
      */
     std::tuple<Page *, int> FindHelper(const KeyType &key);
 
+    /**
+     * @brief
+     * GetValue without latches. pages are read under optimistic latch and validated
+     * hand over hand, so hot inner nodes are never written by readers. it gives up
+     * when a writer gets in our way, or a page is not cached
+     * @param key
+     * @param result
+     * @param found whether key exists
+     * @return false when we should retry, or fall back to latch crabbing
+     */
+    bool OptimisticGetValue(const KeyType &key, std::vector<ValueType> *result, bool *found);
+
     /**
      * @brief 
      * Insert kv pair into an empty tree.
@@ -264,8 +277,9 @@ private:
 
     // index name
     std::string index_name_;
-    // id of root page
-    page_id_t root_page_id_;
+    // id of root page. it's modified with root latch held, optimistic readers
+    // read it without latch
+    std::atomic<page_id_t> root_page_id_;
     // buffer pool manager
     BufferPoolManager *buffer_pool_manager_;
     // comparator used to compare the key
@@ -14,6 +14,7 @@
 
 #include "storage/page/b_plus_tree_leaf_page.h"
 #include "storage/index/index_iterator.h"
+#include "buffer/read_ahead.h"
 
 namespace TinyDB {
 
@@ -61,6 +62,8 @@ private:
     BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
     // debug
     int retry_cnt_;
+    // prefetch the following leaves
+    ReadAheadWindow read_ahead_;
 };
 
 }
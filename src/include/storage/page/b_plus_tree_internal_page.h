@@ -73,6 +73,21 @@ public:
      */
     ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
 
+    /**
+     * @brief
+     * Lookup without the latch, page might be modified while we are reading it.
+     * everything read from the page is validated against the version before we act on it,
+     * e.g. a torn key could lead comparator far away from the page
+     * @param key
+     * @param value the child pointer
+     * @param comparator
+     * @param page the page we are reading
+     * @param version snapshot from Page::TryOptimisticRLatch
+     * @return false when validation failed, value is meaningless then
+     */
+    bool OptimisticLookup(const KeyType &key, ValueType *value, const KeyComparator &comparator,
+                          Page *page, uint64_t version) const;
+
     // insertion related
 
     /**
@@ -110,6 +110,20 @@ public:
      */
     bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
 
+    /**
+     * @brief
+     * Lookup without the latch, see BPlusTreeInternalPage::OptimisticLookup
+     * @param key
+     * @param value
+     * @param found whether key exists
+     * @param comparator
+     * @param page the page we are reading
+     * @param version snapshot from Page::TryOptimisticRLatch
+     * @return false when validation failed, value and found are meaningless then
+     */
+    bool OptimisticLookup(const KeyType &key, ValueType *value, bool *found, const KeyComparator &comparator,
+                          Page *page, uint64_t version) const;
+
     /**
      * @brief 
      * find the key & value pair corresponding "key" and delete it.
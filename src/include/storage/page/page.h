@@ -13,10 +13,14 @@
 #ifndef PAGE_H
 #define PAGE_H
 
+#include <atomic>
+#include <cstdint>
 #include <cstring>
+#include <new>
 #include <assert.h>
 
 #include "common/config.h"
+#include "common/macros.h"
 #include "common/rwlatch.h"
 
 namespace TinyDB {
@@ -27,12 +31,28 @@ namespace TinyDB {
  * we stored 8 byte metadata in the header,
  * first 4 byte is page id,
  * second 4 byte is lsn. i.e. last sequence number, used for crash recovery
+ *
+ * Page itself is the frame descriptor, data lives elsewhere. frames of buffer pool point
+ * into the frame arena of the pool, so that metadata of all the frames is packed together.
+ * descriptor is padded to cache lines, and the fields touched on every pin come first.
+ * a standalone page, e.g. an I/O buffer, owns its data
  */
-class Page {
-    friend class BufferPoolManager;
+class alignas(CACHE_LINE_SIZE) Page {
+    friend class BufferPoolManagerInstance;
 public:
-    Page() { ZeroData(); }
-    ~Page() = default;
+    Page()
+        : owns_data_(true),
+          data_(static_cast<char *>(::operator new[](PAGE_SIZE, std::align_val_t(PAGE_ALIGNMENT)))) {
+        ZeroData();
+    }
+
+    ~Page() {
+        if (owns_data_) {
+            ::operator delete[](data_, std::align_val_t(PAGE_ALIGNMENT));
+        }
+    }
+
+    DISALLOW_COPY(Page);
 
     /**
      * @brief get the data array stored in this page
@@ -55,7 +75,7 @@ public:
      * @return int
      */
     inline int GetPinCount() {
-        return pin_count_;
+        return pin_count_.load(std::memory_order_relaxed) & PIN_COUNT_MASK;
     }
 
     /**
@@ -65,14 +85,16 @@ public:
      * @return bool
      */
     inline bool IsDirty() {
-        return is_dirty_;
+        return is_dirty_.load(std::memory_order_relaxed);
     }
 
     inline void WLatch() {
         rwlatch_.WLock();
+        BeginWrite();
     }
 
     inline void WUnlatch() {
+        EndWrite();
         rwlatch_.WUnlock();
     }
 
@@ -85,33 +107,96 @@ public:
     }
 
     inline bool TryWLatch() {
-        return rwlatch_.TryWLock();
+        if (!rwlatch_.TryWLock()) {
+            return false;
+        }
+        BeginWrite();
+        return true;
     }
 
     inline bool TryRLatch() {
         return rwlatch_.TryRLock();
     }
 
+    /**
+     * @brief
+     * optimistic read latch, it writes nothing shared, so readers of a hot page won't bounce
+     * the cache line between cores. snapshot the version, read the page, then validate the
+     * snapshot. anything read in between might be torn by a concurrent writer, and it's
+     * only trustworthy after validation succeeds. caller should keep the page pinned
+     * @param version snapshot of the version
+     * @return false when a writer is holding the latch
+     */
+    inline bool TryOptimisticRLatch(uint64_t *version) {
+        *version = version_.load(std::memory_order_acquire);
+        return (*version & 1) == 0;
+    }
+
+    /**
+     * @brief
+     * check that no writer has latched the page since the snapshot was taken
+     * @param version snapshot from TryOptimisticRLatch
+     * @return true when everything read since the snapshot is consistent
+     */
+    inline bool ValidateOptimisticRLatch(uint64_t version) {
+        // reads of the page can't sink below the fence
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version_.load(std::memory_order_relaxed) == version;
+    }
+
 private:
+    // pin count shares the word with the state of frame, so buffer pool manager could
+    // pin a page and check the state with a single atomic instruction.
+    // frame is being loaded, evicted or deleted, it can't be pinned
+    static constexpr int FRAME_BUSY = 1 << 30;
+    // page is deleted while being pinned, the last one unpinning it should drop it
+    static constexpr int FRAME_DELETE_PENDING = 1 << 29;
+    static constexpr int PIN_COUNT_MASK = FRAME_DELETE_PENDING - 1;
+
+    /**
+     * @brief
+     * frame of buffer pool, data is not owned by us
+     */
+    explicit Page(char *data)
+        : owns_data_(false), data_(data) {}
+
+    // version is odd while the page is write latched. we are the only writer here,
+    // so plain load and store are enough
+    inline void BeginWrite() {
+        version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        // writes to the page can't float above the odd version
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    inline void EndWrite() {
+        version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
     // zero out the data
     inline void ZeroData() {
         memset(data_, 0, PAGE_SIZE);
     }
 
-    // the actual data stored in a page
-    // normally, we will reinterpret this data
-    char data_[PAGE_SIZE]{};
+    // pin count of this page and frame state flags, used in buffer pool manager
+    std::atomic<int> pin_count_{0};
     // the unique identifier of this page
-    page_id_t page_id_{INVALID_PAGE_ID};
-    // pin count of this page, used in buffer pool manager
-    int pin_count_{0};
+    std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
     // whether we have modified this page after
     // we bring it from disk to memory
     // if it's true, then we need to flush the data to disk
     // before eviciting this page
-    bool is_dirty_{false};
+    std::atomic<bool> is_dirty_{false};
+    bool owns_data_;
+    // the actual data stored in a page
+    // normally, we will reinterpret this data.
+    // it's aligned so that it can be handed to kernel directly with O_DIRECT
+    char *data_;
     // page latch. used to protect the content
     ReaderWriterLatch rwlatch_;
+    // bumped when writer latches and unlatches the page, see TryOptimisticRLatch.
+    // it gets its own cache line, away from pin count and the latch, which are written
+    // by everyone else
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> version_{0};
 };
 
 }
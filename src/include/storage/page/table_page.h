@@ -153,6 +153,19 @@ public:
      */
     bool GetTuple(const RID &rid, Tuple *tuple);
 
+    /**
+     * @brief
+     * GetTuple without the latch. page might be modified while we are reading, so slot and
+     * tuple are validated against the version before we trust them
+     * @param rid rid of tuple
+     * @param tuple tuple slot
+     * @param found whether the tuple exists and is not deleted
+     * @param page the page we are reading
+     * @param version snapshot from Page::TryOptimisticRLatch
+     * @return false when validation failed, tuple and found are meaningless then
+     */
+    bool OptimisticGetTuple(const RID &rid, Tuple *tuple, bool *found, Page *page, uint64_t version);
+
     /**
      * @brief 
      * Get the first rid from current page. regard less whether tuple is mark deleted
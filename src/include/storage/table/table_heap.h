@@ -52,8 +52,9 @@ public:
      */
     TableHeap(BufferPoolManager *buffer_pool_manager, TransactionContext *txn = nullptr, LogManager *log_manager = nullptr) {
         page_id_t first_page_id = INVALID_PAGE_ID;
-        auto new_page = reinterpret_cast<TablePage *> (buffer_pool_manager->NewPage(&first_page_id));
-        TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(new_page != nullptr, "");
+        auto page = buffer_pool_manager->NewPage(&first_page_id);
+        TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(page != nullptr, "");
+        auto new_page = reinterpret_cast<TablePage *> (page->GetData());
 
         new_page->Init(first_page_id, PAGE_SIZE, INVALID_PAGE_ID, txn, log_manager);
         buffer_pool_manager->UnpinPage(first_page_id, true);
@@ -74,8 +75,9 @@ public:
      */
     static TableHeap *CreateNewTableHeap(BufferPoolManager *buffer_pool_manager, TransactionContext *txn = nullptr, LogManager *log_manager = nullptr) {
         page_id_t first_page_id = INVALID_PAGE_ID;
-        auto new_page = reinterpret_cast<TablePage *> (buffer_pool_manager->NewPage(&first_page_id));
-        TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(new_page != nullptr, "");
+        auto page = buffer_pool_manager->NewPage(&first_page_id);
+        TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(page != nullptr, "");
+        auto new_page = reinterpret_cast<TablePage *> (page->GetData());
         
         new_page->Init(first_page_id, PAGE_SIZE, INVALID_PAGE_ID, txn, log_manager);
         buffer_pool_manager->UnpinPage(first_page_id, true);
@@ -91,9 +93,13 @@ public:
      * @param txn txn context
      * @param callback callback function to be called after the insertion is done. this is used for 
      * 2PL concurrency control protocols since we need to acquire the lock right after we inserted a new tuple
+     * @param strategy pages are read and created through this ring, used by bulk inserts
+     * so that walking the page list doesn't flush the buffer pool
      * @return true when insertion succeed
      */
-    Result<> InsertTuple(const Tuple &tuple, RID *rid, TransactionContext *txn = nullptr, const std::function<void(const RID &)> &callback = nullptr);
+    Result<> InsertTuple(const Tuple &tuple, RID *rid, TransactionContext *txn = nullptr,
+                         const std::function<void(const RID &)> &callback = nullptr,
+                         BufferAccessStrategy *strategy = nullptr);
 
     /**
      * @brief 
@@ -137,9 +143,10 @@ public:
      * read the tuple
      * @param rid target tuple rid
      * @param tuple tuple value
+     * @param strategy page is read through this ring if it's not cached
      * @return true when reading succeed
      */
-    Result<> GetTuple(const RID &rid, Tuple *tuple);
+    Result<> GetTuple(const RID &rid, Tuple *tuple, BufferAccessStrategy *strategy = nullptr);
 
     inline page_id_t GetFirstPageId() const {
         return first_page_id_;
@@ -148,9 +155,11 @@ public:
     /**
      * @brief 
      * get the begin iterator of this table
+     * @param strategy iterator reads pages through this ring, e.g. a BULK_READ strategy
+     * for a full table scan. caller owns it, it should outlive the iterator
      * @return TableIterator 
      */
-    TableIterator Begin();
+    TableIterator Begin(BufferAccessStrategy *strategy = nullptr);
     
     /**
      * @brief 
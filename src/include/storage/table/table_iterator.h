@@ -14,6 +14,7 @@
 
 #include "storage/page/table_page.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/read_ahead.h"
 
 namespace TinyDB {
 
@@ -36,28 +37,36 @@ public:
     TableIterator()
         : table_heap_(nullptr),
           rid_(RID()),
-          tuple_(Tuple()) {}
+          tuple_(Tuple()),
+          strategy_(nullptr) {}
 
     /**
      * @brief
      * Initialize table iterator based on table heap
      * @param table_heap 
      * @param rid 
+     * @param strategy pages are read through this ring, it should outlive the iterator.
+     * nullptr means pages are read into the shared pool
      */
-    TableIterator(TableHeap *table_heap, RID rid)
+    TableIterator(TableHeap *table_heap, RID rid, BufferAccessStrategy *strategy = nullptr)
         : table_heap_(table_heap),
           rid_(rid),
-          tuple_(Tuple()) {}
+          tuple_(Tuple()),
+          strategy_(strategy) {}
 
     TableIterator(const TableIterator &other)
         : table_heap_(other.table_heap_),
           rid_(other.rid_),
-          tuple_(other.tuple_) {}
+          tuple_(other.tuple_),
+          strategy_(other.strategy_),
+          read_ahead_(other.read_ahead_) {}
 
     inline void Swap(TableIterator &iter) {
         std::swap(iter.rid_, rid_);
         std::swap(iter.table_heap_, table_heap_);
         std::swap(iter.tuple_, tuple_);
+        std::swap(iter.strategy_, strategy_);
+        std::swap(iter.read_ahead_, read_ahead_);
     }
 
     inline bool operator==(const TableIterator &iter) const {
@@ -80,6 +89,8 @@ public:
         table_heap_ = other.table_heap_;
         rid_ = other.rid_;
         tuple_ = other.tuple_;
+        strategy_ = other.strategy_;
+        read_ahead_ = other.read_ahead_;
         return *this;
     }
 
@@ -116,6 +127,10 @@ private:
     TableHeap *table_heap_;
     RID rid_;
     Tuple tuple_;
+    // not owned by us, copies of the iterator share it
+    BufferAccessStrategy *strategy_;
+    // pages following the current one are prefetched as we go
+    ReadAheadWindow read_ahead_;
 };
 
 }
@@ -0,0 +1,484 @@
+/**
+ * @file compressed_disk_manager.cpp
+ * @author sheep
+ * @brief implementation of compressed disk manager
+ * @version 0.1
+ * @date 2022-06-14
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/compressed_disk_manager.h"
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/lz_codec.h"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace TinyDB {
+
+namespace {
+
+// positional read, keep reading until we get all of them or reach the end of file
+ssize_t ReadAt(int fd, char *data, size_t size, off_t offset) {
+    size_t read_count = 0;
+    while (read_count < size) {
+        ssize_t rc = pread(fd, data + read_count, size - read_count, offset + read_count);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (rc == 0) {
+            break;
+        }
+        read_count += rc;
+    }
+    return read_count;
+}
+
+bool WriteAt(int fd, const char *data, size_t size, off_t offset) {
+    size_t write_count = 0;
+    while (write_count < size) {
+        ssize_t rc = pwrite(fd, data + write_count, size - write_count, offset + write_count);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        write_count += rc;
+    }
+    return true;
+}
+
+int OpenFile(const std::string &filename, int flags) {
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | flags, 0644);
+    if (fd < 0) {
+        THROW_IO_EXCEPTION(std::string("failed to open ") + filename + ", " + strerror(errno));
+    }
+    return fd;
+}
+
+int64_t GetFileSize(int fd) {
+    struct stat stat_buf;
+    if (fstat(fd, &stat_buf) != 0) {
+        THROW_IO_EXCEPTION(std::string("failed to stat file, ") + strerror(errno));
+    }
+    return static_cast<int64_t>(stat_buf.st_size);
+}
+
+}
+
+CompressedDiskManager::CompressedDiskManager(const std::string &filename)
+    : db_name_(filename) {
+    auto n = db_name_.rfind('.');
+    if (n == std::string::npos) {
+        THROW_IO_EXCEPTION("Wrong File Format");
+    }
+    map_name_ = GetDatabaseFileName(db_name_, ".pagemap");
+    meta_name_ = GetDatabaseFileName(db_name_, ".meta");
+    log_name_ = GetDatabaseFileName(db_name_, ".log");
+
+    db_fd_ = OpenFile(db_name_, 0);
+    map_fd_ = OpenFile(map_name_, 0);
+    meta_fd_ = OpenFile(meta_name_, 0);
+    log_fd_ = OpenFile(log_name_, O_APPEND);
+
+    // page ids are not backed by data file directly, there is nothing to extend
+    allocator_ = std::make_unique<PageAllocator>(meta_fd_, EXTENT_SIZE, [](page_id_t, page_id_t) {});
+
+    // page map and metadata are created together, database is new only if neither exists.
+    // once it exists, never reformat it. we would lose the pages we can't locate
+    int64_t db_size = GetFileSize(db_fd_);
+    if (GetFileSize(map_fd_) == 0 && GetFileSize(meta_fd_) == 0) {
+        if (db_size > 0) {
+            THROW_IO_EXCEPTION("page map and metadata of " + db_name_ + " are missing");
+        }
+        char header_buffer[PAGE_MAP_HEADER_SIZE];
+        memset(header_buffer, 0, sizeof(header_buffer));
+        PageMapHeader header{PAGE_MAP_MAGIC, PAGE_MAP_VERSION, PAGE_SIZE, SLOT_UNIT};
+        memcpy(header_buffer, &header, sizeof(header));
+        if (!WriteAt(map_fd_, header_buffer, sizeof(header_buffer), 0)) {
+            THROW_IO_EXCEPTION(std::string("failed to write page map, ") + strerror(errno));
+        }
+        allocator_->Format(0);
+        return;
+    }
+
+    if (!LoadPageMap()) {
+        THROW_IO_EXCEPTION("page map of " + db_name_ + " is missing or corrupted");
+    }
+    if (!allocator_->Load()) {
+        THROW_IO_EXCEPTION("metadata of " + db_name_ + " is missing or corrupted");
+    }
+    if (static_cast<int64_t>(data_end_) > db_size) {
+        THROW_IO_EXCEPTION("page map of " + db_name_ + " refers to data beyond the end of file");
+    }
+    // slot is dropped before the page is deallocated, mapped pages are always allocated
+    for (size_t i = 0; i < page_map_.size(); i++) {
+        if (page_map_[i].length_ != 0 && !allocator_->IsAllocated(static_cast<page_id_t>(i))) {
+            THROW_IO_EXCEPTION("page map of " + db_name_ + " doesn't match metadata, page "
+                + std::to_string(i) + " is not allocated");
+        }
+    }
+}
+
+CompressedDiskManager::~CompressedDiskManager() {
+    allocator_.reset();
+    for (int fd : {db_fd_, map_fd_, meta_fd_, log_fd_}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+bool CompressedDiskManager::LoadPageMap() {
+    struct stat stat_buf;
+    if (fstat(map_fd_, &stat_buf) != 0 || stat_buf.st_size < PAGE_MAP_HEADER_SIZE) {
+        return false;
+    }
+    PageMapHeader header;
+    if (ReadAt(map_fd_, reinterpret_cast<char *>(&header), sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+        || header.magic_ != PAGE_MAP_MAGIC || header.version_ != PAGE_MAP_VERSION) {
+        return false;
+    }
+    if (header.page_size_ != PAGE_SIZE || header.slot_unit_ != SLOT_UNIT) {
+        LOG_ERROR("page map of %s is created with page size %u, slot unit %u",
+            db_name_.c_str(), header.page_size_, header.slot_unit_);
+        return false;
+    }
+
+    size_t entry_num = (stat_buf.st_size - PAGE_MAP_HEADER_SIZE) / sizeof(PageLocation);
+    page_map_.resize(entry_num);
+    ssize_t bytes = entry_num * sizeof(PageLocation);
+    if (ReadAt(map_fd_, reinterpret_cast<char *>(page_map_.data()), bytes, PAGE_MAP_HEADER_SIZE) != bytes) {
+        return false;
+    }
+
+    // everything between the slots is free
+    std::vector<std::pair<uint64_t, uint64_t>> slots;
+    for (const auto &location : page_map_) {
+        if (location.length_ != 0) {
+            slots.emplace_back(location.offset_, RoundUp(location.length_));
+        }
+    }
+    std::sort(slots.begin(), slots.end());
+    for (const auto &[offset, length] : slots) {
+        if (offset < data_end_) {
+            LOG_ERROR("slots overlap within %s, offset %lu", db_name_.c_str(), static_cast<unsigned long>(offset));
+            return false;
+        }
+        if (offset > data_end_) {
+            InsertFreeSlot(data_end_, offset - data_end_);
+        }
+        data_end_ = offset + length;
+        stored_bytes_ += length;
+    }
+    return true;
+}
+
+void CompressedDiskManager::WritePageMapEntry(page_id_t page_id) {
+    off_t offset = PAGE_MAP_HEADER_SIZE + static_cast<off_t>(page_id) * sizeof(PageLocation);
+    if (!WriteAt(map_fd_, reinterpret_cast<const char *>(&page_map_[page_id]), sizeof(PageLocation), offset)) {
+        LOG_ERROR("I/O error while writing page map of page %d, %s", page_id, strerror(errno));
+    }
+}
+
+void CompressedDiskManager::WritePage(page_id_t pageId, const char *data) {
+    auto start = std::chrono::steady_clock::now();
+
+    // it's only worth compressing when we could save at least one unit
+    char buffer[PAGE_SIZE];
+    const char *payload = buffer;
+    uint32_t length = LZCodec::Compress(data, PAGE_SIZE, buffer, PAGE_SIZE - SLOT_UNIT);
+    uint32_t compressed = 1;
+    if (length == 0) {
+        payload = data;
+        length = PAGE_SIZE;
+        compressed = 0;
+    }
+    uint64_t slot_length = RoundUp(length);
+
+    uint64_t offset;
+    {
+        std::unique_lock<std::mutex> lock(latch_);
+        BeginPageIO(&lock, pageId, true);
+        if (static_cast<size_t>(pageId) >= page_map_.size()) {
+            page_map_.resize(pageId + 1);
+        }
+        const auto &location = page_map_[pageId];
+        if (location.length_ != 0 && RoundUp(location.length_) == slot_length) {
+            offset = location.offset_;
+        } else {
+            offset = AllocateSlot(slot_length);
+        }
+    }
+
+    if (!WriteAt(db_fd_, payload, length, offset)) {
+        LOG_ERROR("I/O error while writing page %d, %s", pageId, strerror(errno));
+        std::lock_guard<std::mutex> guard(latch_);
+        if (page_map_[pageId].offset_ != offset || page_map_[pageId].length_ == 0) {
+            FreeSlot(offset, slot_length);
+        }
+        EndPageIO(pageId, true);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        auto &location = page_map_[pageId];
+        if (location.length_ != 0 && location.offset_ != offset) {
+            // page is moved, old slot could be reused. nobody is reading it since we are
+            // the only one doing I/O on this page
+            stored_bytes_ -= RoundUp(location.length_);
+            FreeSlot(location.offset_, RoundUp(location.length_));
+        }
+        if (location.length_ == 0 || location.offset_ != offset) {
+            stored_bytes_ += slot_length;
+        }
+        location = PageLocation{offset, length, compressed};
+        WritePageMapEntry(pageId);
+        EndPageIO(pageId, true);
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    stats_.page_write_.Record(length, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+void CompressedDiskManager::ReadPage(page_id_t pageId, char *data) {
+    auto start = std::chrono::steady_clock::now();
+
+    PageLocation location;
+    {
+        std::unique_lock<std::mutex> lock(latch_);
+        BeginPageIO(&lock, pageId, false);
+        if (static_cast<size_t>(pageId) < page_map_.size()) {
+            location = page_map_[pageId];
+        }
+    }
+
+    if (location.length_ == 0) {
+        // page has never been written
+        memset(data, 0, PAGE_SIZE);
+    } else if (!location.compressed_) {
+        if (ReadAt(db_fd_, data, PAGE_SIZE, location.offset_) != PAGE_SIZE) {
+            LOG_ERROR("I/O error while reading page %d", pageId);
+            memset(data, 0, PAGE_SIZE);
+        }
+    } else {
+        char buffer[PAGE_SIZE];
+        if (ReadAt(db_fd_, buffer, location.length_, location.offset_) != location.length_
+            || LZCodec::Decompress(buffer, location.length_, data, PAGE_SIZE) != PAGE_SIZE) {
+            LOG_ERROR("failed to read compressed page %d", pageId);
+            memset(data, 0, PAGE_SIZE);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(latch_);
+        EndPageIO(pageId, false);
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    stats_.page_read_.Record(location.length_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+void CompressedDiskManager::Sync() {
+    IOTimer timer(&stats_.sync_, 0);
+    for (int fd : {db_fd_, map_fd_, meta_fd_}) {
+        if (fdatasync(fd) != 0) {
+            LOG_ERROR("failed to sync %s, %s", db_name_.c_str(), strerror(errno));
+        }
+    }
+}
+
+page_id_t CompressedDiskManager::AllocatePage(page_id_t hint) {
+    // page without slot reads as zero, nothing to write
+    page_id_t new_page_id = allocator_->AllocatePage(hint);
+
+    // debug purpose
+    allocate_count_++;
+
+    return new_page_id;
+}
+
+page_id_t CompressedDiskManager::AllocateExtent(uint32_t count) {
+    page_id_t first_page_id = allocator_->AllocateExtent(count);
+
+    // debug purpose
+    allocate_count_ += count;
+
+    return first_page_id;
+}
+
+void CompressedDiskManager::DeallocatePage(page_id_t page_id) {
+    if (!allocator_->IsAllocated(page_id)) {
+        LOG_WARN("deallocating a free page %d", page_id);
+        return;
+    }
+
+    // drop the slot first, so the page reads as zero when it's handed out again
+    {
+        std::unique_lock<std::mutex> lock(latch_);
+        BeginPageIO(&lock, page_id, true);
+        if (static_cast<size_t>(page_id) < page_map_.size() && page_map_[page_id].length_ != 0) {
+            auto &location = page_map_[page_id];
+            stored_bytes_ -= RoundUp(location.length_);
+            FreeSlot(location.offset_, RoundUp(location.length_));
+            location = PageLocation{};
+            WritePageMapEntry(page_id);
+        }
+        EndPageIO(page_id, true);
+    }
+    allocator_->DeallocatePage(page_id);
+
+    // debug purpose
+    deallocate_count_++;
+}
+
+void CompressedDiskManager::BeginPageIO(std::unique_lock<std::mutex> *lock, page_id_t page_id, bool write) {
+    page_io_cv_.wait(*lock, [&]() {
+        auto it = page_io_.find(page_id);
+        if (it == page_io_.end()) {
+            return true;
+        }
+        return !it->second.writing_ && (!write || it->second.reader_count_ == 0);
+    });
+    auto &state = page_io_[page_id];
+    if (write) {
+        state.writing_ = true;
+    } else {
+        state.reader_count_++;
+    }
+}
+
+void CompressedDiskManager::EndPageIO(page_id_t page_id, bool write) {
+    auto it = page_io_.find(page_id);
+    if (write) {
+        it->second.writing_ = false;
+    } else {
+        it->second.reader_count_--;
+    }
+    if (!it->second.writing_ && it->second.reader_count_ == 0) {
+        page_io_.erase(it);
+        page_io_cv_.notify_all();
+    }
+}
+
+uint64_t CompressedDiskManager::AllocateSlot(uint64_t length) {
+    // best fit, the rest of the slot stays free
+    auto it = free_slots_by_length_.lower_bound({length, 0});
+    if (it == free_slots_by_length_.end()) {
+        uint64_t offset = data_end_;
+        data_end_ += length;
+        return offset;
+    }
+    auto [slot_length, offset] = *it;
+    EraseFreeSlot(offset, slot_length);
+    if (slot_length > length) {
+        InsertFreeSlot(offset + length, slot_length - length);
+    }
+    return offset;
+}
+
+void CompressedDiskManager::FreeSlot(uint64_t offset, uint64_t length) {
+    // merge with the following one
+    auto next = free_slots_.find(offset + length);
+    if (next != free_slots_.end()) {
+        length += next->second;
+        EraseFreeSlot(next->first, next->second);
+    }
+    // and the previous one
+    auto prev = free_slots_.lower_bound(offset);
+    if (prev != free_slots_.begin()) {
+        --prev;
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            length += prev->second;
+            EraseFreeSlot(prev->first, prev->second);
+        }
+    }
+
+    if (offset + length == data_end_) {
+        // it's the tail, just give it back to data file
+        data_end_ = offset;
+        return;
+    }
+    InsertFreeSlot(offset, length);
+}
+
+void CompressedDiskManager::InsertFreeSlot(uint64_t offset, uint64_t length) {
+    free_slots_[offset] = length;
+    free_slots_by_length_.emplace(length, offset);
+}
+
+void CompressedDiskManager::EraseFreeSlot(uint64_t offset, uint64_t length) {
+    free_slots_.erase(offset);
+    free_slots_by_length_.erase({length, offset});
+}
+
+uint64_t CompressedDiskManager::GetStoredBytes() {
+    std::lock_guard<std::mutex> guard(latch_);
+    return stored_bytes_;
+}
+
+uint64_t CompressedDiskManager::GetDataFileSize() {
+    struct stat stat_buf;
+    return fstat(db_fd_, &stat_buf) == 0 ? stat_buf.st_size : 0;
+}
+
+bool CompressedDiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+    auto t1 = std::chrono::steady_clock::now();
+
+    struct stat stat_buf;
+    if (fstat(log_fd_, &stat_buf) != 0 || offset >= stat_buf.st_size) {
+        return false;
+    }
+    IOTimer timer(&stats_.log_read_, size);
+    ssize_t read_count = ReadAt(log_fd_, log_data, size, offset);
+    if (read_count < 0) {
+        LOG_ERROR("I/O error while reading log");
+        return false;
+    }
+    // pad with zero
+    memset(log_data + read_count, 0, size - read_count);
+
+    auto t2 = std::chrono::steady_clock::now();
+    log_read_time_ += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+    return true;
+}
+
+void CompressedDiskManager::WriteLog(char *log_data, int size) {
+    auto t1 = std::chrono::steady_clock::now();
+    if (size == 0) {
+        return;
+    }
+    IOTimer timer(&stats_.log_write_, size);
+
+    // log is not compressed, just append it
+    int write_count = 0;
+    while (write_count < size) {
+        ssize_t rc = write(log_fd_, log_data + write_count, size - write_count);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("I/O error while writing log, %s", strerror(errno));
+            return;
+        }
+        write_count += rc;
+    }
+
+    auto t2 = std::chrono::steady_clock::now();
+    log_write_time_ += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+}
+
+}
@@ -0,0 +1,499 @@
+/**
+ * @file file_disk_manager.cpp
+ * @author sheep
+ * @brief 
+ * @version 0.1
+ * @date 2021-10-20
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#ifndef FILE_DISK_MANAGER_CPP
+#define FILE_DISK_MANAGER_CPP
+
+#include <string>
+#include <fstream>
+#include <exception>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <climits>
+#include <algorithm>
+#include <numeric>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <assert.h>
+
+#include "common/logger.h"
+#include "common/macros.h"
+#include "common/exception.h"
+#include "storage/disk/file_disk_manager.h"
+
+namespace TinyDB {
+
+static_assert(sizeof(off_t) == 8, "64-bit file offset is required, compile with _FILE_OFFSET_BITS=64");
+
+FileDiskManager::FileDiskManager(const std::string &filename,
+                                 IOEngineType io_engine_type,
+                                 bool direct_io,
+                                 const std::vector<std::string> &data_files)
+    : db_name_(filename), direct_io_(direct_io), io_engine_type_(io_engine_type) {
+    // generate log name
+    auto n = db_name_.rfind('.');
+    if (n == std::string::npos) {
+        THROW_IO_EXCEPTION("Wrong File Format");
+        return;
+    }
+
+    log_name_ = GetDatabaseFileName(db_name_, ".log");
+    meta_name_ = GetDatabaseFileName(db_name_, ".meta");
+
+    // open log file stream
+    log_file_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
+    if (!log_file_.is_open()) {
+        // log is not opended, which means the file doesn't exist
+        // then we create it
+        log_file_.clear();
+        // std::ios::in will fail us when the file is not exist 
+        log_file_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
+        log_file_.close();
+        // reopen it with original mode
+        log_file_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
+        if (!log_file_.is_open()) {
+            THROW_IO_EXCEPTION(
+                std::string("failed to open log file, filename: %s", filename.c_str()));
+        }
+    }
+
+    // open data files. metadata is checked before we create it
+    bool has_metadata = GetFileSize(meta_name_) > 0;
+    tablespace_ = std::make_unique<Tablespace>(db_name_, data_files, EXTENT_SIZE, direct_io_, has_metadata);
+    direct_io_ = tablespace_->IsDirectIO();
+
+    // open metadata file
+    meta_fd_ = open(meta_name_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (meta_fd_ < 0) {
+        THROW_IO_EXCEPTION(
+            std::string("failed to open metadata file, filename: ") + meta_name_ + ", " + strerror(errno));
+    }
+
+    allocator_ = std::make_unique<PageAllocator>(meta_fd_, EXTENT_SIZE, [this](page_id_t begin, page_id_t end) {
+        ExtendFile(begin, end);
+    });
+    int64_t db_size = GetFileSize(db_name_);
+    if (tablespace_->IsNew()) {
+        allocator_->Format(0);
+    } else if (!allocator_->Load()) {
+        // reformatting would free pages that are in use
+        if (has_metadata) {
+            THROW_IO_EXCEPTION("invalid metadata file " + meta_name_);
+        }
+        for (size_t i = 1; i < tablespace_->GetFileNum(); i++) {
+            if (GetFileSize(tablespace_->GetFileName(i)) > 0) {
+                THROW_IO_EXCEPTION("metadata file " + meta_name_ + " of striped database is missing");
+            }
+        }
+        // db file created before we have metadata, treat all existing pages as allocated
+        allocator_->Format((db_size + PAGE_SIZE - 1) / PAGE_SIZE);
+    }
+
+    buffer_used_ = nullptr;
+}
+
+FileDiskManager::~FileDiskManager() {
+    // wait for all in-flight requests before closing the file
+    io_engine_.reset();
+    allocator_.reset();
+
+    if (meta_fd_ >= 0) {
+        close(meta_fd_);
+        meta_fd_ = -1;
+    }
+
+    tablespace_.reset();
+}
+
+page_id_t FileDiskManager::AllocatePage(page_id_t hint) {
+    // free pages are always zero, and db file is extended in advance,
+    // so we don't need to write anything here
+    page_id_t new_page_id = allocator_->AllocatePage(hint);
+
+    // debug purpose
+    allocate_count_++;
+
+    return new_page_id;
+}
+
+page_id_t FileDiskManager::AllocateExtent(uint32_t count) {
+    page_id_t first_page_id = allocator_->AllocateExtent(count);
+
+    // debug purpose
+    allocate_count_ += count;
+
+    return first_page_id;
+}
+
+void FileDiskManager::DeallocatePage(page_id_t page_id) {
+    if (!allocator_->IsAllocated(page_id)) {
+        LOG_WARN("deallocating a free page %d", page_id);
+        return;
+    }
+
+    // wipe the content first, so the page could be handed out without writing it again
+    ZeroPages(page_id, page_id + 1);
+    allocator_->DeallocatePage(page_id);
+
+    // debug purpose
+    deallocate_count_++;
+}
+
+void FileDiskManager::ExtendFile(page_id_t begin, page_id_t end) {
+    // pages might be spread across several data files, extend them piece by piece
+    page_id_t page_id = begin;
+    while (page_id < end) {
+        page_id_t count = std::min(tablespace_->GetRunLength(page_id), end - page_id);
+        off_t offset;
+        int fd = tablespace_->Locate(page_id, &offset);
+        off_t length = static_cast<off_t>(count) * PAGE_SIZE;
+        page_id += count;
+
+        // preallocate the blocks, file size is extended as well
+        if (fallocate(fd, 0, offset, length) == 0) {
+            continue;
+        }
+        if (errno != EOPNOTSUPP && errno != ENOSYS) {
+            LOG_ERROR("failed to preallocate db file, %s", strerror(errno));
+        }
+
+        // file system doesn't support fallocate, just extend the file.
+        // reading holes will give us zero anyway
+        struct stat stat_buf;
+        if (fstat(fd, &stat_buf) == 0 && stat_buf.st_size < offset + length && ftruncate(fd, offset + length) != 0) {
+            LOG_ERROR("failed to extend db file, %s", strerror(errno));
+        }
+    }
+}
+
+void FileDiskManager::ZeroPages(page_id_t begin, page_id_t end) {
+    page_id_t page_id = begin;
+    while (page_id < end) {
+        page_id_t count = std::min(tablespace_->GetRunLength(page_id), end - page_id);
+        off_t offset;
+        int fd = tablespace_->Locate(page_id, &offset);
+        off_t length = static_cast<off_t>(count) * PAGE_SIZE;
+
+        // keep the blocks allocated, but read as zero
+        if (fallocate(fd, FALLOC_FL_ZERO_RANGE | FALLOC_FL_KEEP_SIZE, offset, length) != 0) {
+            alignas(PAGE_ALIGNMENT) static const char zero_page[PAGE_SIZE] = {0};
+            for (page_id_t i = page_id; i < page_id + count; i++) {
+                WritePageInternal(i, zero_page);
+            }
+        }
+        page_id += count;
+    }
+}
+
+void FileDiskManager::ReadPage(page_id_t pageId, char *data) {
+    if (!IsAligned(data)) {
+        // direct I/O requires aligned buffer, go through a bounce buffer
+        alignas(PAGE_ALIGNMENT) char buffer[PAGE_SIZE];
+        ReadPageInternal(pageId, buffer);
+        memcpy(data, buffer, PAGE_SIZE);
+        return;
+    }
+    ReadPageInternal(pageId, data);
+}
+
+void FileDiskManager::WritePage(page_id_t pageId, const char *data) {
+    if (!IsAligned(data)) {
+        alignas(PAGE_ALIGNMENT) char buffer[PAGE_SIZE];
+        memcpy(buffer, data, PAGE_SIZE);
+        WritePageInternal(pageId, buffer);
+        return;
+    }
+    WritePageInternal(pageId, data);
+}
+
+void FileDiskManager::ReadPageInternal(page_id_t pageId, char *data) {
+    IOTimer timer(&stats_.page_read_, PAGE_SIZE);
+    off_t offset;
+    int fd = tablespace_->Locate(pageId, &offset);
+
+    // pread won't touch the file cursor, so concurrent readers are fine.
+    // it may return less than we asked, e.g. interrupted by signal, so keep reading
+    size_t read_count = 0;
+    while (read_count < PAGE_SIZE) {
+        ssize_t rc = pread(fd, data + read_count, PAGE_SIZE - read_count, offset + read_count);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("I/O error while reading page %d, %s", pageId, strerror(errno));
+            return;
+        }
+        if (rc == 0) {
+            // reaching the end of file
+            break;
+        }
+        read_count += rc;
+    }
+
+    if (read_count < PAGE_SIZE) {
+        LOG_ERROR("read less than a page, page_id: %d", pageId);
+
+        // set those random data to 0
+        memset(data + read_count, 0, PAGE_SIZE - read_count);
+    }
+}
+
+void FileDiskManager::WritePageInternal(page_id_t pageId, const char *data) {
+    IOTimer timer(&stats_.page_write_, PAGE_SIZE);
+    off_t offset;
+    int fd = tablespace_->Locate(pageId, &offset);
+
+    size_t write_count = 0;
+    while (write_count < PAGE_SIZE) {
+        ssize_t rc = pwrite(fd, data + write_count, PAGE_SIZE - write_count, offset + write_count);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("I/O error while writing page %d, %s", pageId, strerror(errno));
+            return;
+        }
+        write_count += rc;
+    }
+}
+
+void FileDiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &data) {
+    TransferPages(false, page_ids, data);
+}
+
+void FileDiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &data) {
+    // buffers won't be modified for writes
+    std::vector<char *> buffers;
+    buffers.reserve(data.size());
+    for (auto buffer : data) {
+        buffers.push_back(const_cast<char *> (buffer));
+    }
+    TransferPages(true, page_ids, buffers);
+}
+
+void FileDiskManager::TransferPages(bool is_write, const std::vector<page_id_t> &page_ids, const std::vector<char *> &data) {
+    TINYDB_ASSERT(page_ids.size() == data.size(), "each page should have its own buffer");
+
+    // sort the requests by page id, so that we could find contiguous runs
+    std::vector<size_t> order(page_ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return page_ids[lhs] < page_ids[rhs];
+    });
+
+    std::vector<struct iovec> iov;
+    iov.reserve(std::min<size_t>(order.size(), IOV_MAX));
+    size_t i = 0;
+    while (i < order.size()) {
+        page_id_t first_page_id = page_ids[order[i]];
+        if (!IsAligned(data[order[i]])) {
+            // unaligned buffer can't be used for direct I/O, go through the bounce buffer
+            if (is_write) {
+                WritePage(first_page_id, data[order[i]]);
+            } else {
+                ReadPage(first_page_id, data[order[i]]);
+            }
+            i++;
+            continue;
+        }
+
+        // collect the run, it should not cross the boundary of data files
+        off_t offset;
+        int fd = tablespace_->Locate(first_page_id, &offset);
+        page_id_t max_run = std::min<page_id_t>(tablespace_->GetRunLength(first_page_id), IOV_MAX);
+        iov.clear();
+        while (i < order.size() && static_cast<page_id_t>(iov.size()) < max_run
+               && page_ids[order[i]] == first_page_id + static_cast<page_id_t>(iov.size())
+               && IsAligned(data[order[i]])) {
+            iov.push_back({data[order[i]], PAGE_SIZE});
+            i++;
+        }
+
+        // transfer the whole run, kernel may give us less than we asked, so keep going
+        IOTimer timer(is_write ? &stats_.page_write_ : &stats_.page_read_, iov.size() * PAGE_SIZE);
+        size_t total = iov.size() * PAGE_SIZE;
+        size_t done = 0;
+        size_t iov_idx = 0;
+        while (done < total) {
+            ssize_t rc = is_write
+                ? pwritev(fd, iov.data() + iov_idx, iov.size() - iov_idx, offset + done)
+                : preadv(fd, iov.data() + iov_idx, iov.size() - iov_idx, offset + done);
+            if (rc < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG_ERROR("I/O error while %s pages [%d, %d), %s", is_write ? "writing" : "reading",
+                    first_page_id, first_page_id + static_cast<page_id_t>(iov.size()), strerror(errno));
+                break;
+            }
+            if (rc == 0) {
+                // reaching the end of file
+                break;
+            }
+            done += rc;
+            // skip the finished buffers and adjust the partial one
+            while (rc > 0) {
+                size_t len = std::min<size_t>(rc, iov[iov_idx].iov_len);
+                iov[iov_idx].iov_base = static_cast<char *> (iov[iov_idx].iov_base) + len;
+                iov[iov_idx].iov_len -= len;
+                rc -= len;
+                if (iov[iov_idx].iov_len == 0) {
+                    iov_idx++;
+                }
+            }
+        }
+
+        if (!is_write && done < total) {
+            LOG_ERROR("read less than a page, page_id: %d", first_page_id + static_cast<page_id_t>(done / PAGE_SIZE));
+            // set those random data to 0
+            for (size_t j = iov_idx; j < iov.size(); j++) {
+                memset(iov[j].iov_base, 0, iov[j].iov_len);
+            }
+        }
+    }
+}
+
+IOEngine *FileDiskManager::GetIOEngine() {
+    std::call_once(io_engine_flag_, [&]() {
+        io_engine_ = IOEngine::Create(io_engine_type_, IO_QUEUE_DEPTH);
+        if (io_engine_ == nullptr) {
+            THROW_IO_EXCEPTION("failed to create io engine");
+        }
+    });
+    return io_engine_.get();
+}
+
+void FileDiskManager::SubmitBatch(std::vector<DiskRequest> &requests) {
+    std::vector<IORequest> io_requests;
+    io_requests.reserve(requests.size());
+    for (auto &request : requests) {
+        request.handle_ = std::make_shared<IOCompletion>();
+        if (!IsAligned(request.data_)) {
+            // unaligned buffer can't be used for direct I/O, do it synchronously through bounce buffer
+            if (request.is_write_) {
+                WritePage(request.page_id_, request.data_);
+            } else {
+                ReadPage(request.page_id_, request.data_);
+            }
+            request.handle_->Complete(true);
+            continue;
+        }
+        // latency is measured from submission to completion
+        auto stat = request.is_write_ ? &stats_.page_write_ : &stats_.page_read_;
+        auto start = std::chrono::steady_clock::now();
+        request.handle_->SetCallback([stat, start](bool) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            stat->Record(PAGE_SIZE, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        });
+
+        off_t offset;
+        int fd = tablespace_->Locate(request.page_id_, &offset);
+        io_requests.push_back(IORequest{
+            request.is_write_ ? IOType::WRITE : IOType::READ,
+            fd,
+            request.data_,
+            PAGE_SIZE,
+            offset,
+            request.handle_});
+    }
+    if (!io_requests.empty()) {
+        GetIOEngine()->Submit(io_requests);
+    }
+}
+
+int64_t FileDiskManager::GetFileSize(const std::string &filename) {
+    struct stat stat_buf;
+    int rc = stat(filename.c_str(), &stat_buf);
+    return rc == 0 ? static_cast<int64_t> (stat_buf.st_size) : -1;
+}
+
+bool FileDiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+    auto t1 = std::chrono::steady_clock::now();
+
+    // this is stupid. we should cache the log size then read it till end
+    // since log file won't change while performing recovery protocol.
+    if (offset >= GetFileSize(log_name_)) {
+        return false;
+    }
+
+    IOTimer timer(&stats_.log_read_, size);
+    log_file_.seekp(offset);
+    log_file_.read(log_data, size);
+
+    if (log_file_.bad()) {
+        LOG_ERROR("I/O error while reading log");
+        return false;
+    }
+
+    int read_count = log_file_.gcount();
+    if (read_count < size) {
+        log_file_.clear();
+        // pad with zero
+        memset(log_data + read_count, 0, size - read_count);
+    }
+
+    auto t2 = std::chrono::steady_clock::now();
+    log_read_time_ += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+    return true;
+}
+
+void FileDiskManager::WriteLog(char *log_data, int size) {
+    // count time
+    auto t1 = std::chrono::steady_clock::now();
+
+    // deprecated
+    // enforce swap log buffer
+    // assert(log_data != buffer_used_);
+    // buffer_used_ = log_data;
+
+    if (size == 0) {
+        return;
+    }
+    IOTimer timer(&stats_.log_write_, size);
+
+    // append the log
+    log_file_.write(log_data, size);
+
+    // check for IO-error
+    if (log_file_.bad()) {
+        LOG_ERROR("I/O error while writing log");
+        return;
+    }
+
+    // flush to disk
+    log_file_.flush();
+
+    auto t2 = std::chrono::steady_clock::now();
+    log_write_time_ += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+    // another approach to calc elapsed time
+    // std::chrono::duration<double, std::milli> fp_ms = t2 - t1;
+    // LOG_INFO("%f", fp_ms.count());
+}
+
+void FileDiskManager::Sync() {
+    IOTimer timer(&stats_.sync_, 0);
+    for (size_t i = 0; i < tablespace_->GetFileNum(); i++) {
+        if (fdatasync(tablespace_->GetFd(i)) != 0) {
+            LOG_ERROR("failed to sync %s, %s", tablespace_->GetFileName(i).c_str(), strerror(errno));
+        }
+    }
+    // allocation state should be durable as well
+    if (fdatasync(meta_fd_) != 0) {
+        LOG_ERROR("failed to sync %s, %s", meta_name_.c_str(), strerror(errno));
+    }
+}
+
+}
+
+
+#endif
\ No newline at end of file
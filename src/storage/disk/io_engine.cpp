@@ -0,0 +1,69 @@
+/**
+ * @file io_engine.cpp
+ * @author sheep
+ * @brief common part of io engines
+ * @version 0.1
+ * @date 2022-06-05
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/io_engine.h"
+#include "storage/disk/thread_pool_io_engine.h"
+#include "storage/disk/io_uring_io_engine.h"
+#include "common/logger.h"
+
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace TinyDB {
+
+std::unique_ptr<IOEngine> IOEngine::Create(IOEngineType type, uint32_t queue_depth) {
+    if (type == IOEngineType::AUTO || type == IOEngineType::IO_URING) {
+        auto engine = std::make_unique<IOUringIOEngine>(queue_depth);
+        if (engine->IsValid()) {
+            return engine;
+        }
+        if (type == IOEngineType::IO_URING) {
+            return nullptr;
+        }
+        LOG_INFO("io_uring is not available, fallback to thread pool");
+    }
+
+    // we don't need that many threads, since they are just blocking on I/O
+    uint32_t worker_num = std::max<uint32_t>(1, std::min<uint32_t>(queue_depth, 16));
+    return std::make_unique<ThreadPoolIOEngine>(worker_num);
+}
+
+bool IOEngine::PerformSync(const IORequest &request, size_t done) {
+    while (done < request.size_) {
+        ssize_t rc;
+        if (request.type_ == IOType::READ) {
+            rc = pread(request.fd_, request.data_ + done, request.size_ - done, request.offset_ + done);
+        } else {
+            rc = pwrite(request.fd_, request.data_ + done, request.size_ - done, request.offset_ + done);
+        }
+
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("I/O error at offset %ld, %s", static_cast<long>(request.offset_), strerror(errno));
+            return false;
+        }
+        if (rc == 0) {
+            if (request.type_ == IOType::READ) {
+                // reading past end of file, pad with zero
+                memset(request.data_ + done, 0, request.size_ - done);
+                return true;
+            }
+            return false;
+        }
+        done += rc;
+    }
+    return true;
+}
+
+}
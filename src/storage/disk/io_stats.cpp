@@ -0,0 +1,66 @@
+/**
+ * @file io_stats.cpp
+ * @author sheep
+ * @brief implementation of I/O statistics
+ * @version 0.1
+ * @date 2022-06-13
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/io_stats.h"
+
+#include <cstdio>
+
+namespace TinyDB {
+
+std::string IOStatSnapshot::ToString() const {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "ops %lu, %.1fMiB, avg %s, p50 %s, p99 %s, p999 %s, max %s",
+        static_cast<unsigned long>(ops_),
+        bytes_ / 1048576.0,
+        FormatDuration(static_cast<uint64_t>(latency_.Mean())).c_str(),
+        FormatDuration(latency_.Percentile(0.5)).c_str(),
+        FormatDuration(latency_.Percentile(0.99)).c_str(),
+        FormatDuration(latency_.Percentile(0.999)).c_str(),
+        FormatDuration(latency_.max_).c_str());
+    return buffer;
+}
+
+IOStatSnapshot IOStat::Snapshot() const {
+    IOStatSnapshot snapshot;
+    snapshot.ops_ = ops_.load(std::memory_order_relaxed);
+    snapshot.bytes_ = bytes_.load(std::memory_order_relaxed);
+    snapshot.latency_ = latency_.Snapshot();
+    return snapshot;
+}
+
+void IOStat::Reset() {
+    ops_.store(0, std::memory_order_relaxed);
+    bytes_.store(0, std::memory_order_relaxed);
+    latency_.Reset();
+}
+
+std::string IOStatsSnapshot::ToString() const {
+    return "page read : " + page_read_.ToString() + "\n"
+         + "page write: " + page_write_.ToString() + "\n"
+         + "log read  : " + log_read_.ToString() + "\n"
+         + "log write : " + log_write_.ToString() + "\n"
+         + "sync      : " + sync_.ToString() + "\n";
+}
+
+IOStatsSnapshot IOStats::Snapshot() const {
+    return IOStatsSnapshot{page_read_.Snapshot(), page_write_.Snapshot(), log_read_.Snapshot(),
+                           log_write_.Snapshot(), sync_.Snapshot()};
+}
+
+void IOStats::Reset() {
+    page_read_.Reset();
+    page_write_.Reset();
+    log_read_.Reset();
+    log_write_.Reset();
+    sync_.Reset();
+}
+
+}
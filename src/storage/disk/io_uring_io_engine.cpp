@@ -0,0 +1,310 @@
+/**
+ * @file io_uring_io_engine.cpp
+ * @author sheep
+ * @brief implementation of io_uring io engine
+ * @version 0.1
+ * @date 2022-06-05
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/io_uring_io_engine.h"
+#include "common/logger.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define TINYDB_HAS_IO_URING 1
+#endif
+
+namespace TinyDB {
+
+#ifdef TINYDB_HAS_IO_URING
+
+// user_data of the nop request that is used to stop reap thread
+static constexpr uint64_t STOP_USER_DATA = 0;
+
+static inline unsigned LoadAcquire(unsigned *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void StoreRelease(unsigned *ptr, unsigned value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static inline int IOUringSetup(unsigned entries, struct io_uring_params *params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static inline int IOUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+IOUringIOEngine::IOUringIOEngine(uint32_t queue_depth) {
+    if (!SetupRing(queue_depth)) {
+        // release the partially initialized ring, IsValid will return false
+        if (sqes_ptr_ != nullptr) {
+            munmap(sqes_ptr_, sqes_size_);
+            sqes_ptr_ = nullptr;
+        }
+        if (cq_ring_ptr_ != nullptr && cq_ring_ptr_ != sq_ring_ptr_) {
+            munmap(cq_ring_ptr_, cq_ring_size_);
+        }
+        cq_ring_ptr_ = nullptr;
+        if (sq_ring_ptr_ != nullptr) {
+            munmap(sq_ring_ptr_, sq_ring_size_);
+            sq_ring_ptr_ = nullptr;
+        }
+        if (ring_fd_ >= 0) {
+            close(ring_fd_);
+            ring_fd_ = -1;
+        }
+        return;
+    }
+
+    enable_reaping_ = true;
+    reap_thread_ = new std::thread(&IOUringIOEngine::ReapThread, this);
+}
+
+IOUringIOEngine::~IOUringIOEngine() {
+    if (reap_thread_ != nullptr) {
+        std::unique_lock<std::mutex> latch(latch_);
+        // wait for all in-flight requests
+        cv_.wait(latch, [&]() { return inflight_ == 0; });
+
+        enable_reaping_ = false;
+        // wakeup the reap thread with a nop request
+        unsigned tail = *sq_tail_;
+        unsigned idx = tail & *sq_mask_;
+        auto sqe = reinterpret_cast<struct io_uring_sqe *> (sqes_ptr_) + idx;
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = STOP_USER_DATA;
+        sq_array_[idx] = idx;
+        StoreRelease(sq_tail_, tail + 1);
+        while (IOUringEnter(ring_fd_, 1, 0, 0) < 0 && (errno == EINTR || errno == EAGAIN)) {}
+        latch.unlock();
+
+        reap_thread_->join();
+        delete reap_thread_;
+    }
+
+    if (sqes_ptr_ != nullptr) {
+        munmap(sqes_ptr_, sqes_size_);
+    }
+    if (cq_ring_ptr_ != nullptr && cq_ring_ptr_ != sq_ring_ptr_) {
+        munmap(cq_ring_ptr_, cq_ring_size_);
+    }
+    if (sq_ring_ptr_ != nullptr) {
+        munmap(sq_ring_ptr_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+    }
+}
+
+bool IOUringIOEngine::SetupRing(uint32_t queue_depth) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = IOUringSetup(std::max<uint32_t>(queue_depth, 1), &params);
+    if (fd < 0) {
+        LOG_INFO("io_uring_setup failed, %s", strerror(errno));
+        return false;
+    }
+    ring_fd_ = fd;
+    sq_entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        cq_ring_size_ = sq_ring_size_;
+    }
+
+    void *ptr = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR("failed to map submission ring, %s", strerror(errno));
+        return false;
+    }
+    sq_ring_ptr_ = ptr;
+
+    if (single_mmap) {
+        cq_ring_ptr_ = sq_ring_ptr_;
+    } else {
+        ptr = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (ptr == MAP_FAILED) {
+            LOG_ERROR("failed to map completion ring, %s", strerror(errno));
+            return false;
+        }
+        cq_ring_ptr_ = ptr;
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    ptr = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR("failed to map submission entries, %s", strerror(errno));
+        return false;
+    }
+    sqes_ptr_ = ptr;
+
+    auto sq_base = reinterpret_cast<char *> (sq_ring_ptr_);
+    sq_head_ = reinterpret_cast<unsigned *> (sq_base + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *> (sq_base + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *> (sq_base + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *> (sq_base + params.sq_off.array);
+
+    auto cq_base = reinterpret_cast<char *> (cq_ring_ptr_);
+    cq_head_ = reinterpret_cast<unsigned *> (cq_base + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *> (cq_base + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *> (cq_base + params.cq_off.ring_mask);
+    cqes_ = cq_base + params.cq_off.cqes;
+
+    return true;
+}
+
+void IOUringIOEngine::Submit(const std::vector<IORequest> &requests) {
+    std::unique_lock<std::mutex> latch(latch_);
+    auto sqes = reinterpret_cast<struct io_uring_sqe *> (sqes_ptr_);
+
+    size_t i = 0;
+    while (i < requests.size()) {
+        // completion queue is twice as large as submission queue,
+        // so bounding in-flight requests by sq_entries_ prevents it from overflowing
+        cv_.wait(latch, [&]() { return inflight_ < sq_entries_; });
+
+        // we are the only producer
+        unsigned tail = *sq_tail_;
+        unsigned head = LoadAcquire(sq_head_);
+        unsigned to_submit = 0;
+        while (i < requests.size() && inflight_ < sq_entries_ && tail - head < sq_entries_) {
+            auto io = new InflightIO{requests[i], {requests[i].data_, requests[i].size_}};
+            unsigned idx = tail & *sq_mask_;
+            auto sqe = &sqes[idx];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = requests[i].type_ == IOType::READ ? IORING_OP_READV : IORING_OP_WRITEV;
+            sqe->fd = requests[i].fd_;
+            sqe->addr = reinterpret_cast<uint64_t> (&io->iov_);
+            sqe->len = 1;
+            sqe->off = requests[i].offset_;
+            sqe->user_data = reinterpret_cast<uint64_t> (io);
+            sq_array_[idx] = idx;
+
+            tail++;
+            i++;
+            inflight_++;
+            to_submit++;
+        }
+        StoreRelease(sq_tail_, tail);
+
+        // one syscall for the whole batch
+        while (to_submit > 0) {
+            int rc = IOUringEnter(ring_fd_, to_submit, 0, 0);
+            if (rc < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // nobody else submits, so entries left in the ring would never be picked up.
+                // take them back and perform them synchronously
+                LOG_ERROR("io_uring_enter failed, %s, fall back to synchronous I/O", strerror(errno));
+                std::vector<InflightIO *> unsubmitted;
+                for (unsigned pos = LoadAcquire(sq_head_); pos != tail; pos++) {
+                    auto sqe = &sqes[sq_array_[pos & *sq_mask_]];
+                    unsubmitted.push_back(reinterpret_cast<InflightIO *> (sqe->user_data));
+                }
+                StoreRelease(sq_tail_, tail - static_cast<unsigned>(unsubmitted.size()));
+                inflight_ -= unsubmitted.size();
+                latch.unlock();
+                cv_.notify_all();
+                for (auto io : unsubmitted) {
+                    io->request_.handle_->Complete(PerformSync(io->request_));
+                    delete io;
+                }
+                latch.lock();
+                break;
+            }
+            to_submit -= rc;
+        }
+    }
+}
+
+void IOUringIOEngine::ReapThread() {
+    auto cqes = reinterpret_cast<struct io_uring_cqe *> (cqes_);
+    bool stopped = false;
+
+    while (!stopped) {
+        int rc = IOUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+        if (rc < 0 && errno != EINTR) {
+            LOG_ERROR("io_uring_enter failed while waiting for completion, %s", strerror(errno));
+        }
+
+        // we are the only consumer
+        unsigned head = *cq_head_;
+        unsigned tail = LoadAcquire(cq_tail_);
+        uint32_t reaped = 0;
+        while (head != tail) {
+            auto cqe = &cqes[head & *cq_mask_];
+            uint64_t user_data = cqe->user_data;
+            int res = cqe->res;
+            head++;
+
+            if (user_data == STOP_USER_DATA) {
+                stopped = !enable_reaping_;
+                continue;
+            }
+
+            auto io = reinterpret_cast<InflightIO *> (user_data);
+            bool success = false;
+            if (res >= 0 || res == -EINTR || res == -EAGAIN) {
+                // kernel may transfer less than we asked, e.g. reading past end of file.
+                // finish the rest of it synchronously
+                success = PerformSync(io->request_, std::max(res, 0));
+            } else {
+                LOG_ERROR("async I/O error at offset %ld, %s",
+                    static_cast<long>(io->request_.offset_), strerror(-res));
+            }
+            io->request_.handle_->Complete(success);
+            delete io;
+            reaped++;
+        }
+        StoreRelease(cq_head_, head);
+
+        if (reaped > 0) {
+            {
+                std::lock_guard<std::mutex> latch(latch_);
+                inflight_ -= reaped;
+            }
+            cv_.notify_all();
+        }
+    }
+}
+
+#else
+
+IOUringIOEngine::IOUringIOEngine(uint32_t queue_depth) {}
+
+IOUringIOEngine::~IOUringIOEngine() {}
+
+bool IOUringIOEngine::SetupRing(uint32_t queue_depth) {
+    return false;
+}
+
+void IOUringIOEngine::Submit(const std::vector<IORequest> &requests) {
+    for (const auto &request : requests) {
+        request.handle_->Complete(PerformSync(request));
+    }
+}
+
+void IOUringIOEngine::ReapThread() {}
+
+#endif
+
+}
@@ -0,0 +1,275 @@
+/**
+ * @file latency_disk_manager.cpp
+ * @author sheep
+ * @brief implementation of latency disk manager
+ * @version 0.1
+ * @date 2022-06-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/latency_disk_manager.h"
+#include "common/logger.h"
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <thread>
+
+namespace TinyDB {
+
+LatencyDiskManager::LatencyDiskManager(DiskManager *disk_manager, const DeviceProfile &profile)
+    : disk_manager_(disk_manager),
+      profile_(profile),
+      channel_free_time_(std::chrono::steady_clock::now()),
+      idle_time_(channel_free_time_) {
+    profile_.queue_depth_ = std::max<uint32_t>(profile_.queue_depth_, 1);
+    queue_free_time_.resize(profile_.queue_depth_, channel_free_time_);
+    device_thread_ = std::thread(&LatencyDiskManager::DeviceThread, this);
+}
+
+LatencyDiskManager::~LatencyDiskManager() {
+    {
+        std::lock_guard<std::mutex> guard(device_latch_);
+        enable_running_ = false;
+        // don't leave the batches stalled forever
+        paused_ = false;
+    }
+    device_cv_.notify_all();
+    pause_cv_.notify_all();
+    device_thread_.join();
+}
+
+void LatencyDiskManager::Delay(bool is_write, size_t request_num, size_t bytes, bool sync) {
+    if (request_num == 0 && !sync) {
+        return;
+    }
+
+    std::chrono::steady_clock::time_point deadline;
+    {
+        std::unique_lock<std::mutex> lock(device_latch_);
+        WaitForResume(&lock);
+        // requests are served from now on, stalled time is not part of their cost
+        auto now = std::chrono::steady_clock::now();
+        deadline = Reserve(is_write, request_num, bytes, now);
+        if (sync) {
+            // the requests above are in flight by now, sync waits for them as well
+            deadline = ReserveSync(now);
+        }
+    }
+
+    std::this_thread::sleep_until(deadline);
+}
+
+std::chrono::steady_clock::time_point LatencyDiskManager::Reserve(bool is_write, size_t request_num, size_t bytes,
+                                                                  std::chrono::steady_clock::time_point now) {
+    if (request_num == 0) {
+        return now;
+    }
+
+    auto latency = is_write ? profile_.write_latency_ : profile_.read_latency_;
+    uint64_t bandwidth = is_write ? profile_.write_bandwidth_ : profile_.read_bandwidth_;
+
+    // every request takes the queue slot which becomes free first, and holds it for
+    // the latency. requests beyond queue depth, no matter whose, wait for a slot
+    auto deadline = now;
+    for (size_t i = 0; i < request_num; i++) {
+        std::pop_heap(queue_free_time_.begin(), queue_free_time_.end(), std::greater<>());
+        auto &free_time = queue_free_time_.back();
+        free_time = std::max(now, free_time) + latency;
+        deadline = std::max(deadline, free_time);
+        std::push_heap(queue_free_time_.begin(), queue_free_time_.end(), std::greater<>());
+    }
+
+    if (bandwidth > 0) {
+        // reserve our slot on the channel
+        auto transfer = std::chrono::nanoseconds(static_cast<int64_t>(bytes * 1000000000ULL / bandwidth));
+        auto start = std::max(now, channel_free_time_);
+        channel_free_time_ = start + transfer;
+        deadline = std::max(deadline, channel_free_time_ + latency);
+    }
+    idle_time_ = std::max(idle_time_, deadline);
+    return deadline;
+}
+
+std::chrono::steady_clock::time_point LatencyDiskManager::ReserveSync(std::chrono::steady_clock::time_point now) {
+    // sync starts when everything the device has accepted is served, and it holds the
+    // whole device, requests coming after it wait until it's done
+    auto deadline = std::max(now, idle_time_) + profile_.sync_latency_;
+    std::fill(queue_free_time_.begin(), queue_free_time_.end(), deadline);
+    channel_free_time_ = std::max(channel_free_time_, deadline);
+    idle_time_ = deadline;
+    return deadline;
+}
+
+void LatencyDiskManager::WaitForResume(std::unique_lock<std::mutex> *lock) {
+    if (!paused_) {
+        return;
+    }
+    stalled_++;
+    pause_cv_.notify_all();
+    pause_cv_.wait(*lock, [&]() { return !paused_; });
+    stalled_--;
+}
+
+void LatencyDiskManager::Pause() {
+    std::lock_guard<std::mutex> guard(device_latch_);
+    paused_ = true;
+}
+
+void LatencyDiskManager::Resume() {
+    std::lock_guard<std::mutex> guard(device_latch_);
+    paused_ = false;
+    pause_cv_.notify_all();
+}
+
+void LatencyDiskManager::WaitForStalled(size_t count) {
+    std::unique_lock<std::mutex> lock(device_latch_);
+    pause_cv_.wait(lock, [&]() { return stalled_ >= count; });
+}
+
+size_t LatencyDiskManager::CountRuns(std::vector<page_id_t> page_ids) {
+    std::sort(page_ids.begin(), page_ids.end());
+    size_t runs = 0;
+    for (size_t i = 0; i < page_ids.size(); i++) {
+        if (i == 0 || page_ids[i] != page_ids[i - 1] + 1) {
+            runs++;
+        }
+    }
+    return runs;
+}
+
+void LatencyDiskManager::WritePage(page_id_t pageId, const char *data) {
+    IOTimer timer(&stats_.page_write_, PAGE_SIZE);
+    Delay(true, 1, PAGE_SIZE);
+    disk_manager_->WritePage(pageId, data);
+}
+
+void LatencyDiskManager::ReadPage(page_id_t pageId, char *data) {
+    IOTimer timer(&stats_.page_read_, PAGE_SIZE);
+    Delay(false, 1, PAGE_SIZE);
+    disk_manager_->ReadPage(pageId, data);
+}
+
+void LatencyDiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &data) {
+    IOTimer timer(&stats_.page_read_, page_ids.size() * PAGE_SIZE);
+    Delay(false, CountRuns(page_ids), page_ids.size() * PAGE_SIZE);
+    disk_manager_->ReadPages(page_ids, data);
+}
+
+void LatencyDiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &data) {
+    IOTimer timer(&stats_.page_write_, page_ids.size() * PAGE_SIZE);
+    Delay(true, CountRuns(page_ids), page_ids.size() * PAGE_SIZE);
+    disk_manager_->WritePages(page_ids, data);
+}
+
+void LatencyDiskManager::SubmitBatch(std::vector<DiskRequest> &requests) {
+    if (requests.empty()) {
+        return;
+    }
+    std::vector<page_id_t> read_ids;
+    std::vector<page_id_t> write_ids;
+    for (auto &request : requests) {
+        (request.is_write_ ? write_ids : read_ids).push_back(request.page_id_);
+        request.handle_ = std::make_shared<IOCompletion>();
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(device_latch_);
+        // requests within the batch are served together, they share the latency
+        auto now = std::chrono::steady_clock::now();
+        auto deadline = std::max(Reserve(false, CountRuns(read_ids), read_ids.size() * PAGE_SIZE, now),
+                                 Reserve(true, CountRuns(write_ids), write_ids.size() * PAGE_SIZE, now));
+        pending_.emplace(deadline, PendingBatch{now, requests});
+    }
+    device_cv_.notify_one();
+}
+
+void LatencyDiskManager::DeviceThread() {
+    std::unique_lock<std::mutex> lock(device_latch_);
+    while (true) {
+        if (pending_.empty()) {
+            if (!enable_running_) {
+                return;
+            }
+            device_cv_.wait(lock);
+            continue;
+        }
+        // a batch submitted later might be served earlier, e.g. it's a read
+        auto deadline = pending_.begin()->first;
+        if (std::chrono::steady_clock::now() < deadline) {
+            device_cv_.wait_until(lock, deadline);
+            continue;
+        }
+        auto batch = std::move(pending_.begin()->second);
+        pending_.erase(pending_.begin());
+        WaitForResume(&lock);
+        lock.unlock();
+
+        // the underlying disk manager replaces the handles with its own
+        std::vector<DiskRequest> requests = batch.requests_;
+        bool submitted = true;
+        try {
+            disk_manager_->SubmitBatch(requests);
+        } catch (std::exception &e) {
+            LOG_ERROR("failed to submit a batch of %zu requests, %s", requests.size(), e.what());
+            submitted = false;
+        }
+        for (size_t i = 0; i < requests.size(); i++) {
+            bool res = submitted && requests[i].handle_->Wait();
+            auto elapsed = std::chrono::steady_clock::now() - batch.submit_time_;
+            (requests[i].is_write_ ? stats_.page_write_ : stats_.page_read_).Record(
+                PAGE_SIZE, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            batch.requests_[i].handle_->Complete(res);
+        }
+
+        lock.lock();
+    }
+}
+
+void LatencyDiskManager::Sync() {
+    IOTimer timer(&stats_.sync_, 0);
+    Delay(true, 0, 0, true);
+    disk_manager_->Sync();
+}
+
+page_id_t LatencyDiskManager::AllocatePage(page_id_t hint) {
+    allocate_count_++;
+    return disk_manager_->AllocatePage(hint);
+}
+
+page_id_t LatencyDiskManager::AllocateExtent(uint32_t count) {
+    allocate_count_ += count;
+    return disk_manager_->AllocateExtent(count);
+}
+
+void LatencyDiskManager::DeallocatePage(page_id_t page_id) {
+    // deallocating a free page is ignored by underlying one
+    bool allocated = disk_manager_->IsAllocated(page_id);
+    disk_manager_->DeallocatePage(page_id);
+    if (allocated) {
+        deallocate_count_++;
+    }
+}
+
+bool LatencyDiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+    IOTimer timer(&stats_.log_read_, size);
+    auto t1 = std::chrono::steady_clock::now();
+    Delay(false, 1, size);
+    bool res = disk_manager_->ReadLog(log_data, size, offset);
+    auto t2 = std::chrono::steady_clock::now();
+    log_read_time_ += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+    return res;
+}
+
+void LatencyDiskManager::WriteLog(char *log_data, int size) {
+    IOTimer timer(&stats_.log_write_, size);
+    auto t1 = std::chrono::steady_clock::now();
+    Delay(true, 1, size, true);
+    disk_manager_->WriteLog(log_data, size);
+    auto t2 = std::chrono::steady_clock::now();
+    log_write_time_ += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+}
+
+}
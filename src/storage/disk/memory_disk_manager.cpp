@@ -0,0 +1,151 @@
+/**
+ * @file memory_disk_manager.cpp
+ * @author sheep
+ * @brief implementation of memory disk manager
+ * @version 0.1
+ * @date 2022-06-11
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/memory_disk_manager.h"
+#include "common/logger.h"
+
+#include <cstring>
+
+namespace TinyDB {
+
+void MemoryDiskManager::WritePage(page_id_t pageId, const char *data) {
+    IOTimer timer(&stats_.page_write_, PAGE_SIZE);
+    if (pageId < 0) {
+        LOG_ERROR("writing invalid page %d", pageId);
+        return;
+    }
+
+    {
+        // fast path, the page is already there
+        ReaderGuard guard(latch_);
+        if (static_cast<size_t>(pageId) < pages_.size() && pages_[pageId] != nullptr) {
+            memcpy(pages_[pageId].get(), data, PAGE_SIZE);
+            return;
+        }
+    }
+
+    WriterGuard guard(latch_);
+    if (static_cast<size_t>(pageId) >= pages_.size()) {
+        pages_.resize(pageId + 1);
+    }
+    if (pages_[pageId] == nullptr) {
+        pages_[pageId] = std::make_unique<char[]>(PAGE_SIZE);
+    }
+    memcpy(pages_[pageId].get(), data, PAGE_SIZE);
+}
+
+void MemoryDiskManager::ReadPage(page_id_t pageId, char *data) {
+    IOTimer timer(&stats_.page_read_, PAGE_SIZE);
+    ReaderGuard guard(latch_);
+    if (pageId < 0 || static_cast<size_t>(pageId) >= pages_.size() || pages_[pageId] == nullptr) {
+        // never written
+        memset(data, 0, PAGE_SIZE);
+        return;
+    }
+    memcpy(data, pages_[pageId].get(), PAGE_SIZE);
+}
+
+page_id_t MemoryDiskManager::AllocatePage(page_id_t hint) {
+    WriterGuard guard(latch_);
+
+    page_id_t page_id = static_cast<page_id_t>(allocated_.size());
+    if (hint >= 0 && free_pages_.count(hint + 1) != 0) {
+        // keep the chain sequential
+        page_id = hint + 1;
+    } else if (!free_pages_.empty()) {
+        page_id = *free_pages_.begin();
+    }
+    MarkAllocated(page_id);
+
+    allocate_count_++;
+    return page_id;
+}
+
+page_id_t MemoryDiskManager::AllocateExtent(uint32_t count) {
+    WriterGuard guard(latch_);
+    if (count == 0) {
+        return INVALID_PAGE_ID;
+    }
+
+    // there is no locality in memory, simply append them
+    page_id_t first_page_id = static_cast<page_id_t>(allocated_.size());
+    for (uint32_t i = 0; i < count; i++) {
+        MarkAllocated(first_page_id + i);
+    }
+
+    allocate_count_ += count;
+    return first_page_id;
+}
+
+void MemoryDiskManager::DeallocatePage(page_id_t page_id) {
+    WriterGuard guard(latch_);
+    if (page_id < 0 || static_cast<size_t>(page_id) >= allocated_.size() || !allocated_[page_id]) {
+        LOG_WARN("deallocating a free page %d", page_id);
+        return;
+    }
+
+    allocated_[page_id] = false;
+    free_pages_.insert(page_id);
+    // release the memory, free pages read as zero
+    if (static_cast<size_t>(page_id) < pages_.size()) {
+        pages_[page_id].reset();
+    }
+
+    deallocate_count_++;
+}
+
+bool MemoryDiskManager::IsAllocated(page_id_t page_id) {
+    ReaderGuard guard(latch_);
+    return page_id >= 0 && static_cast<size_t>(page_id) < allocated_.size() && allocated_[page_id];
+}
+
+page_id_t MemoryDiskManager::GetPageCount() {
+    ReaderGuard guard(latch_);
+    return static_cast<page_id_t>(allocated_.size());
+}
+
+page_id_t MemoryDiskManager::GetFreePageCount() {
+    ReaderGuard guard(latch_);
+    return static_cast<page_id_t>(free_pages_.size());
+}
+
+void MemoryDiskManager::MarkAllocated(page_id_t page_id) {
+    if (static_cast<size_t>(page_id) >= allocated_.size()) {
+        for (page_id_t i = static_cast<page_id_t>(allocated_.size()); i < page_id; i++) {
+            free_pages_.insert(i);
+        }
+        allocated_.resize(page_id + 1, false);
+    }
+    allocated_[page_id] = true;
+    free_pages_.erase(page_id);
+}
+
+bool MemoryDiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+    std::lock_guard<std::mutex> guard(log_latch_);
+    if (offset >= static_cast<int64_t>(log_.size())) {
+        return false;
+    }
+
+    IOTimer timer(&stats_.log_read_, size);
+    size_t read_count = std::min<size_t>(size, log_.size() - offset);
+    memcpy(log_data, log_.data() + offset, read_count);
+    // pad with zero
+    memset(log_data + read_count, 0, size - read_count);
+    return true;
+}
+
+void MemoryDiskManager::WriteLog(char *log_data, int size) {
+    IOTimer timer(&stats_.log_write_, size);
+    std::lock_guard<std::mutex> guard(log_latch_);
+    log_.append(log_data, size);
+}
+
+}
@@ -0,0 +1,287 @@
+/**
+ * @file page_allocator.cpp
+ * @author sheep
+ * @brief implementation of page allocator
+ * @version 0.1
+ * @date 2022-06-08
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/page_allocator.h"
+#include "common/logger.h"
+#include "common/exception.h"
+#include "common/macros.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace TinyDB {
+
+PageAllocator::PageAllocator(int meta_fd, uint32_t extent_size, ExtendCallback extend_callback)
+    : meta_fd_(meta_fd), extent_size_(extent_size), extend_callback_(std::move(extend_callback)) {
+    TINYDB_ASSERT(extent_size_ > 0, "extent should contain at least one page");
+}
+
+bool PageAllocator::Load() {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    MetaHeader header;
+    if (pread(meta_fd_, &header, sizeof(header), 0) != sizeof(header)) {
+        return false;
+    }
+    if (header.magic_ != META_MAGIC || header.version_ != META_VERSION) {
+        LOG_WARN("invalid metadata file, magic %x, version %u", header.magic_, header.version_);
+        return false;
+    }
+    if (header.page_size_ != PAGE_SIZE) {
+        THROW_IO_EXCEPTION("page size mismatch, db file is created with page size " + std::to_string(header.page_size_));
+    }
+
+    // extent size is a property of the file
+    extent_size_ = header.extent_size_;
+    page_count_ = header.page_count_;
+    bitmap_.assign((page_count_ + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+
+    size_t size = bitmap_.size() * sizeof(uint64_t);
+    ssize_t rc = pread(meta_fd_, bitmap_.data(), size, META_HEADER_SIZE);
+    if (rc < 0) {
+        LOG_ERROR("failed to read page bitmap, %s", strerror(errno));
+        return false;
+    }
+    // words that have never been written are not in the file, they are zero
+
+    used_count_ = 0;
+    for (auto word : bitmap_) {
+        used_count_ += __builtin_popcountll(word);
+    }
+    first_free_word_ = 0;
+    RebuildExtents();
+    return true;
+}
+
+void PageAllocator::Format(page_id_t page_count) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    if (ftruncate(meta_fd_, 0) != 0) {
+        THROW_IO_EXCEPTION(std::string("failed to truncate metadata file, ") + strerror(errno));
+    }
+
+    page_count_ = 0;
+    used_count_ = 0;
+    first_free_word_ = 0;
+    bitmap_.clear();
+    extent_used_.clear();
+    free_extent_count_ = 0;
+    first_free_extent_ = 0;
+    if (page_count > 0) {
+        Extend(page_count);
+        for (page_id_t i = 0; i < page_count; i++) {
+            bitmap_[i / BITS_PER_WORD] |= 1ULL << (i % BITS_PER_WORD);
+        }
+        used_count_ = page_count;
+        for (size_t i = 0; i < bitmap_.size(); i++) {
+            WriteWord(i);
+        }
+        RebuildExtents();
+    }
+    WriteHeader();
+}
+
+page_id_t PageAllocator::AllocatePage(page_id_t hint) {
+    std::lock_guard<std::mutex> guard(latch_);
+
+    page_id_t page_id = INVALID_PAGE_ID;
+    if (hint >= 0 && hint < page_count_) {
+        // try to follow the hint page within its extent
+        page_id_t extent_end = std::min<page_id_t>((hint / extent_size_ + 1) * extent_size_, page_count_);
+        page_id_t extent_next = hint + 1;
+        page_id = FindFree(extent_next, extent_end);
+        if (page_id == INVALID_PAGE_ID) {
+            // current extent is full, start a new extent for this chain
+            // rather than scattering it among other's holes
+            page_id = FindFreeExtent();
+        }
+    }
+
+    if (page_id == INVALID_PAGE_ID) {
+        // reuse the lowest free page, data file grows only when there is no hole at all
+        while (first_free_word_ < bitmap_.size() && bitmap_[first_free_word_] == ~0ULL) {
+            first_free_word_++;
+        }
+        page_id = FindFree(first_free_word_ * BITS_PER_WORD, page_count_);
+        if (page_id == INVALID_PAGE_ID) {
+            page_id = page_count_;
+        }
+    }
+
+    if (page_id >= page_count_) {
+        Extend(page_id + 1);
+    }
+    SetBit(page_id, true);
+    return page_id;
+}
+
+page_id_t PageAllocator::AllocateExtent(uint32_t count) {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (count == 0) {
+        return INVALID_PAGE_ID;
+    }
+
+    page_id_t start = FindFreeRun(count);
+    if (start == INVALID_PAGE_ID) {
+        start = page_count_;
+        Extend(page_count_ + count);
+    }
+
+    for (page_id_t page_id = start; page_id < start + static_cast<page_id_t>(count); page_id++) {
+        SetBit(page_id, true);
+    }
+    return start;
+}
+
+bool PageAllocator::DeallocatePage(page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (page_id < 0 || page_id >= page_count_ || !TestBit(page_id)) {
+        LOG_WARN("deallocating a free page %d", page_id);
+        return false;
+    }
+
+    SetBit(page_id, false);
+    first_free_word_ = std::min<size_t>(first_free_word_, page_id / BITS_PER_WORD);
+    return true;
+}
+
+bool PageAllocator::IsAllocated(page_id_t page_id) {
+    std::lock_guard<std::mutex> guard(latch_);
+    return page_id >= 0 && page_id < page_count_ && TestBit(page_id);
+}
+
+page_id_t PageAllocator::GetPageCount() {
+    std::lock_guard<std::mutex> guard(latch_);
+    return page_count_;
+}
+
+page_id_t PageAllocator::GetFreePageCount() {
+    std::lock_guard<std::mutex> guard(latch_);
+    return page_count_ - used_count_;
+}
+
+void PageAllocator::SetBit(page_id_t page_id, bool used) {
+    size_t word_idx = page_id / BITS_PER_WORD;
+    uint64_t mask = 1ULL << (page_id % BITS_PER_WORD);
+    size_t extent_idx = page_id / extent_size_;
+    if (used) {
+        bitmap_[word_idx] |= mask;
+        used_count_++;
+        if (extent_used_[extent_idx]++ == 0) {
+            free_extent_count_--;
+        }
+    } else {
+        bitmap_[word_idx] &= ~mask;
+        used_count_--;
+        if (--extent_used_[extent_idx] == 0) {
+            free_extent_count_++;
+            first_free_extent_ = std::min(first_free_extent_, extent_idx);
+        }
+    }
+    WriteWord(word_idx);
+}
+
+page_id_t PageAllocator::FindFree(page_id_t begin, page_id_t end) const {
+    page_id_t cur = begin;
+    while (cur < end) {
+        size_t word_idx = cur / BITS_PER_WORD;
+        // treat the bits before cur as used
+        uint64_t word = bitmap_[word_idx] | ((1ULL << (cur % BITS_PER_WORD)) - 1);
+        if (~word != 0) {
+            page_id_t page_id = word_idx * BITS_PER_WORD + __builtin_ctzll(~word);
+            return page_id < end ? page_id : INVALID_PAGE_ID;
+        }
+        cur = (word_idx + 1) * BITS_PER_WORD;
+    }
+    return INVALID_PAGE_ID;
+}
+
+page_id_t PageAllocator::FindFreeRun(uint32_t count) const {
+    page_id_t run_start = 0;
+    uint32_t run_length = 0;
+    for (page_id_t page_id = 0; page_id < page_count_; page_id++) {
+        if (page_id % BITS_PER_WORD == 0 && bitmap_[page_id / BITS_PER_WORD] == ~0ULL) {
+            // skip the full word
+            run_length = 0;
+            page_id += BITS_PER_WORD - 1;
+            continue;
+        }
+        if (TestBit(page_id)) {
+            run_length = 0;
+            continue;
+        }
+        if (run_length == 0) {
+            run_start = page_id;
+        }
+        if (++run_length == count) {
+            return run_start;
+        }
+    }
+    return INVALID_PAGE_ID;
+}
+
+page_id_t PageAllocator::FindFreeExtent() {
+    if (free_extent_count_ == 0) {
+        return INVALID_PAGE_ID;
+    }
+    while (extent_used_[first_free_extent_] != 0) {
+        first_free_extent_++;
+    }
+    return static_cast<page_id_t>(first_free_extent_ * extent_size_);
+}
+
+void PageAllocator::RebuildExtents() {
+    extent_used_.assign((page_count_ + extent_size_ - 1) / extent_size_, 0);
+    for (size_t word_idx = 0; word_idx < bitmap_.size(); word_idx++) {
+        for (uint64_t word = bitmap_[word_idx]; word != 0; word &= word - 1) {
+            extent_used_[(word_idx * BITS_PER_WORD + __builtin_ctzll(word)) / extent_size_]++;
+        }
+    }
+    free_extent_count_ = std::count(extent_used_.begin(), extent_used_.end(), 0);
+    first_free_extent_ = 0;
+}
+
+void PageAllocator::Extend(page_id_t page_count) {
+    // round up to extent
+    page_id_t new_page_count = (page_count + extent_size_ - 1) / extent_size_ * extent_size_;
+    if (new_page_count <= page_count_) {
+        return;
+    }
+
+    extend_callback_(page_count_, new_page_count);
+    page_count_ = new_page_count;
+    bitmap_.resize((page_count_ + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+    size_t extent_num = (page_count_ + extent_size_ - 1) / extent_size_;
+    free_extent_count_ += extent_num - extent_used_.size();
+    extent_used_.resize(extent_num, 0);
+    WriteHeader();
+}
+
+void PageAllocator::WriteHeader() {
+    char buffer[META_HEADER_SIZE];
+    memset(buffer, 0, sizeof(buffer));
+    MetaHeader header{META_MAGIC, META_VERSION, PAGE_SIZE, extent_size_, page_count_};
+    memcpy(buffer, &header, sizeof(header));
+    if (pwrite(meta_fd_, buffer, sizeof(buffer), 0) != sizeof(buffer)) {
+        LOG_ERROR("failed to write metadata header, %s", strerror(errno));
+    }
+}
+
+void PageAllocator::WriteWord(size_t word_idx) {
+    off_t offset = META_HEADER_SIZE + static_cast<off_t>(word_idx) * sizeof(uint64_t);
+    if (pwrite(meta_fd_, &bitmap_[word_idx], sizeof(uint64_t), offset) != sizeof(uint64_t)) {
+        LOG_ERROR("failed to write page bitmap, %s", strerror(errno));
+    }
+}
+
+}
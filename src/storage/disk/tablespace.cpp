@@ -0,0 +1,168 @@
+/**
+ * @file tablespace.cpp
+ * @author sheep
+ * @brief implementation of tablespace
+ * @version 0.1
+ * @date 2022-06-10
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/tablespace.h"
+#include "storage/disk/disk_manager.h"
+#include "common/logger.h"
+#include "common/exception.h"
+#include "common/macros.h"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace TinyDB {
+
+Tablespace::Tablespace(const std::string &db_file,
+                       const std::vector<std::string> &data_files,
+                       uint32_t stripe_size,
+                       bool direct_io,
+                       bool has_metadata)
+    : stripe_size_(stripe_size), direct_io_(direct_io) {
+    TINYDB_ASSERT(stripe_size_ > 0, "stripe should contain at least one page");
+
+    descriptor_name_ = GetDatabaseFileName(db_file, ".tablespace");
+
+    fds_.push_back(OpenFile(db_file, false));
+    file_names_.push_back(db_file);
+
+    if (LoadDescriptor()) {
+        // existing database, the layout can't be changed. never truncate the files it lists,
+        // even if db file is empty, e.g. all the pages written so far are in other files
+        if (data_files.size() + 1 != file_names_.size() && !data_files.empty()) {
+            LOG_WARN("%s is striped across %zu files already, additional data files are ignored",
+                db_file.c_str(), file_names_.size());
+        }
+        for (size_t i = 1; i < file_names_.size(); i++) {
+            fds_.push_back(OpenFile(file_names_[i], false));
+        }
+        return;
+    }
+
+    // without descriptor, database exists only if there are pages or metadata of allocator
+    struct stat stat_buf;
+    is_new_ = !has_metadata && fstat(fds_[0], &stat_buf) == 0 && stat_buf.st_size == 0;
+
+    if (is_new_) {
+        // no descriptor lists them, content left over doesn't belong to any database
+        for (const auto &filename : data_files) {
+            file_names_.push_back(filename);
+            fds_.push_back(OpenFile(filename, true));
+        }
+        WriteDescriptor();
+        return;
+    }
+
+    // db file created before we have tablespace, all the pages are in db file
+    if (!data_files.empty()) {
+        LOG_WARN("%s is not striped, additional data files are ignored", db_file.c_str());
+    }
+    WriteDescriptor();
+}
+
+Tablespace::~Tablespace() {
+    for (auto fd : fds_) {
+        close(fd);
+    }
+}
+
+int Tablespace::OpenFile(const std::string &filename, bool truncate) {
+    // we are using raw file descriptor here since
+    // fstream is sharing a single file cursor between threads
+    int flags = O_RDWR | O_CREAT;
+    if (truncate) {
+        flags |= O_TRUNC;
+    }
+    int fd = open(filename.c_str(), direct_io_ ? flags | O_DIRECT : flags, 0644);
+    if (fd < 0 && direct_io_ && errno == EINVAL) {
+        // file system doesn't support direct I/O, e.g. tmpfs.
+        // turn it off for all data files, so buffers are handled the same way
+        LOG_WARN("direct I/O is not supported for %s, fallback to buffered I/O", filename.c_str());
+        direct_io_ = false;
+        for (size_t i = 0; i < fds_.size(); i++) {
+            int old_flags = fcntl(fds_[i], F_GETFL);
+            fcntl(fds_[i], F_SETFL, old_flags & ~O_DIRECT);
+        }
+        fd = open(filename.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        THROW_IO_EXCEPTION(
+            std::string("failed to open data file, filename: ") + filename + ", " + strerror(errno));
+    }
+    return fd;
+}
+
+bool Tablespace::ReadDescriptor(const std::string &descriptor_name, uint32_t *stripe_size,
+                                std::vector<std::string> *file_names) {
+    std::ifstream in(descriptor_name);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    *stripe_size = 0;
+    file_names->clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string key;
+        iss >> key;
+        if (key == "stripe_size") {
+            iss >> *stripe_size;
+        } else if (key == "file") {
+            // path might contain spaces
+            std::string path;
+            std::getline(iss >> std::ws, path);
+            file_names->push_back(path);
+        }
+    }
+    return *stripe_size != 0 && !file_names->empty();
+}
+
+bool Tablespace::LoadDescriptor() {
+    uint32_t stripe_size;
+    std::vector<std::string> file_names;
+    if (!ReadDescriptor(descriptor_name_, &stripe_size, &file_names)) {
+        if (access(descriptor_name_.c_str(), F_OK) == 0) {
+            LOG_WARN("invalid tablespace descriptor %s", descriptor_name_.c_str());
+        }
+        return false;
+    }
+
+    stripe_size_ = stripe_size;
+    // db file might be moved, trust the name we are given
+    file_names_.insert(file_names_.end(), file_names.begin() + 1, file_names.end());
+    return true;
+}
+
+void Tablespace::WriteDescriptor() {
+    // write to a temporary file then rename it, so we won't end up with half of the layout
+    std::string tmp_name = descriptor_name_ + ".tmp";
+    {
+        std::ofstream out(tmp_name, std::ios::trunc);
+        out << "stripe_size " << stripe_size_ << "\n";
+        for (const auto &filename : file_names_) {
+            out << "file " << filename << "\n";
+        }
+        out.flush();
+        if (!out.good()) {
+            THROW_IO_EXCEPTION("failed to write tablespace descriptor " + tmp_name);
+        }
+    }
+    if (rename(tmp_name.c_str(), descriptor_name_.c_str()) != 0) {
+        THROW_IO_EXCEPTION(std::string("failed to write tablespace descriptor, ") + strerror(errno));
+    }
+}
+
+}
@@ -0,0 +1,70 @@
+/**
+ * @file thread_pool_io_engine.cpp
+ * @author sheep
+ * @brief implementation of thread pool io engine
+ * @version 0.1
+ * @date 2022-06-05
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/thread_pool_io_engine.h"
+
+namespace TinyDB {
+
+ThreadPoolIOEngine::ThreadPoolIOEngine(uint32_t worker_num) {
+    for (uint32_t i = 0; i < worker_num; i++) {
+        worker_list_.push_back(new std::thread(&ThreadPoolIOEngine::WorkerThread, this));
+    }
+}
+
+ThreadPoolIOEngine::~ThreadPoolIOEngine() {
+    {
+        std::lock_guard<std::mutex> latch(latch_);
+        enable_running_ = false;
+    }
+    cv_.notify_all();
+
+    // workers will drain the queue before exiting
+    for (auto worker : worker_list_) {
+        worker->join();
+        delete worker;
+    }
+}
+
+void ThreadPoolIOEngine::Submit(const std::vector<IORequest> &requests) {
+    {
+        std::lock_guard<std::mutex> latch(latch_);
+        for (const auto &request : requests) {
+            queue_.push_back(request);
+        }
+    }
+
+    if (requests.size() == 1) {
+        cv_.notify_one();
+    } else {
+        cv_.notify_all();
+    }
+}
+
+void ThreadPoolIOEngine::WorkerThread() {
+    while (true) {
+        IORequest request;
+        {
+            std::unique_lock<std::mutex> latch(latch_);
+            cv_.wait(latch, [&]() { return !queue_.empty() || !enable_running_; });
+            if (queue_.empty()) {
+                // we are stopped
+                return;
+            }
+            request = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        bool res = PerformSync(request);
+        request.handle_->Complete(res);
+    }
+}
+
+}
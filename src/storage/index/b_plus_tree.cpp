@@ -65,7 +65,7 @@ bool BPLUSTREE_TYPE::Remove(const KeyType &key, BPlusTreeExecutionContext *conte
         TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(next_page != nullptr, "");
         next_page->WLatch();
 
-        BPlusTreePage *next_node = reinterpret_cast<BPlusTreePage *>(next_page);
+        BPlusTreePage *next_node = reinterpret_cast<BPlusTreePage *>(next_page->GetData());
         // both internal node and leaf node will coalesce when size < minSize
         if (next_node->GetSize() > next_node->GetMinSize()) {
             // safe, release all of the previous pages
@@ -120,6 +120,14 @@ bool BPLUSTREE_TYPE::Remove(const KeyType &key, BPlusTreeExecutionContext *conte
 
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, BPlusTreeExecutionContext *context) {
+    // most of the time nobody is modifying the path we are walking
+    for (int i = 0; i < OPTIMISTIC_READ_RETRY; i++) {
+        bool found;
+        if (OptimisticGetValue(key, result, &found)) {
+            return found;
+        }
+    }
+
     root_latch_.lock();
     bool rootLocked = true;
     if (IsEmpty()) {
@@ -174,6 +182,88 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
     return res;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::OptimisticGetValue(const KeyType &key, std::vector<ValueType> *result, bool *found) {
+    page_id_t page_id = root_page_id_.load();
+    if (page_id == INVALID_PAGE_ID) {
+        *found = false;
+        return true;
+    }
+
+    Page *page = buffer_pool_manager_->FetchResidentPage(page_id);
+    if (page == nullptr) {
+        return false;
+    }
+    // pages we've got from FetchResidentPage, they are counted as hits only when we succeed
+    std::vector<page_id_t> resident_pages{page_id};
+    uint64_t version;
+    if (!page->TryOptimisticRLatch(&version)) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return false;
+    }
+    // root might be split or collapsed after we read its id
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    bool is_root = node->IsRootPage();
+    if (!page->ValidateOptimisticRLatch(version) || !is_root || root_page_id_.load() != page_id) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return false;
+    }
+
+    while (!node->IsLeafPage()) {
+        page_id_t child_id;
+        if (!reinterpret_cast<InternalPage *>(node)->OptimisticLookup(key, &child_id, comparator_, page, version)) {
+            buffer_pool_manager_->UnpinPage(page_id, false);
+            return false;
+        }
+
+        Page *child = buffer_pool_manager_->FetchResidentPage(child_id);
+        if (child != nullptr) {
+            resident_pages.push_back(child_id);
+        } else {
+            // child is not cached. child might be deleted after we validated the parent, and
+            // reading it from disk would revive a dead page. hold the parent still while loading
+            page->RLatch();
+            if (page->ValidateOptimisticRLatch(version)) {
+                child = buffer_pool_manager_->FetchPage(child_id);
+            }
+            page->RUnlatch();
+            if (child == nullptr) {
+                buffer_pool_manager_->UnpinPage(page_id, false);
+                return false;
+            }
+        }
+
+        // parent is validated after we've got the version of child, so child
+        // wasn't split or merged in between
+        uint64_t child_version;
+        bool valid = child->TryOptimisticRLatch(&child_version) && page->ValidateOptimisticRLatch(version);
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        if (!valid) {
+            buffer_pool_manager_->UnpinPage(child_id, false);
+            return false;
+        }
+
+        page = child;
+        page_id = child_id;
+        version = child_version;
+        node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    }
+
+    ValueType v;
+    bool valid = reinterpret_cast<LeafPage *>(node)->OptimisticLookup(key, &v, found, comparator_, page, version);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (!valid) {
+        return false;
+    }
+    for (auto resident_page_id : resident_pages) {
+        buffer_pool_manager_->RecordHit(resident_page_id);
+    }
+    if (*found) {
+        result->push_back(v);
+    }
+    return true;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
     page_id_t new_page_id;
@@ -308,7 +398,8 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
     page_id_t new_page_id;
-    Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
+    // new node is the right sibling of old node, try to keep them physically adjacent
+    Page *new_page = buffer_pool_manager_->NewPage(&new_page_id, node->GetPageId());
     TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(new_page != nullptr, "");
 
     if (node->IsLeafPage()) {
@@ -32,6 +32,7 @@ BPLUSTREE_ITERATOR_TYPE::BPlusTreeIterator(BufferPoolManager *bpm,
     // store the key
     key_ = leaf_page_->KeyAt(index);
     retry_cnt_ = 0;
+    read_ahead_.OnPage(buffer_pool_manager_, page_id_, leaf_page_->GetNextPageId());
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -78,6 +79,7 @@ bool BPLUSTREE_ITERATOR_TYPE::AdvanceHelper() {
             page_ = next_page;
             index_ = 0;
             key_ = leaf_page_->KeyAt(index_);
+            read_ahead_.OnPage(buffer_pool_manager_, page_id_, leaf_page_->GetNextPageId());
             return true;
         }
         // !!! if we failed to acquire the latch, then we need to unpin next_page
@@ -98,10 +100,15 @@ bool BPLUSTREE_ITERATOR_TYPE::AdvanceHelper() {
         // transfer the ownership from FindHelper to me, which means i'm responsible to
         // release the lock on that page and unpin that page
         auto [page, index] = tree_->FindHelper(key_);
+        if (page == nullptr) {
+            // tree was emptied by concurrent deletions, nothing left to read
+            return true;
+        }
         page_ = page;
         index_ = index;
         leaf_page_ = reinterpret_cast<LeafPage *> (page->GetData());
         page_id_ = page->GetPageId();
+        read_ahead_.OnPage(buffer_pool_manager_, page_id_, leaf_page_->GetNextPageId());
         // if we've read the higher key, then it means advance succeed
         if (tree_->comparator_(leaf_page_->KeyAt(index_), key_) > 0) {
             // update the key
@@ -64,6 +64,32 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
     return ValueAt(lb);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::OptimisticLookup(const KeyType &key, ValueType *value, const KeyComparator &comparator,
+                                                      Page *page, uint64_t version) const {
+    // same as Lookup, but check every copy we made before trusting it
+    int size = GetSize();
+    if (!page->ValidateOptimisticRLatch(version)) {
+        return false;
+    }
+    int lb = 0;
+    int ub = size;
+    while (ub - lb > 1) {
+        int mid = (ub + lb) / 2;
+        KeyType mid_key = KeyAt(mid);
+        if (!page->ValidateOptimisticRLatch(version)) {
+            return false;
+        }
+        if (comparator(key, mid_key) >= 0) {
+            lb = mid;
+        } else {
+            ub = mid;
+        }
+    }
+    *value = ValueAt(lb);
+    return page->ValidateOptimisticRLatch(version);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) {
     IncreaseSize(1);
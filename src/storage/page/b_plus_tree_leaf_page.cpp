@@ -127,6 +127,45 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
     return false;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::OptimisticLookup(const KeyType &key, ValueType *value, bool *found, const KeyComparator &comparator,
+                                                  Page *page, uint64_t version) const {
+    // same as Lookup, but check every copy we made before trusting it
+    int size = GetSize();
+    if (!page->ValidateOptimisticRLatch(version)) {
+        return false;
+    }
+    *found = false;
+    if (size == 0) {
+        return true;
+    }
+    int lb = -1;
+    int ub = size - 1;
+    while (ub - lb > 1) {
+        int mid = (ub + lb) / 2;
+        KeyType mid_key = KeyAt(mid);
+        if (!page->ValidateOptimisticRLatch(version)) {
+            return false;
+        }
+        if (comparator(mid_key, key) >= 0) {
+            ub = mid;
+        } else {
+            lb = mid;
+        }
+    }
+    MappingType item = array_[ub];
+    if (!page->ValidateOptimisticRLatch(version)) {
+        return false;
+    }
+    if (comparator(item.first, key) == 0) {
+        *found = true;
+        if (value != nullptr) {
+            *value = item.second;
+        }
+    }
+    return true;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
     auto ub = KeyIndex(key, comparator);
@@ -275,6 +275,38 @@ bool TablePage::GetTuple(const RID &rid, Tuple *tuple) {
     return true;
 }
 
+bool TablePage::OptimisticGetTuple(const RID &rid, Tuple *tuple, bool *found, Page *page, uint64_t version) {
+    // page id doesn't change while the page is pinned
+    TINYDB_ASSERT(rid.GetPageId() == GetPageId(), "Wrong page");
+    uint32_t slot_id = rid.GetSlotId();
+    uint32_t tuple_cnt = GetTupleCount();
+    if (!page->ValidateOptimisticRLatch(version)) {
+        return false;
+    }
+    *found = false;
+    if (slot_id >= tuple_cnt) {
+        return true;
+    }
+
+    auto tuple_size = GetTupleSize(slot_id);
+    auto tuple_offset = GetTupleOffset(slot_id);
+    if (!page->ValidateOptimisticRLatch(version)) {
+        return false;
+    }
+    if (IsDeleted(tuple_size)) {
+        return true;
+    }
+
+    // the copy might be torn, check it again
+    tuple->DeserializeFromInplace(GetRawPointer() + tuple_offset, tuple_size);
+    if (!page->ValidateOptimisticRLatch(version)) {
+        return false;
+    }
+    tuple->SetRID(rid);
+    *found = true;
+    return true;
+}
+
 // i think we should only skip those tuple that is really deleted instead of just a mark
 // since txn may get aborted, and deletion may fail
 bool TablePage::GetFirstTupleRid(RID *first_rid) {
@@ -16,13 +16,15 @@
 
 namespace TinyDB {
 
-Result<> TableHeap::InsertTuple(const Tuple &tuple, RID *rid, TransactionContext *txn, const std::function<void(const RID &)> &callback) {
+Result<> TableHeap::InsertTuple(const Tuple &tuple, RID *rid, TransactionContext *txn,
+                                const std::function<void(const RID &)> &callback,
+                                BufferAccessStrategy *strategy) {
     // we couldn't store it anyway
     if (tuple.GetSize() + TablePage::SIZE_TABLE_PAGE_HEADER + TablePage::SIZE_SLOT > PAGE_SIZE) {
         THROW_NOT_IMPLEMENTED_EXCEPTION("TinyDB Couldn't support very large tuple");
     }
 
-    auto cur_page = buffer_pool_manager_->FetchPage(first_page_id_);
+    auto cur_page = buffer_pool_manager_->FetchPage(first_page_id_, strategy);
     if (cur_page == nullptr) {
         // we run out of memory, return false directly
         return Result(ErrorCode::OUT_OF_MEMORY);
@@ -38,7 +40,7 @@ Result<> TableHeap::InsertTuple(const Tuple &tuple, RID *rid, TransactionContext
         if (next_page_id != INVALID_PAGE_ID) {
             cur_page->WUnlatch();
             buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-            cur_page = buffer_pool_manager_->FetchPage(next_page_id);
+            cur_page = buffer_pool_manager_->FetchPage(next_page_id, strategy);
             if (cur_page == nullptr) {
                 // we are not holding any lock
                 return Result(ErrorCode::OUT_OF_MEMORY);
@@ -46,7 +48,8 @@ Result<> TableHeap::InsertTuple(const Tuple &tuple, RID *rid, TransactionContext
             cur_page->WLatch();
         } else {
             // otherwise, we need to create a new page
-            auto new_page = buffer_pool_manager_->NewPage(&next_page_id);
+            // place the new page right after current page, so scan could be sequential
+            auto new_page = buffer_pool_manager_->NewPage(&next_page_id, cur_page->GetPageId(), strategy);
             if (new_page == nullptr) {
                 cur_page->WUnlatch();
                 buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
@@ -154,16 +157,26 @@ void TableHeap::RollbackDelete(const RID &rid, TransactionContext *txn) {
     buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 }
 
-Result<> TableHeap::GetTuple(const RID &rid, Tuple *tuple) {
-    auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
+Result<> TableHeap::GetTuple(const RID &rid, Tuple *tuple, BufferAccessStrategy *strategy) {
+    auto page = buffer_pool_manager_->FetchPage(rid.GetPageId(), strategy);
     if (page == nullptr) {
         return Result(ErrorCode::OUT_OF_MEMORY);
     }
     auto table_page = reinterpret_cast<TablePage *> (page->GetData());
 
-    page->RLatch();
-    bool res = table_page->GetTuple(rid, tuple);
-    page->RUnlatch();
+    // read it without latch first, so that readers of a hot page won't write to it
+    bool res = false;
+    bool valid = false;
+    uint64_t version;
+    for (int i = 0; i < OPTIMISTIC_READ_RETRY && !valid; i++) {
+        valid = page->TryOptimisticRLatch(&version)
+            && table_page->OptimisticGetTuple(rid, tuple, &res, page, version);
+    }
+    if (!valid) {
+        page->RLatch();
+        res = table_page->GetTuple(rid, tuple);
+        page->RUnlatch();
+    }
     buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
 
     if (res) {
@@ -174,11 +187,11 @@ Result<> TableHeap::GetTuple(const RID &rid, Tuple *tuple) {
     }
 }
 
-TableIterator TableHeap::Begin() {
+TableIterator TableHeap::Begin(BufferAccessStrategy *strategy) {
     TINYDB_ASSERT(first_page_id_ != INVALID_PAGE_ID, "invalid table heap");
     // default is invalid RID
     RID rid;
-    auto cur_page = buffer_pool_manager_->FetchPage(first_page_id_);
+    auto cur_page = buffer_pool_manager_->FetchPage(first_page_id_, strategy);
     TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(cur_page != nullptr, "");
     // same logic as operator++ for table iterator
     cur_page->RLatch();
@@ -187,7 +200,7 @@ TableIterator TableHeap::Begin() {
 
     if (!table_page->GetFirstTupleRid(&rid)) {
         while (table_page->GetNextPageId() != INVALID_PAGE_ID) {
-            auto next_page = buffer_pool_manager_->FetchPage(table_page->GetNextPageId());
+            auto next_page = buffer_pool_manager_->FetchPage(table_page->GetNextPageId(), strategy);
             TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(next_page != nullptr, "");
 
             cur_page->RUnlatch();
@@ -205,7 +218,7 @@ TableIterator TableHeap::Begin() {
 
     cur_page->RUnlatch();
     buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-    return TableIterator(this, rid);
+    return TableIterator(this, rid, strategy);
 }
 
 TableIterator TableHeap::End() {
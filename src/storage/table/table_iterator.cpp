@@ -18,7 +18,7 @@ namespace TinyDB {
 void TableIterator::GetTuple() {
     // At the end of the day, we wil call deserialize in tuple
     // which will handle previous tuple buffer for us
-    bool res = table_heap_->GetTuple(rid_, &tuple_).IsOk();
+    bool res = table_heap_->GetTuple(rid_, &tuple_, strategy_).IsOk();
     // log the event
     if (!res) {
         LOG_INFO("Reading Invalid tuple though table iterator RID: %s", rid_.ToString().c_str());
@@ -47,7 +47,7 @@ TableIterator &TableIterator::operator++() {
     TINYDB_ASSERT(rid_.GetPageId() != INVALID_PAGE_ID, "logic error");
 
     BufferPoolManager *bpm = table_heap_->buffer_pool_manager_;
-    auto cur_page = bpm->FetchPage(rid_.GetPageId());
+    auto cur_page = bpm->FetchPage(rid_.GetPageId(), strategy_);
     // we should find a good way to handle out of memory issue here
     TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(cur_page != nullptr, "");
     cur_page->RLatch();
@@ -55,13 +55,14 @@ TableIterator &TableIterator::operator++() {
     // we will not hold two latches at the same time
     // so there won't be a deadlock issue
     auto table_page = reinterpret_cast<TablePage *> (cur_page->GetData());
+    read_ahead_.OnPage(bpm, cur_page->GetPageId(), table_page->GetNextPageId(), strategy_);
 
     RID next_tuple_rid;
     if (!table_page->GetNextTupleRid(rid_, &next_tuple_rid)) {
         // if we at the end of this page, try to fetch next page
         while (table_page->GetNextPageId() != INVALID_PAGE_ID) {
-            auto next_page = bpm->FetchPage(table_page->GetNextPageId());
-            TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(cur_page != nullptr, "");
+            auto next_page = bpm->FetchPage(table_page->GetNextPageId(), strategy_);
+            TINYDB_CHECK_OR_THROW_OUT_OF_MEMORY_EXCEPTION(next_page != nullptr, "");
 
             cur_page->RUnlatch();
             bpm->UnpinPage(cur_page->GetPageId(), false);
@@ -69,6 +70,7 @@ TableIterator &TableIterator::operator++() {
             cur_page->RLatch();
 
             table_page = reinterpret_cast<TablePage *> (cur_page->GetData());
+            read_ahead_.OnPage(bpm, cur_page->GetPageId(), table_page->GetNextPageId(), strategy_);
             if (table_page->GetFirstTupleRid(&next_tuple_rid)) {
                 break;
             }
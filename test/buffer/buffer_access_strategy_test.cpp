@@ -0,0 +1,127 @@
+/**
+ * @file buffer_access_strategy_test.cpp
+ * @author sheep
+ * @brief unit test for buffer access strategy
+ * @version 0.1
+ * @date 2022-06-22
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(BufferAccessStrategyTest, RingTest) {
+    int a, b;
+    BufferAccessStrategy strategy(3);
+    page_id_t page_id;
+    frame_id_t frame_id;
+
+    // nothing to reuse until the ring is full
+    strategy.Add(&a, 10, 0);
+    strategy.Add(&b, 11, 1);
+    EXPECT_FALSE(strategy.GetVictim(&a, &page_id, &frame_id));
+    strategy.Add(&a, 12, 2);
+
+    // oldest slot of the owner
+    EXPECT_TRUE(strategy.GetVictim(&b, &page_id, &frame_id));
+    EXPECT_EQ(11, page_id);
+    EXPECT_EQ(1, frame_id);
+    strategy.Add(&b, 13, 1);
+    EXPECT_TRUE(strategy.GetVictim(&a, &page_id, &frame_id));
+    EXPECT_EQ(10, page_id);
+    EXPECT_EQ(0, frame_id);
+    strategy.Add(&a, 14, 0);
+
+    // no slot of this owner, oldest one is dropped
+    int c;
+    EXPECT_FALSE(strategy.GetVictim(&c, &page_id, &frame_id));
+    strategy.Add(&c, 15, 5);
+    EXPECT_TRUE(strategy.GetVictim(&a, &page_id, &frame_id));
+    EXPECT_EQ(14, page_id);
+
+    // ring never takes more than 1/8 of the buffer pool
+    EXPECT_EQ(1, BufferAccessStrategy(BufferAccessType::BULK_READ, 4).GetRingSize());
+    // with large pages, the ring could be smaller than that
+    EXPECT_EQ(std::max<size_t>(std::min<size_t>(BufferAccessStrategy::BULK_READ_RING_BYTES / PAGE_SIZE, 64 / 8), 1),
+              BufferAccessStrategy(BufferAccessType::BULK_READ, 64).GetRingSize());
+    EXPECT_EQ(BufferAccessStrategy::BULK_READ_RING_BYTES / PAGE_SIZE,
+              BufferAccessStrategy(BufferAccessType::BULK_READ, 1 << 20).GetRingSize());
+}
+
+// create hot pages, then read cold pages through the pool. returns number of reads
+// it takes to fetch hot pages again
+static uint64_t ScanAndCountHotMisses(BufferPoolManager *bpm, MemoryDiskManager *disk_manager,
+                                      BufferAccessStrategy *strategy) {
+    const size_t hot_num = 8;
+    const size_t cold_num = bpm->GetPoolSize() * 4;
+
+    std::vector<page_id_t> hot(hot_num);
+    for (auto &page_id : hot) {
+        EXPECT_NE(bpm->NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    // cold pages are created through the ring as well
+    std::vector<page_id_t> cold(cold_num);
+    for (auto &page_id : cold) {
+        auto page = bpm->NewPage(&page_id, INVALID_PAGE_ID, strategy);
+        EXPECT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "cold %d", page_id);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    for (auto page_id : cold) {
+        auto page = bpm->FetchPage(page_id, strategy);
+        EXPECT_NE(page, nullptr);
+        EXPECT_EQ(std::string(page->GetData()), "cold " + std::to_string(page_id));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    disk_manager->ResetIOStats();
+    for (auto page_id : hot) {
+        EXPECT_NE(bpm->FetchPage(page_id), nullptr);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    EXPECT_TRUE(bpm->CheckPinCount());
+    return disk_manager->GetIOStats().page_read_.ops_;
+}
+
+TEST(BufferAccessStrategyTest, ScanResistanceTest) {
+    const size_t buffer_pool_size = 32;
+
+    {
+        // without a ring, the scan flushes the whole pool
+        MemoryDiskManager disk_manager;
+        BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+        EXPECT_EQ(8, ScanAndCountHotMisses(&bpm, &disk_manager, nullptr));
+    }
+
+    for (auto type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K}) {
+        MemoryDiskManager disk_manager;
+        BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager, type);
+        BufferAccessStrategy strategy(4);
+        EXPECT_EQ(0, ScanAndCountHotMisses(&bpm, &disk_manager, &strategy));
+    }
+}
+
+TEST(BufferAccessStrategyTest, ParallelTest) {
+    MemoryDiskManager disk_manager;
+    ParallelBufferPoolManager bpm(4, 8, &disk_manager);
+    // each instance gets its share of the ring
+    BufferAccessStrategy strategy(8);
+    EXPECT_EQ(0, ScanAndCountHotMisses(&bpm, &disk_manager, &strategy));
+}
+
+}
@@ -0,0 +1,190 @@
+/**
+ * @file buffer_pool_dumper_test.cpp
+ * @author sheep
+ * @brief unit test for buffer pool dump and warm-up
+ * @version 0.1
+ * @date 2022-06-28
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/buffer_pool_dumper.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+// 32 pages are created, 16 to 31 are cached and 24 to 31 are the hot ones
+static void PrepareBufferPool(BufferPoolManager *bpm) {
+    for (int i = 0; i < 32; i++) {
+        page_id_t page_id;
+        auto page = bpm->NewPage(&page_id);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    for (page_id_t page_id = 24; page_id < 32; page_id++) {
+        ASSERT_NE(bpm->FetchPage(page_id), nullptr);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+}
+
+TEST(BufferPoolDumperTest, DumpTest) {
+    const std::string filename = "buffer_pool_dumper_test.dump";
+    remove(filename.c_str());
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(16, &disk_manager);
+    BufferPoolDumper dumper(&bpm, filename);
+    EXPECT_TRUE(dumper.ReadDump().empty());
+
+    PrepareBufferPool(&bpm);
+    // someone is using page 16
+    ASSERT_NE(bpm.FetchPage(16), nullptr);
+
+    std::vector<std::pair<page_id_t, uint32_t>> pages;
+    bpm.GetResidentPages(&pages);
+    EXPECT_EQ(16, pages.size());
+
+    // pinned one first, then the rest from the most recently used
+    EXPECT_EQ(16, dumper.Dump());
+    auto dump = dumper.ReadDump();
+    ASSERT_EQ(16, dump.size());
+    EXPECT_EQ(std::make_pair(16, BufferPoolManager::MAX_TEMPERATURE), dump[0]);
+    EXPECT_EQ(31, dump[1].first);
+    EXPECT_EQ(24, dump[8].first);
+    EXPECT_EQ(17, dump[15].first);
+    for (size_t i = 1; i < dump.size(); i++) {
+        EXPECT_LE(dump[i].second, dump[i - 1].second);
+    }
+    EXPECT_TRUE(bpm.UnpinPage(16, false));
+
+    // garbage is skipped
+    {
+        std::ofstream out(filename, std::ios::app);
+        out << "garbage\n";
+    }
+    EXPECT_EQ(16, dumper.ReadDump().size());
+    remove(filename.c_str());
+}
+
+TEST(BufferPoolDumperTest, WarmUpTest) {
+    const std::string filename = "buffer_pool_dumper_test.dump";
+    remove(filename.c_str());
+    MemoryDiskManager disk_manager;
+    BufferPoolDumpConfig config;
+    config.warm_up_fraction_ = 0.5;
+
+    {
+        BufferPoolManagerInstance bpm(16, &disk_manager);
+        PrepareBufferPool(&bpm);
+        BufferPoolDumper dumper(&bpm, filename, config);
+        EXPECT_EQ(16, dumper.Dump());
+        bpm.FlushAllPages();
+    }
+
+    // restart. only half of the pool is warmed up, those are the hot ones
+    BufferPoolManagerInstance bpm(16, &disk_manager);
+    BufferPoolDumper dumper(&bpm, filename, config);
+    EXPECT_EQ(8, dumper.WarmUp());
+    for (page_id_t page_id = 24; page_id < 32; page_id++) {
+        auto page = bpm.FetchPage(page_id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ("page " + std::to_string(page_id), page->GetData());
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    auto stats = bpm.GetStats();
+    EXPECT_EQ(8, stats.hits_);
+    EXPECT_EQ(0, stats.misses_);
+    ASSERT_NE(bpm.FetchPage(23), nullptr);
+    EXPECT_TRUE(bpm.UnpinPage(23, false));
+    EXPECT_EQ(1, bpm.GetStats().misses_);
+    EXPECT_TRUE(bpm.CheckPinCount());
+    remove(filename.c_str());
+
+    // nothing to warm up
+    EXPECT_EQ(0, dumper.WarmUp());
+}
+
+TEST(BufferPoolDumperTest, ParallelTest) {
+    const std::string filename = "buffer_pool_dumper_test.dump";
+    remove(filename.c_str());
+    MemoryDiskManager disk_manager;
+    BufferPoolDumpConfig config;
+    config.warm_up_fraction_ = 1;
+
+    {
+        ParallelBufferPoolManager bpm(2, 8, &disk_manager);
+        PrepareBufferPool(&bpm);
+        BufferPoolDumper dumper(&bpm, filename, config);
+        EXPECT_EQ(16, dumper.Dump());
+        bpm.FlushAllPages();
+    }
+
+    ParallelBufferPoolManager bpm(2, 8, &disk_manager);
+    BufferPoolDumper dumper(&bpm, filename, config);
+    EXPECT_EQ(16, dumper.WarmUp());
+    for (page_id_t page_id = 16; page_id < 32; page_id++) {
+        auto page = bpm.FetchPage(page_id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ("page " + std::to_string(page_id), page->GetData());
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    EXPECT_EQ(0, bpm.GetStats().misses_);
+    EXPECT_TRUE(bpm.CheckPinCount());
+    remove(filename.c_str());
+}
+
+TEST(BufferPoolDumperTest, PeriodicDumpTest) {
+    const std::string filename = "buffer_pool_dumper_test.dump";
+    remove(filename.c_str());
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(16, &disk_manager);
+    PrepareBufferPool(&bpm);
+
+    BufferPoolDumpConfig config;
+    config.interval_ = std::chrono::milliseconds(10);
+    BufferPoolDumper dumper(&bpm, filename, config);
+    dumper.StartPeriodicDump();
+    for (int i = 0; i < 200 && dumper.ReadDump().empty(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    dumper.StopPeriodicDump();
+    EXPECT_EQ(16, dumper.ReadDump().size());
+    remove(filename.c_str());
+}
+
+TEST(BufferPoolDumperTest, DumpOnShutdownTest) {
+    const std::string filename = "buffer_pool_dumper_test.dump";
+    remove(filename.c_str());
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(16, &disk_manager);
+    PrepareBufferPool(&bpm);
+
+    // nothing is written unless we ask for it
+    {
+        BufferPoolDumper dumper(&bpm, filename);
+    }
+    BufferPoolDumper reader(&bpm, filename);
+    EXPECT_TRUE(reader.ReadDump().empty());
+
+    BufferPoolDumpConfig config;
+    config.dump_on_shutdown_ = true;
+    {
+        BufferPoolDumper dumper(&bpm, filename, config);
+    }
+    EXPECT_EQ(16, reader.ReadDump().size());
+    remove(filename.c_str());
+}
+
+}
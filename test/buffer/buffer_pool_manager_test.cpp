@@ -1,10 +1,15 @@
-#include "storage/disk/disk_manager.h"
-#include "buffer/buffer_pool_manager.h"
+#include "storage/disk/file_disk_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/latency_disk_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 #include <gtest/gtest.h>
 #include <string>
 #include <random>
 #include <cstring>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -20,8 +25,8 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
     // generate random number range from 0 to max
     std::uniform_int_distribution<char> dis(0);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     int page_id[buffer_pool_size * 2];
     auto page0 = bpm->NewPage(&page_id[0]);
@@ -73,7 +78,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
     delete bpm;
     delete disk_manager;
 
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 TEST(BufferPoolManagerTest, ConcurrentTest) {
@@ -83,8 +88,8 @@ TEST(BufferPoolManagerTest, ConcurrentTest) {
     const size_t total_page_size = 10;
     const size_t iteration_num = 10;
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     std::vector<page_id_t> page_list(total_page_size);
     // allocate total_page_size pages
@@ -149,7 +154,123 @@ TEST(BufferPoolManagerTest, ConcurrentTest) {
     delete bpm;
     delete disk_manager;
 
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
-}
\ No newline at end of file
+TEST(BufferPoolManagerTest, IOOutsideLatchTest) {
+    const size_t buffer_pool_size = 4;
+
+    MemoryDiskManager memory_disk_manager;
+    DeviceProfile profile;
+    profile.queue_depth_ = 8;
+    LatencyDiskManager disk_manager(&memory_disk_manager, profile);
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+
+    // the first page will be evicted by the rest
+    std::vector<page_id_t> page_list(buffer_pool_size + 1);
+    for (auto &page_id : page_list) {
+        auto page = bpm.NewPage(&page_id);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+    }
+    page_id_t cold_page_id = page_list[0];
+    page_id_t hot_page_id = page_list.back();
+    disk_manager.ResetIOStats();
+
+    // two threads miss the same page, only one of them should read it.
+    // the read is stuck in the device until we resume it
+    disk_manager.Pause();
+    std::vector<std::thread> worker_list;
+    for (int i = 0; i < 2; i++) {
+        worker_list.emplace_back([&]() {
+            auto page = bpm.FetchPage(cold_page_id);
+            ASSERT_NE(page, nullptr);
+            EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(cold_page_id));
+            EXPECT_TRUE(bpm.UnpinPage(cold_page_id, false));
+        });
+    }
+    disk_manager.WaitForStalled(1);
+
+    // hit shouldn't wait for the read. if it does, it never completes, the timeout
+    // only keeps the test from hanging
+    auto hit = std::async(std::launch::async, [&]() {
+        auto page = bpm.FetchPage(hot_page_id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(hot_page_id, false));
+    });
+    EXPECT_EQ(hit.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    EXPECT_EQ(disk_manager.GetIOStats().page_read_.ops_, 0);
+
+    disk_manager.Resume();
+    hit.wait();
+    for (auto &worker : worker_list) {
+        worker.join();
+    }
+    EXPECT_EQ(disk_manager.GetIOStats().page_read_.ops_, 1);
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(BufferPoolManagerTest, FlushBusyFramesTest) {
+    // runs the hook before the first write
+    class HookedDiskManager : public MemoryDiskManager {
+    public:
+        void WritePage(page_id_t pageId, const char *data) override {
+            auto hook = std::move(write_hook_);
+            write_hook_ = nullptr;
+            if (hook != nullptr) {
+                hook();
+            }
+            MemoryDiskManager::WritePage(pageId, data);
+        }
+
+        std::function<void()> write_hook_;
+    };
+
+    HookedDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(1, &disk_manager);
+
+    page_id_t page_id0;
+    auto page = bpm.NewPage(&page_id0);
+    ASSERT_NE(page, nullptr);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id0);
+    EXPECT_TRUE(bpm.UnpinPage(page_id0, true));
+
+    // page 0 is evicted by page 1, write-back is blocked until we let it go
+    std::promise<void> writing;
+    std::promise<void> release;
+    disk_manager.write_hook_ = [&]() {
+        writing.set_value();
+        release.get_future().wait();
+    };
+    page_id_t page_id1;
+    std::thread evictor([&]() {
+        auto page = bpm.NewPage(&page_id1);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id1);
+        EXPECT_TRUE(bpm.UnpinPage(page_id1, true));
+    });
+    writing.get_future().wait();
+
+    // page 0 is being written back, and the frame is busy. flush should wait for both.
+    // the delay only gives a flush skipping them the chance to return early
+    std::thread flusher([&]() {
+        bpm.FlushAllPages();
+        char buffer[PAGE_SIZE];
+        disk_manager.ReadPage(page_id0, buffer);
+        EXPECT_EQ(std::string(buffer), "page " + std::to_string(page_id0));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release.set_value();
+    evictor.join();
+    flusher.join();
+
+    // page 1 was dirtied after the flush started, it's not necessarily on disk
+    bpm.FlushAllPages();
+    char buffer[PAGE_SIZE];
+    disk_manager.ReadPage(page_id1, buffer);
+    EXPECT_EQ(std::string(buffer), "page " + std::to_string(page_id1));
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+}
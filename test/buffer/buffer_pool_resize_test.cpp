@@ -0,0 +1,234 @@
+/**
+ * @file buffer_pool_resize_test.cpp
+ * @author sheep
+ * @brief unit test for online buffer pool resizing
+ * @version 0.1
+ * @date 2022-06-27
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(BufferPoolResizeTest, GrowTest) {
+    MemoryDiskManager disk_manager;
+    FrameArenaConfig config;
+    config.max_pool_size_ = 16;
+    BufferPoolManagerInstance bpm(4, &disk_manager, ReplacerType::LRU, config);
+    EXPECT_EQ(4, bpm.GetPoolSize());
+    EXPECT_EQ(16, bpm.GetMaxPoolSize());
+
+    std::vector<page_id_t> page_ids(16);
+    for (size_t i = 0; i < 4; i++) {
+        auto page = bpm.NewPage(&page_ids[i]);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_ids[i]);
+    }
+    page_id_t page_id;
+    EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+
+    EXPECT_FALSE(bpm.Resize(0));
+    EXPECT_FALSE(bpm.Resize(17));
+    EXPECT_TRUE(bpm.Resize(16));
+    EXPECT_EQ(16, bpm.GetPoolSize());
+    for (size_t i = 4; i < 16; i++) {
+        auto page = bpm.NewPage(&page_ids[i]);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_ids[i]);
+    }
+    EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+    for (auto id : page_ids) {
+        EXPECT_TRUE(bpm.UnpinPage(id, true));
+    }
+
+    // nothing is pinned, pages of removed frames are moved or evicted right away
+    EXPECT_TRUE(bpm.Resize(2));
+    EXPECT_EQ(2, bpm.GetPoolSize());
+    for (auto id : page_ids) {
+        auto page = bpm.FetchPage(id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ("page " + std::to_string(id), page->GetData());
+        EXPECT_TRUE(bpm.UnpinPage(id, false));
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(BufferPoolResizeTest, ShrinkTest) {
+    const size_t buffer_pool_size = 8;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+
+    // page i lives in frame 7 - i
+    std::vector<Page *> pages;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+        page_id_t page_id;
+        auto page = bpm.NewPage(&page_id);
+        ASSERT_NE(page, nullptr);
+        ASSERT_EQ(static_cast<page_id_t>(i), page_id);
+        snprintf(page->GetData(), PAGE_SIZE, "page %zu", i);
+        pages.push_back(page);
+    }
+    // page 0 is still in use, the rest are dirty
+    for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+        EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+    }
+    bpm.ResetStats();
+
+    // page 1 to 3 are moved to the frames we keep, taking the place of the colder ones
+    EXPECT_TRUE(bpm.Resize(4));
+    EXPECT_EQ(4, bpm.GetPoolSize());
+    auto stats = bpm.GetStats();
+    EXPECT_EQ(3, stats.evictions_);
+    EXPECT_EQ(3, stats.dirty_write_backs_);
+    auto page = bpm.FetchPage(1);
+    ASSERT_NE(page, nullptr);
+    EXPECT_STREQ("page 1", page->GetData());
+    EXPECT_TRUE(bpm.UnpinPage(1, false));
+    EXPECT_EQ(1, bpm.GetStats().hits_);
+
+    // pinned page is untouched, it's moved when we are done with it
+    EXPECT_STREQ("page 0", pages[0]->GetData());
+    snprintf(pages[0]->GetData(), PAGE_SIZE, "page 0 modified");
+    EXPECT_TRUE(bpm.UnpinPage(0, true));
+
+    // only 4 frames are left
+    for (page_id_t page_id = 0; page_id < 4; page_id++) {
+        ASSERT_NE(bpm.FetchPage(page_id), nullptr);
+    }
+    page_id_t page_id;
+    EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+    EXPECT_EQ(nullptr, bpm.FetchPage(4));
+    for (page_id_t page_id = 0; page_id < 4; page_id++) {
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+        auto page = bpm.FetchPage(page_id);
+        ASSERT_NE(page, nullptr);
+        auto expected = page_id == 0 ? std::string("page 0 modified") : "page " + std::to_string(page_id);
+        EXPECT_EQ(expected, page->GetData());
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+
+    // grow back to the initial size
+    EXPECT_FALSE(bpm.Resize(buffer_pool_size + 1));
+    EXPECT_TRUE(bpm.Resize(buffer_pool_size));
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+        ASSERT_NE(bpm.FetchPage(page_id), nullptr);
+    }
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(BufferPoolResizeTest, ConcurrentTest) {
+    const int page_num = 128;
+    const int worker_num = 4;
+    const int round_num = 2000;
+    std::vector<ReplacerType> types = {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K};
+
+    for (auto type : types) {
+        MemoryDiskManager disk_manager;
+        FrameArenaConfig config;
+        config.max_pool_size_ = 64;
+        BufferPoolManagerInstance bpm(16, &disk_manager, type, config);
+        for (int i = 0; i < page_num; i++) {
+            page_id_t page_id;
+            auto page = bpm.NewPage(&page_id);
+            ASSERT_NE(page, nullptr);
+            snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+            EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+        }
+
+        std::atomic<bool> stop(false);
+        std::thread resizer([&]() {
+            std::vector<size_t> sizes = {8, 64, 4, 32, 16};
+            for (size_t i = 0; !stop.load(); i++) {
+                EXPECT_TRUE(bpm.Resize(sizes[i % sizes.size()]));
+                std::this_thread::yield();
+            }
+        });
+
+        // every page always holds its own id, half of the accesses make it dirty
+        std::vector<std::thread> workers;
+        for (int i = 0; i < worker_num; i++) {
+            workers.emplace_back([&](int seed) {
+                std::mt19937 rng(seed);
+                for (int j = 0; j < round_num; j++) {
+                    page_id_t page_id = rng() % page_num;
+                    auto page = bpm.FetchPage(page_id);
+                    if (page == nullptr) {
+                        continue;
+                    }
+                    page->RLatch();
+                    EXPECT_EQ("page " + std::to_string(page_id), page->GetData());
+                    page->RUnlatch();
+                    EXPECT_TRUE(bpm.UnpinPage(page_id, j % 2 == 0));
+                }
+            }, i);
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        stop.store(true);
+        resizer.join();
+
+        EXPECT_TRUE(bpm.Resize(4));
+        for (page_id_t page_id = 0; page_id < page_num; page_id++) {
+            auto page = bpm.FetchPage(page_id);
+            ASSERT_NE(page, nullptr);
+            EXPECT_EQ("page " + std::to_string(page_id), page->GetData());
+            EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+        }
+        EXPECT_TRUE(bpm.CheckPinCount());
+    }
+}
+
+TEST(BufferPoolResizeTest, ParallelTest) {
+    MemoryDiskManager disk_manager;
+    FrameArenaConfig config;
+    config.max_pool_size_ = 8;
+    ParallelBufferPoolManager bpm(4, 4, &disk_manager, ReplacerType::LRU, config);
+    EXPECT_EQ(16, bpm.GetPoolSize());
+
+    // 30 frames are split into 8, 8, 7, 7
+    EXPECT_TRUE(bpm.Resize(30));
+    EXPECT_EQ(30, bpm.GetPoolSize());
+    EXPECT_EQ(8, bpm.GetInstance(1)->GetPoolSize());
+    EXPECT_EQ(7, bpm.GetInstance(2)->GetPoolSize());
+
+    // an instance would get nothing, or more than its max
+    EXPECT_FALSE(bpm.Resize(3));
+    EXPECT_FALSE(bpm.Resize(33));
+    EXPECT_EQ(30, bpm.GetPoolSize());
+
+    EXPECT_TRUE(bpm.Resize(4));
+    EXPECT_EQ(4, bpm.GetPoolSize());
+    std::vector<page_id_t> page_ids(4);
+    for (auto &page_id : page_ids) {
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+    }
+    page_id_t page_id;
+    EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+    for (auto id : page_ids) {
+        EXPECT_TRUE(bpm.UnpinPage(id, false));
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+}
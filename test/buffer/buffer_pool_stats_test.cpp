@@ -0,0 +1,179 @@
+/**
+ * @file buffer_pool_stats_test.cpp
+ * @author sheep
+ * @brief unit test for buffer pool statistics
+ * @version 0.1
+ * @date 2022-06-26
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(BufferPoolStatsTest, CounterTest) {
+    const size_t buffer_pool_size = 4;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+
+    // fill the pool and keep every page pinned
+    std::vector<page_id_t> page_ids(buffer_pool_size);
+    for (auto &page_id : page_ids) {
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+    }
+    page_id_t page_id;
+    EXPECT_EQ(nullptr, bpm.NewPage(&page_id));
+    EXPECT_EQ(nullptr, bpm.FetchPage(100));
+    auto stats = bpm.GetStats();
+    EXPECT_EQ(4, stats.new_pages_);
+    EXPECT_EQ(1, stats.new_page_failures_);
+    EXPECT_EQ(1, stats.misses_);
+    EXPECT_EQ(1, stats.fetch_failures_);
+    EXPECT_EQ(0, stats.hits_);
+
+    // page 0 is dirty, the rest are clean
+    EXPECT_TRUE(bpm.UnpinPage(page_ids[0], true));
+    for (size_t i = 1; i < buffer_pool_size; i++) {
+        EXPECT_TRUE(bpm.UnpinPage(page_ids[i], false));
+    }
+    bpm.ResetStats();
+
+    // 3 hits
+    for (int i = 0; i < 3; i++) {
+        ASSERT_NE(bpm.FetchPage(page_ids[1]), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_ids[1], false));
+    }
+    // evict page 0 and 2
+    for (int i = 0; i < 2; i++) {
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    // a miss bringing back page 0
+    ASSERT_NE(bpm.FetchPage(page_ids[0]), nullptr);
+    EXPECT_TRUE(bpm.UnpinPage(page_ids[0], false));
+
+    stats = bpm.GetStats();
+    EXPECT_EQ(4, stats.Fetches());
+    EXPECT_EQ(3, stats.hits_);
+    EXPECT_EQ(1, stats.misses_);
+    EXPECT_DOUBLE_EQ(0.75, stats.HitRatio());
+    EXPECT_EQ(2, stats.new_pages_);
+    EXPECT_EQ(3, stats.evictions_);
+    EXPECT_EQ(1, stats.dirty_write_backs_);
+    EXPECT_EQ(0, stats.fetch_failures_);
+    // heatmap is off
+    EXPECT_TRUE(stats.heatmap_.empty());
+    EXPECT_FALSE(stats.ToString().empty());
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(BufferPoolStatsTest, HeatmapTest) {
+    const size_t num_instances = 4;
+    MemoryDiskManager disk_manager;
+    ParallelBufferPoolManager bpm(num_instances, 8, &disk_manager);
+
+    std::vector<page_id_t> page_ids(16);
+    for (auto &page_id : page_ids) {
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+    }
+
+    // page i is fetched i times
+    bpm.EnableHeatmap(true);
+    for (auto page_id : page_ids) {
+        for (page_id_t i = 0; i < page_id; i++) {
+            ASSERT_NE(bpm.FetchPage(page_id), nullptr);
+            EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+        }
+    }
+
+    // shards are merged
+    auto stats = bpm.GetStats();
+    EXPECT_EQ(15, stats.heatmap_.size());
+    EXPECT_EQ(15 * 16 / 2, stats.hits_);
+    auto hot_pages = stats.HotPages(3);
+    ASSERT_EQ(3, hot_pages.size());
+    EXPECT_EQ(std::make_pair(15, 15UL), hot_pages[0]);
+    EXPECT_EQ(std::make_pair(14, 14UL), hot_pages[1]);
+    EXPECT_EQ(std::make_pair(13, 13UL), hot_pages[2]);
+    EXPECT_EQ(15, stats.HotPages(100).size());
+
+    // single shard
+    EXPECT_EQ(4, bpm.GetInstance(1)->GetStats().heatmap_.size());
+
+    bpm.EnableHeatmap(false);
+    ASSERT_NE(bpm.FetchPage(page_ids[1]), nullptr);
+    EXPECT_TRUE(bpm.UnpinPage(page_ids[1], false));
+    EXPECT_TRUE(bpm.GetStats().heatmap_.empty());
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(BufferPoolStatsTest, ConcurrentHitTest) {
+    const size_t buffer_pool_size = 4;
+    const int num_threads = 2 * StripedCounter::STRIPE_NUM + 1;
+    const int num_fetches = 1000;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+    page_id_t page_id;
+    ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+    EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    bpm.ResetStats();
+
+    // more threads than stripes, some of them share one
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < num_fetches; j++) {
+                ASSERT_NE(bpm.FetchPage(page_id), nullptr);
+                EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    auto stats = bpm.GetStats();
+    EXPECT_EQ(static_cast<uint64_t>(num_threads * num_fetches), stats.hits_);
+    EXPECT_EQ(0, stats.misses_);
+
+    bpm.ResetStats();
+    EXPECT_EQ(0, bpm.GetStats().hits_);
+}
+
+TEST(BufferPoolStatsTest, LatchWaitTest) {
+    std::mutex mutex;
+    BufferPoolStats stats;
+
+    // uncontended
+    {
+        auto lock = LockAndRecordWait(&mutex, &stats);
+        EXPECT_TRUE(lock.owns_lock());
+    }
+    EXPECT_EQ(0, stats.Snapshot().latch_wait_.count_);
+
+    auto lock = LockAndRecordWait(&mutex, &stats);
+    std::thread waiter([&]() {
+        auto lock = LockAndRecordWait(&mutex, &stats);
+        EXPECT_TRUE(lock.owns_lock());
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    lock.unlock();
+    waiter.join();
+
+    auto snapshot = stats.Snapshot();
+    EXPECT_EQ(1, snapshot.latch_wait_.count_);
+    EXPECT_GE(snapshot.latch_wait_.max_, 1000000UL);
+}
+
+}
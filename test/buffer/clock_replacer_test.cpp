@@ -0,0 +1,174 @@
+/**
+ * @file clock_replacer_test.cpp
+ * @author sheep
+ * @brief unit test for clock replacer
+ * @version 0.1
+ * @date 2022-06-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(ClockReplacerTest, SimpleTest) {
+    ClockReplacer clock(7);
+
+    for (int i = 1; i <= 6; i++) {
+        clock.Unpin(i);
+    }
+    clock.Unpin(1);
+    EXPECT_EQ(6, clock.Size());
+
+    // every frame is referenced, hand clears them in the first round,
+    // then evicts in the order of frame id
+    int value;
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(3, value);
+
+    // 3 is evicted, pin it should have no effect
+    clock.Pin(3);
+    clock.Pin(4);
+    EXPECT_EQ(2, clock.Size());
+
+    // 4 is referenced again, it gets a second chance
+    clock.Unpin(4);
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(5, value);
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(6, value);
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(4, value);
+
+    EXPECT_FALSE(clock.Evict(&value));
+    EXPECT_EQ(0, clock.Size());
+}
+
+TEST(ClockReplacerTest, SecondChanceTest) {
+    ClockReplacer clock(4);
+    int value;
+
+    for (int i = 0; i < 4; i++) {
+        clock.Unpin(i);
+    }
+    // first round clears all the bits, 0 is evicted
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(0, value);
+
+    // touching 1 protects it from the next sweep
+    clock.Touch(1);
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_FALSE(clock.Evict(&value));
+}
+
+TEST(ClockReplacerTest, ConcurrentTest) {
+    const int frame_num = 64;
+    const int thread_num = 4;
+    ClockReplacer clock(frame_num);
+
+    // threads keep touching their own frames, size should still be exact,
+    // and every frame is evicted exactly once
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_num; t++) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 1000; round++) {
+                for (int i = t; i < frame_num; i += thread_num) {
+                    clock.Touch(i);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(clock.Size(), frame_num);
+
+    std::set<int> victims;
+    int value;
+    while (clock.Evict(&value)) {
+        EXPECT_TRUE(victims.insert(value).second);
+    }
+    EXPECT_EQ(victims.size(), frame_num);
+    EXPECT_EQ(clock.Size(), 0);
+}
+
+TEST(ClockReplacerTest, BufferPoolTest) {
+    const size_t buffer_pool_size = 8;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager, ReplacerType::CLOCK);
+
+    std::vector<page_id_t> page_ids(buffer_pool_size * 4);
+    for (auto &page_id : page_ids) {
+        auto page = bpm.NewPage(&page_id);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+    }
+
+    // all frames pinned, no more space
+    std::vector<Page *> pinned;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+        pinned.push_back(bpm.FetchPage(page_ids[i]));
+        ASSERT_NE(pinned.back(), nullptr);
+    }
+    EXPECT_EQ(bpm.FetchPage(page_ids.back()), nullptr);
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+        EXPECT_TRUE(bpm.UnpinPage(page_ids[i], false));
+    }
+
+    for (int round = 0; round < 3; round++) {
+        for (auto page_id : page_ids) {
+            auto page = bpm.FetchPage(page_id);
+            ASSERT_NE(page, nullptr);
+            EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(page_id));
+            EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+        }
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(ClockReplacerTest, PeekVictimsTest) {
+    ClockReplacer clock(4);
+    for (int i = 0; i < 4; i++) {
+        clock.Unpin(i);
+    }
+    // first sweep clears all the reference bits, hand stops after 0
+    int value;
+    EXPECT_TRUE(clock.Evict(&value));
+    EXPECT_EQ(0, value);
+    clock.Touch(2);
+    // unpin doesn't set reference bit of a frame we already own
+    clock.Unpin(3);
+
+    // unreferenced frames in front of the hand, then referenced ones
+    std::vector<frame_id_t> victims;
+    clock.PeekVictims(3, &victims);
+    EXPECT_EQ(std::vector<frame_id_t>({1, 3, 2}), victims);
+    EXPECT_EQ(3, clock.Size());
+
+    for (auto frame_id : victims) {
+        EXPECT_TRUE(clock.Evict(&value));
+        EXPECT_EQ(frame_id, value);
+    }
+}
+}
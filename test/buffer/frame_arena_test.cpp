@@ -0,0 +1,157 @@
+/**
+ * @file frame_arena_test.cpp
+ * @author sheep
+ * @brief unit test for frame arena and frame descriptors
+ * @version 0.1
+ * @date 2022-06-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/frame_arena.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(FrameArenaTest, DescriptorTest) {
+    // descriptors never share a cache line
+    EXPECT_EQ(0, alignof(Page) % CACHE_LINE_SIZE);
+    EXPECT_EQ(0, sizeof(Page) % CACHE_LINE_SIZE);
+
+    // standalone page owns an aligned buffer
+    std::vector<Page> pages(4);
+    for (auto &page : pages) {
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page.GetData()) % PAGE_ALIGNMENT);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&page) % CACHE_LINE_SIZE);
+        EXPECT_EQ(0, page.GetData()[PAGE_SIZE - 1]);
+    }
+}
+
+TEST(FrameArenaTest, ArenaTest) {
+    FrameArenaConfig small_config;
+    FrameArenaConfig huge_config;
+    huge_config.numa_interleave_ = true;
+    FrameArenaConfig plain_config;
+    plain_config.huge_pages_ = false;
+
+    // (frame number, config)
+    std::vector<std::pair<size_t, FrameArenaConfig>> cases = {
+        {10, small_config},
+        {FrameArena::HUGE_PAGE_SIZE / PAGE_SIZE + 1, huge_config},
+        {FrameArena::HUGE_PAGE_SIZE / PAGE_SIZE + 1, plain_config},
+    };
+    for (auto &[frame_num, config] : cases) {
+        FrameArena arena(frame_num, config);
+        EXPECT_GE(arena.GetSize(), frame_num * PAGE_SIZE);
+        if (!config.huge_pages_ || frame_num * PAGE_SIZE < FrameArena::HUGE_PAGE_SIZE) {
+            EXPECT_FALSE(arena.IsHugePage());
+        } else {
+            // whatever we get, it starts at a huge page boundary
+            EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrame(0)) % FrameArena::HUGE_PAGE_SIZE);
+        }
+        for (size_t i = 0; i < frame_num; i++) {
+            auto frame = arena.GetFrame(i);
+            EXPECT_EQ(0, reinterpret_cast<uintptr_t>(frame) % PAGE_ALIGNMENT);
+            // fresh mapping is zeroed
+            EXPECT_EQ(0, frame[0]);
+            snprintf(frame, PAGE_SIZE, "frame %zu", i);
+        }
+        for (size_t i = 0; i < frame_num; i++) {
+            EXPECT_EQ(std::string(arena.GetFrame(i)), "frame " + std::to_string(i));
+        }
+    }
+}
+
+TEST(FrameArenaTest, ReserveTest) {
+    const size_t huge_page_frames = FrameArena::HUGE_PAGE_SIZE / PAGE_SIZE;
+
+    // frames reserved to grow into are never backed by explicit huge pages
+    FrameArenaConfig config;
+    config.max_pool_size_ = huge_page_frames * 4;
+    FrameArena arena(huge_page_frames, config);
+    EXPECT_GE(arena.GetSize(), config.max_pool_size_ * PAGE_SIZE);
+    EXPECT_FALSE(arena.IsHugePage());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrame(0)) % FrameArena::HUGE_PAGE_SIZE);
+    for (size_t i = 0; i < config.max_pool_size_; i++) {
+        EXPECT_EQ(0, arena.GetFrame(i)[0]);
+    }
+
+    // single frame is released
+    snprintf(arena.GetFrame(1), PAGE_SIZE, "frame 1");
+    snprintf(arena.GetFrame(2), PAGE_SIZE, "frame 2");
+    arena.Release(1, 1);
+    EXPECT_EQ(0, arena.GetFrame(1)[0]);
+    EXPECT_EQ(std::string(arena.GetFrame(2)), "frame 2");
+}
+
+TEST(FrameArenaTest, ReleaseTest) {
+    const size_t huge_page_frames = FrameArena::HUGE_PAGE_SIZE / PAGE_SIZE;
+    FrameArena arena(huge_page_frames * 2, FrameArenaConfig());
+    for (size_t i = 0; i < huge_page_frames * 2; i++) {
+        snprintf(arena.GetFrame(i), PAGE_SIZE, "frame %zu", i);
+    }
+
+    // explicit huge pages are released as a whole, a single frame keeps its content
+    arena.Release(1, 1);
+    if (arena.IsHugePage()) {
+        EXPECT_EQ(std::string(arena.GetFrame(1)), "frame 1");
+    } else {
+        EXPECT_EQ(0, arena.GetFrame(1)[0]);
+    }
+    arena.Release(huge_page_frames, huge_page_frames);
+    for (size_t i = huge_page_frames; i < huge_page_frames * 2; i++) {
+        EXPECT_EQ(0, arena.GetFrame(i)[0]);
+    }
+    EXPECT_EQ(std::string(arena.GetFrame(0)), "frame 0");
+}
+
+TEST(FrameArenaTest, BufferPoolTest) {
+    const size_t buffer_pool_size = 16;
+    MemoryDiskManager disk_manager;
+    FrameArenaConfig config;
+    config.numa_interleave_ = true;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager, ReplacerType::LRU, config);
+
+    // every frame has its own slot in the arena, and they are contiguous
+    std::vector<Page *> pages;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+        page_id_t page_id;
+        auto page = bpm.NewPage(&page_id);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        pages.push_back(page);
+    }
+    std::sort(pages.begin(), pages.end(), [](Page *a, Page *b) { return a->GetData() < b->GetData(); });
+    for (size_t i = 1; i < buffer_pool_size; i++) {
+        EXPECT_EQ(pages[i - 1]->GetData() + PAGE_SIZE, pages[i]->GetData());
+    }
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+        EXPECT_TRUE(bpm.UnpinPage(static_cast<page_id_t>(i), true));
+    }
+
+    // evict all of them and read them back
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+        page_id_t page_id;
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+        auto page = bpm.FetchPage(page_id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(page_id));
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+}
@@ -0,0 +1,214 @@
+/**
+ * @file lru_k_replacer_test.cpp
+ * @author sheep
+ * @brief unit test for lru-k replacer
+ * @version 0.1
+ * @date 2022-06-21
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/lru_k_replacer.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <string>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(LRUKReplacerTest, SimpleTest) {
+    // correlated period is disabled, every reference counts
+    LRUKReplacer lru_k(8, 2, 0);
+    int value;
+
+    // 1 and 2 are referenced twice, 3 and 4 only once
+    lru_k.Touch(1);
+    lru_k.Touch(2);
+    lru_k.Touch(3);
+    lru_k.Touch(4);
+    lru_k.Touch(1);
+    lru_k.Touch(2);
+    EXPECT_EQ(4, lru_k.Size());
+
+    // frames with less than k references go first, in lru order
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(4, value);
+
+    // 1 has the oldest second reference. pin it, then 2 is the victim
+    lru_k.Pin(1);
+    EXPECT_EQ(1, lru_k.Size());
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(2, value);
+    EXPECT_FALSE(lru_k.Evict(&value));
+
+    // unpin only records the first time
+    lru_k.Unpin(1);
+    lru_k.Unpin(1);
+    EXPECT_EQ(1, lru_k.Size());
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_EQ(0, lru_k.Size());
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+    LRUKReplacer lru_k(16, 2, 0);
+    int value;
+
+    // hot frames are referenced twice
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 4; i++) {
+            lru_k.Touch(i);
+        }
+    }
+    // a scan references the others once, more recently than the hot ones
+    for (int i = 4; i < 16; i++) {
+        lru_k.Touch(i);
+    }
+    lru_k.Touch(3);
+
+    // scanned frames are evicted before any hot frame
+    for (int i = 4; i < 16; i++) {
+        EXPECT_TRUE(lru_k.Evict(&value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(0, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+    LRUKReplacer lru_k(8, 2, 2);
+    int value;
+
+    // 0 is referenced twice, far apart
+    lru_k.Touch(0);
+    lru_k.Touch(1);
+    lru_k.Touch(2);
+    lru_k.Touch(3);
+    lru_k.Touch(0);
+
+    // burst of back to back references to 5, they are collapsed into a single one
+    for (int i = 0; i < 4; i++) {
+        lru_k.Touch(5);
+    }
+    // a few others, so that 5 is out of the correlated period
+    lru_k.Touch(6);
+    lru_k.Touch(7);
+    lru_k.Touch(6);
+    lru_k.Touch(7);
+
+    // 1, 2, 3 and 5 are referenced once, lru order among them. 5 goes before 0
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(5, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(0, value);
+
+    // 6 and 7 are still within correlated period, they are taken since there is nothing else
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(6, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(7, value);
+    EXPECT_FALSE(lru_k.Evict(&value));
+}
+
+TEST(LRUKReplacerTest, RetainedHistoryTest) {
+    LRUKReplacer lru_k(2, 2, 0);
+    int value;
+
+    // page 10 is referenced twice, page 20 once
+    lru_k.Load(0, 10);
+    lru_k.Touch(0);
+    lru_k.Touch(0);
+    lru_k.Load(1, 20);
+    lru_k.Touch(1);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(0, value);
+
+    // page 10 comes back with its history, page 30 is new. although page 10 is
+    // less recently used, 30 is evicted first
+    lru_k.Load(0, 10);
+    lru_k.Touch(0);
+    lru_k.Load(1, 30);
+    lru_k.Touch(1);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(0, value);
+    EXPECT_FALSE(lru_k.Evict(&value));
+}
+
+TEST(LRUKReplacerTest, BufferPoolTest) {
+    const size_t buffer_pool_size = 8;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager, ReplacerType::LRU_K);
+
+    std::vector<page_id_t> page_ids(buffer_pool_size * 4);
+    for (auto &page_id : page_ids) {
+        auto page = bpm.NewPage(&page_id);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+    }
+
+    for (int round = 0; round < 3; round++) {
+        for (auto page_id : page_ids) {
+            auto page = bpm.FetchPage(page_id);
+            ASSERT_NE(page, nullptr);
+            EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(page_id));
+            EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+        }
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(LRUKReplacerTest, SetEvictableTest) {
+    LRUKReplacer lru_k(8, 2, 0);
+    int value;
+
+    // 1 is referenced once, then 2 is referenced once
+    lru_k.Touch(1);
+    lru_k.Touch(2);
+
+    // 1 is pinned and released again without being accessed, it's still the older one
+    lru_k.Pin(1);
+    lru_k.SetEvictable(1);
+    lru_k.SetEvictable(1);
+    EXPECT_EQ(2, lru_k.Size());
+
+    // 3 is made evictable without any reference, e.g. it's prefetched. it goes first
+    lru_k.SetEvictable(3);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(3, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(lru_k.Evict(&value));
+    EXPECT_EQ(2, value);
+    EXPECT_FALSE(lru_k.Evict(&value));
+}
+
+TEST(LRUKReplacerTest, PeekVictimsTest) {
+    LRUKReplacer lru_k(8, 2, 0);
+    lru_k.Touch(1);
+    lru_k.Touch(2);
+    lru_k.Touch(3);
+    lru_k.Touch(1);
+
+    std::vector<frame_id_t> victims;
+    lru_k.PeekVictims(8, &victims);
+    EXPECT_EQ(std::vector<frame_id_t>({2, 3, 1}), victims);
+    EXPECT_EQ(3, lru_k.Size());
+}
+}
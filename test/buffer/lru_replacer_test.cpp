@@ -13,6 +13,8 @@
 
 #include "buffer/lru_replacer.h"
 
+#include <vector>
+
 namespace TinyDB {
 
 /**
@@ -105,4 +107,16 @@ TEST(LRUReplacerTest, SimpleTest2) {
     EXPECT_EQ(false, lru.Evict(&value));
 }
 
-}
\ No newline at end of file
+TEST(LRUReplacerTest, PeekVictimsTest) {
+    LRUReplacer lru_replacer(7);
+    lru_replacer.Unpin(1);
+    lru_replacer.Unpin(2);
+    lru_replacer.Unpin(3);
+
+    // least recently used first, nothing is evicted
+    std::vector<frame_id_t> victims;
+    lru_replacer.PeekVictims(2, &victims);
+    EXPECT_EQ(std::vector<frame_id_t>({1, 2}), victims);
+    EXPECT_EQ(3, lru_replacer.Size());
+}
+}
@@ -0,0 +1,226 @@
+/**
+ * @file page_cleaner_test.cpp
+ * @author sheep
+ * @brief unit test for background page cleaner
+ * @version 0.1
+ * @date 2022-06-23
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+// runs a hook in the middle of the next page write
+class HookedDiskManager : public MemoryDiskManager {
+public:
+    void WritePage(page_id_t pageId, const char *data) override {
+        auto hook = std::move(write_hook_);
+        write_hook_ = nullptr;
+        if (hook != nullptr) {
+            hook();
+        }
+        MemoryDiskManager::WritePage(pageId, data);
+    }
+
+    std::function<void()> write_hook_;
+};
+
+TEST(PageCleanerTest, CleanTest) {
+    const size_t buffer_pool_size = 16;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+
+    std::vector<page_id_t> page_ids(buffer_pool_size);
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+        auto page = bpm.NewPage(&page_ids[i]);
+        ASSERT_NE(page, nullptr);
+        ASSERT_EQ(static_cast<page_id_t>(i), page_ids[i]);
+        snprintf(page->GetData(), PAGE_SIZE, "page %zu", i);
+        EXPECT_TRUE(bpm.UnpinPage(page_ids[i], true));
+    }
+    // someone is using page 2
+    ASSERT_NE(bpm.FetchPage(2), nullptr);
+
+    // next 8 victims are page 0 to 7, page 2 is skipped. batches are
+    // [0, 1], [3, 6] and [7, 10], the last one takes in the neighbors
+    PageCleanerConfig config;
+    config.clean_target_percent_ = 50;
+    config.max_batch_size_ = 4;
+    EXPECT_EQ(10, bpm.CleanDirtyPages(config));
+    auto stats = bpm.GetPageCleanerStats();
+    EXPECT_EQ(1, stats.rounds_);
+    EXPECT_EQ(10, stats.pages_written_);
+    EXPECT_EQ(3, stats.batches_);
+
+    char data[PAGE_SIZE];
+    disk_manager.ReadPage(0, data);
+    EXPECT_STREQ("page 0", data);
+    disk_manager.ReadPage(10, data);
+    EXPECT_STREQ("page 10", data);
+    disk_manager.ReadPage(2, data);
+    EXPECT_STREQ("", data);
+    disk_manager.ReadPage(11, data);
+    EXPECT_STREQ("", data);
+    EXPECT_TRUE(bpm.UnpinPage(2, false));
+
+    // cleaned pages kept their position in replacer, foreground evicts them for free
+    for (int i = 0; i < 10; i++) {
+        page_id_t page_id;
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    stats = bpm.GetPageCleanerStats();
+    EXPECT_EQ(10, stats.victims_);
+    EXPECT_EQ(0, stats.dirty_victims_);
+
+    // page 11 is not cleaned
+    page_id_t page_id;
+    ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+    EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    stats = bpm.GetPageCleanerStats();
+    EXPECT_EQ(11, stats.victims_);
+    EXPECT_EQ(1, stats.dirty_victims_);
+
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+        auto page = bpm.FetchPage(page_ids[i]);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(i));
+        EXPECT_TRUE(bpm.UnpinPage(page_ids[i], false));
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(PageCleanerTest, BackgroundTest) {
+    const size_t num_instances = 2;
+    const size_t buffer_pool_size = 16;
+    MemoryDiskManager disk_manager;
+    ParallelBufferPoolManager bpm(num_instances, buffer_pool_size, &disk_manager);
+
+    PageCleanerConfig config;
+    config.clean_target_percent_ = 100;
+    config.interval_ = std::chrono::milliseconds(1);
+    bpm.StartPageCleaner(config);
+
+    const size_t page_num = num_instances * buffer_pool_size;
+    for (size_t i = 0; i < page_num; i++) {
+        page_id_t page_id;
+        auto page = bpm.NewPage(&page_id);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+    }
+
+    // wait for the cleaner to catch up
+    for (int i = 0; i < 5000 && bpm.GetPageCleanerStats().pages_written_ < page_num; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(page_num, bpm.GetPageCleanerStats().pages_written_);
+
+    // every victim is clean
+    for (size_t i = 0; i < page_num; i++) {
+        page_id_t page_id;
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    auto stats = bpm.GetPageCleanerStats();
+    EXPECT_EQ(page_num, stats.victims_);
+    EXPECT_EQ(0, stats.dirty_victims_);
+    bpm.StopPageCleaner();
+
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(page_num); page_id++) {
+        auto page = bpm.FetchPage(page_id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(page_id));
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(PageCleanerTest, ColdPagesTest) {
+    const size_t buffer_pool_size = 3;
+    HookedDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager, ReplacerType::LRU_K);
+
+    // page 0 is dirty, 1 and 2 are clean. each of them is referenced once
+    page_id_t page_id;
+    for (int i = 0; i < 3; i++) {
+        auto page = bpm.NewPage(&page_id);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, i == 0));
+    }
+
+    // while page 0 is being written back, foreground tries to evict it. it's pinned by
+    // the cleaner, page 1 is evicted instead
+    disk_manager.write_hook_ = [&]() {
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    };
+    PageCleanerConfig config;
+    config.clean_target_percent_ = 100;
+    EXPECT_EQ(1, bpm.CleanDirtyPages(config));
+
+    // cleaner releasing page 0 is not a reference, it's still the coldest one
+    ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+    EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    std::vector<std::pair<page_id_t, uint32_t>> resident;
+    bpm.GetResidentPages(&resident);
+    std::vector<page_id_t> resident_ids;
+    for (auto [id, temperature] : resident) {
+        resident_ids.push_back(id);
+    }
+    std::sort(resident_ids.begin(), resident_ids.end());
+    EXPECT_EQ(std::vector<page_id_t>({2, 3, 4}), resident_ids);
+    EXPECT_EQ(1, bpm.GetPageCleanerStats().pages_written_);
+    EXPECT_EQ(0, bpm.GetPageCleanerStats().dirty_victims_);
+
+    auto page = bpm.FetchPage(0);
+    ASSERT_NE(page, nullptr);
+    EXPECT_STREQ("page 0", page->GetData());
+    EXPECT_TRUE(bpm.UnpinPage(0, false));
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(PageCleanerTest, PrefetchVictimsTest) {
+    const size_t buffer_pool_size = 8;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+
+    page_id_t page_id;
+    for (size_t i = 0; i < buffer_pool_size * 2; i++) {
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+    }
+    auto stats = bpm.GetPageCleanerStats();
+    EXPECT_EQ(buffer_pool_size, stats.victims_);
+    EXPECT_EQ(buffer_pool_size, stats.dirty_victims_);
+
+    // prefetcher evicts two dirty pages and writes them back by itself, no foreground
+    // thread paid for it
+    bpm.Prefetch({0, 1});
+    bpm.WaitForPrefetch();
+    EXPECT_EQ(buffer_pool_size + 2, bpm.GetStats().evictions_);
+    EXPECT_EQ(buffer_pool_size + 2, bpm.GetStats().dirty_write_backs_);
+    stats = bpm.GetPageCleanerStats();
+    EXPECT_EQ(buffer_pool_size, stats.victims_);
+    EXPECT_EQ(buffer_pool_size, stats.dirty_victims_);
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+}
@@ -0,0 +1,113 @@
+#include "buffer/page_table.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(PageTableTest, BasicTest) {
+    PageTable table(8);
+    EXPECT_EQ(table.Find(1), INVALID_FRAME_ID);
+
+    for (int i = 0; i < 8; i++) {
+        table.Insert(i * 3, i);
+    }
+    EXPECT_EQ(table.Size(), 8);
+    for (int i = 0; i < 8; i++) {
+        EXPECT_EQ(table.Find(i * 3), i);
+    }
+    EXPECT_EQ(table.Find(1), INVALID_FRAME_ID);
+
+    // update
+    table.Insert(3, 7);
+    EXPECT_EQ(table.Find(3), 7);
+    EXPECT_EQ(table.Size(), 8);
+
+    EXPECT_TRUE(table.Erase(3));
+    EXPECT_FALSE(table.Erase(3));
+    EXPECT_EQ(table.Find(3), INVALID_FRAME_ID);
+    EXPECT_EQ(table.Size(), 7);
+
+    size_t count = 0;
+    table.ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+        EXPECT_EQ(page_id, frame_id * 3);
+        count++;
+    });
+    EXPECT_EQ(count, 7);
+}
+
+TEST(PageTableTest, ChurnTest) {
+    const size_t capacity = 64;
+    PageTable table(capacity);
+    std::unordered_map<page_id_t, frame_id_t> expected;
+
+    // keep the table full while replacing entries, erasure shouldn't break probing sequences
+    std::mt19937 mt(0);
+    std::uniform_int_distribution<page_id_t> page_dis(0, 1000);
+    for (int i = 0; i < 100000; i++) {
+        page_id_t page_id = page_dis(mt);
+        if (expected.count(page_id) != 0) {
+            EXPECT_TRUE(table.Erase(page_id));
+            expected.erase(page_id);
+        } else if (expected.size() < capacity) {
+            table.Insert(page_id, i);
+            expected[page_id] = i;
+        }
+        if (i % 1000 == 0) {
+            for (page_id_t id = 0; id <= 1000; id++) {
+                auto it = expected.find(id);
+                ASSERT_EQ(table.Find(id), it == expected.end() ? INVALID_FRAME_ID : it->second);
+            }
+        }
+    }
+    EXPECT_EQ(table.Size(), expected.size());
+}
+
+TEST(PageTableTest, ConcurrentReaderTest) {
+    const size_t capacity = 32;
+    const int reader_num = 4;
+    PageTable table(capacity);
+
+    // pages 0..15 stay, frame id is always page id + 1000.
+    // the writer keeps inserting and erasing the others around them
+    for (page_id_t i = 0; i < 16; i++) {
+        table.Insert(i, i + 1000);
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < reader_num; i++) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                for (page_id_t id = 0; id < 64; id++) {
+                    frame_id_t frame_id = table.Find(id);
+                    // lock-free lookup may miss, but never sees a wrong mapping
+                    if (frame_id != INVALID_FRAME_ID) {
+                        ASSERT_EQ(frame_id, id + 1000);
+                    }
+                }
+            }
+        });
+    }
+
+    std::mt19937 mt(0);
+    std::uniform_int_distribution<page_id_t> page_dis(16, 63);
+    for (int i = 0; i < 200000; i++) {
+        page_id_t page_id = page_dis(mt);
+        if (table.Find(page_id) != INVALID_FRAME_ID) {
+            table.Erase(page_id);
+        } else if (table.Size() < capacity) {
+            table.Insert(page_id, page_id + 1000);
+        }
+    }
+    stop = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+}
+
+}
@@ -0,0 +1,126 @@
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/file_disk_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <random>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(ParallelBufferPoolManagerTest, ShardingTest) {
+    const size_t num_instances = 4;
+    const size_t pool_size = 2;
+
+    MemoryDiskManager disk_manager;
+    ParallelBufferPoolManager bpm(num_instances, pool_size, &disk_manager);
+    EXPECT_EQ(bpm.GetPoolSize(), num_instances * pool_size);
+
+    // every frame of every instance should be usable
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_instances * pool_size; i++) {
+        page_id_t page_id;
+        auto page = bpm.NewPage(&page_id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ(page->GetPageId(), page_id);
+        // page should be cached by the instance it hashed to
+        EXPECT_EQ(bpm.GetInstance(page_id)->FetchPage(page_id), page);
+        EXPECT_TRUE(bpm.GetInstance(page_id)->UnpinPage(page_id, false));
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        page_ids.push_back(page_id);
+    }
+
+    // all frames are pinned, ids allocated while searching for space should be given back
+    auto page_count = disk_manager.GetPageCount() - disk_manager.GetFreePageCount();
+    page_id_t page_id;
+    EXPECT_EQ(bpm.NewPage(&page_id), nullptr);
+    EXPECT_EQ(disk_manager.GetPageCount() - disk_manager.GetFreePageCount(), page_count);
+
+    for (auto id : page_ids) {
+        EXPECT_TRUE(bpm.UnpinPage(id, true));
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+
+    // swap everything out and read them back
+    for (size_t i = 0; i < num_instances * pool_size; i++) {
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    for (auto id : page_ids) {
+        auto page = bpm.FetchPage(id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(id));
+        EXPECT_TRUE(bpm.UnpinPage(id, false));
+    }
+
+    // deletion is routed to the owner
+    EXPECT_TRUE(bpm.DeletePage(page_ids[0]));
+    EXPECT_FALSE(disk_manager.IsAllocated(page_ids[0]));
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(ParallelBufferPoolManagerTest, ConcurrentTest) {
+    const std::string filename = "test.db";
+    const size_t num_instances = 4;
+    const size_t pool_size = 4;
+    const size_t worker_size = 8;
+    const size_t total_page_size = 32;
+    const size_t iteration_num = 20;
+
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+
+    std::vector<page_id_t> page_list(total_page_size);
+    for (size_t i = 0; i < total_page_size; i++) {
+        EXPECT_NE(bpm->NewPage(&page_list[i]), nullptr);
+        EXPECT_EQ(bpm->UnpinPage(page_list[i], true), true);
+    }
+
+    std::vector<std::thread> worker_list;
+    for (size_t i = 0; i < worker_size; i++) {
+        worker_list.emplace_back(std::thread([&]() {
+            std::random_device rd;
+            std::mt19937 mt(rd());
+            std::vector<page_id_t> access_list = page_list;
+
+            for (size_t i = 0; i < iteration_num; i++) {
+                std::shuffle(access_list.begin(), access_list.end(), mt);
+                for (auto page_id : access_list) {
+                    Page *page;
+                    // other workers may pin all frames of the instance, retry
+                    while ((page = bpm->FetchPage(page_id)) == nullptr) {
+                        std::this_thread::yield();
+                    }
+                    page->WLatch();
+                    int *counter = reinterpret_cast<int *>(page->GetData());
+                    *counter = *counter + 1;
+                    page->WUnlatch();
+                    bpm->UnpinPage(page_id, true);
+                }
+            }
+        }));
+    }
+
+    for (auto &worker : worker_list) {
+        worker.join();
+    }
+
+    for (auto page_id : page_list) {
+        auto page = bpm->FetchPage(page_id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ(*reinterpret_cast<int *>(page->GetData()), static_cast<int>(iteration_num * worker_size));
+        bpm->UnpinPage(page_id, false);
+    }
+    EXPECT_TRUE(bpm->CheckPinCount());
+
+    delete bpm;
+    delete disk_manager;
+
+    RemoveDatabaseFiles(filename);
+}
+
+}
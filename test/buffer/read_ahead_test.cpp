@@ -0,0 +1,215 @@
+/**
+ * @file read_ahead_test.cpp
+ * @author sheep
+ * @brief unit test for prefetch and read-ahead window
+ * @version 0.1
+ * @date 2022-06-24
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "buffer/read_ahead.h"
+#include "storage/disk/memory_disk_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+// records the prefetch requests
+class PrefetchRecorder : public BufferPoolManagerInstance {
+public:
+    explicit PrefetchRecorder(DiskManager *disk_manager)
+        : BufferPoolManagerInstance(8, disk_manager) {}
+
+    void Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) override {
+        requests_.push_back(page_ids);
+    }
+
+    std::vector<std::vector<page_id_t>> requests_;
+};
+
+// fill the disk with pages, and return their ids
+static std::vector<page_id_t> CreatePages(BufferPoolManager *bpm, size_t page_num) {
+    std::vector<page_id_t> page_ids(page_num);
+    for (auto &page_id : page_ids) {
+        auto page = bpm->NewPage(&page_id);
+        EXPECT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+    return page_ids;
+}
+
+// wait until the page shows up, prefetch is asynchronous
+static void WaitForPage(BufferPoolManager *bpm, MemoryDiskManager *disk_manager, page_id_t page_id) {
+    for (int i = 0; i < 5000; i++) {
+        auto reads = disk_manager->GetIOStats().page_read_.ops_;
+        auto page = bpm->FetchPage(page_id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(page_id));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+        if (disk_manager->GetIOStats().page_read_.ops_ == reads) {
+            return;
+        }
+        // we read it ourselves, try it once more
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        bpm->Prefetch({page_id});
+    }
+    FAIL() << "page " << page_id << " is never prefetched";
+}
+
+TEST(ReadAheadTest, WindowTest) {
+    MemoryDiskManager disk_manager;
+    PrefetchRecorder bpm(&disk_manager);
+    ReadAheadWindow read_ahead(8);
+
+    // only the next page is known at the beginning
+    read_ahead.OnPage(&bpm, 10, 11);
+    EXPECT_EQ(1, read_ahead.GetWindow());
+    // still on the same page
+    read_ahead.OnPage(&bpm, 10, 11);
+    ASSERT_EQ(1, bpm.requests_.size());
+    EXPECT_EQ(std::vector<page_id_t>({11}), bpm.requests_[0]);
+
+    // sequential, window grows
+    read_ahead.OnPage(&bpm, 11, 12);
+    EXPECT_EQ(2, read_ahead.GetWindow());
+    read_ahead.OnPage(&bpm, 12, 13);
+    EXPECT_EQ(4, read_ahead.GetWindow());
+    read_ahead.OnPage(&bpm, 13, 14);
+    EXPECT_EQ(8, read_ahead.GetWindow());
+    ASSERT_EQ(4, bpm.requests_.size());
+    EXPECT_EQ(std::vector<page_id_t>({12, 13}), bpm.requests_[1]);
+    EXPECT_EQ(std::vector<page_id_t>({14, 15, 16}), bpm.requests_[2]);
+    EXPECT_EQ(std::vector<page_id_t>({17, 18, 19, 20, 21}), bpm.requests_[3]);
+
+    // window is capped, less than half of it is available
+    read_ahead.OnPage(&bpm, 14, 15);
+    read_ahead.OnPage(&bpm, 15, 16);
+    read_ahead.OnPage(&bpm, 16, 17);
+    EXPECT_EQ(4, bpm.requests_.size());
+    read_ahead.OnPage(&bpm, 17, 18);
+    ASSERT_EQ(5, bpm.requests_.size());
+    EXPECT_EQ(std::vector<page_id_t>({22, 23, 24, 25}), bpm.requests_[4]);
+
+    // the scan jumped
+    read_ahead.OnPage(&bpm, 18, 40);
+    EXPECT_EQ(1, read_ahead.GetWindow());
+    ASSERT_EQ(6, bpm.requests_.size());
+    EXPECT_EQ(std::vector<page_id_t>({40}), bpm.requests_[5]);
+
+    // end of the scan
+    read_ahead.OnPage(&bpm, 40, INVALID_PAGE_ID);
+    EXPECT_EQ(0, read_ahead.GetWindow());
+    EXPECT_EQ(6, bpm.requests_.size());
+
+    // window never exceeds half of the ring
+    ReadAheadWindow ring_read_ahead(8);
+    BufferAccessStrategy strategy(4);
+    for (page_id_t page_id = 0; page_id < 10; page_id++) {
+        ring_read_ahead.OnPage(&bpm, page_id, page_id + 1, &strategy);
+    }
+    EXPECT_EQ(2, ring_read_ahead.GetWindow());
+}
+
+TEST(ReadAheadTest, PrefetchTest) {
+    const size_t buffer_pool_size = 16;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+    auto page_ids = CreatePages(&bpm, buffer_pool_size * 2);
+
+    // pages 16 to 31 are cached now, bring back 0 to 3.
+    // unallocated and cached pages are skipped
+    bpm.Prefetch({1000, 16, 0, 1, 2, 3});
+    EXPECT_TRUE(bpm.CheckPinCount());
+    disk_manager.ResetIOStats();
+    for (page_id_t page_id = 0; page_id < 4; page_id++) {
+        WaitForPage(&bpm, &disk_manager, page_id);
+    }
+    EXPECT_EQ(0, disk_manager.GetIOStats().page_read_.ops_);
+
+    // prefetch never takes more than a quarter of the pool at a time
+    for (auto page_id : page_ids) {
+        auto page = bpm.FetchPage(page_id);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(page_id));
+        bpm.Prefetch(page_ids);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(ReadAheadTest, PrefetchEvictionTest) {
+    const size_t buffer_pool_size = 16;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager, ReplacerType::LRU_K);
+    auto page_ids = CreatePages(&bpm, buffer_pool_size * 2);
+
+    // pages 16 to 23 are fetched twice, they are the working set
+    for (int round = 0; round < 2; round++) {
+        for (page_id_t page_id = 16; page_id < 24; page_id++) {
+            ASSERT_NE(bpm.FetchPage(page_id), nullptr);
+            EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+        }
+    }
+
+    // pages 12 to 15 are prefetched and never read. replacer still remembers their
+    // reference from being created
+    bpm.Prefetch({12, 13, 14, 15});
+    bpm.WaitForPrefetch();
+    EXPECT_TRUE(bpm.CheckPinCount());
+
+    // 8 pages read once. prefetched pages go first, working set stays
+    for (page_id_t page_id = 4; page_id < 12; page_id++) {
+        ASSERT_NE(bpm.FetchPage(page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    std::vector<std::pair<page_id_t, uint32_t>> resident;
+    bpm.GetResidentPages(&resident);
+    std::vector<page_id_t> resident_ids;
+    for (auto [page_id, temperature] : resident) {
+        resident_ids.push_back(page_id);
+    }
+    std::sort(resident_ids.begin(), resident_ids.end());
+    std::vector<page_id_t> expected;
+    for (page_id_t page_id = 4; page_id < 12; page_id++) {
+        expected.push_back(page_id);
+    }
+    for (page_id_t page_id = 16; page_id < 24; page_id++) {
+        expected.push_back(page_id);
+    }
+    EXPECT_EQ(expected, resident_ids);
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(ReadAheadTest, ParallelTest) {
+    const size_t num_instances = 4;
+    const size_t buffer_pool_size = 8;
+    MemoryDiskManager disk_manager;
+    ParallelBufferPoolManager bpm(num_instances, buffer_pool_size, &disk_manager);
+    auto page_ids = CreatePages(&bpm, num_instances * buffer_pool_size * 2);
+
+    // each instance loads its own share
+    std::vector<page_id_t> prefetch_ids(page_ids.begin(), page_ids.begin() + 8);
+    bpm.Prefetch(prefetch_ids);
+    EXPECT_TRUE(bpm.CheckPinCount());
+    disk_manager.ResetIOStats();
+    for (auto page_id : prefetch_ids) {
+        WaitForPage(&bpm, &disk_manager, page_id);
+    }
+    EXPECT_EQ(0, disk_manager.GetIOStats().page_read_.ops_);
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+}
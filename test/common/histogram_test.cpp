@@ -0,0 +1,108 @@
+/**
+ * @file histogram_test.cpp
+ * @author sheep
+ * @brief test for latency histogram
+ * @version 0.1
+ * @date 2022-06-13
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "common/histogram.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(HistogramTest, BucketTest) {
+    // every value falls into a bucket whose upper bound is no smaller than it,
+    // and no more than 25% larger
+    for (uint64_t value : {0UL, 1UL, 3UL, 4UL, 5UL, 7UL, 8UL, 9UL, 100UL, 1000UL, 123456UL, 1UL << 40, UINT64_MAX}) {
+        auto idx = LatencyHistogram::BucketIndex(value);
+        EXPECT_LT(idx, LatencyHistogram::BUCKET_NUM);
+        auto upper = LatencyHistogram::BucketUpperBound(idx);
+        EXPECT_GE(upper, value);
+        EXPECT_LE(upper - value, value / 4);
+    }
+
+    // buckets are continuous
+    for (uint32_t idx = 1; idx < LatencyHistogram::BucketIndex(UINT64_MAX); idx++) {
+        EXPECT_EQ(LatencyHistogram::BucketIndex(LatencyHistogram::BucketUpperBound(idx - 1) + 1), idx);
+        EXPECT_EQ(LatencyHistogram::BucketIndex(LatencyHistogram::BucketUpperBound(idx)), idx);
+    }
+}
+
+TEST(HistogramTest, PercentileTest) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.Snapshot().Percentile(0.99), 0UL);
+
+    for (uint64_t i = 1; i <= 1000; i++) {
+        histogram.Record(i);
+    }
+    auto snapshot = histogram.Snapshot();
+    EXPECT_EQ(snapshot.count_, 1000UL);
+    EXPECT_EQ(snapshot.max_, 1000UL);
+    EXPECT_DOUBLE_EQ(snapshot.Mean(), 500.5);
+
+    auto p50 = snapshot.Percentile(0.5);
+    EXPECT_GE(p50, 500UL);
+    EXPECT_LE(p50, 625UL);
+    auto p99 = snapshot.Percentile(0.99);
+    EXPECT_GE(p99, 990UL);
+    EXPECT_LE(p99, 1000UL);
+    EXPECT_EQ(snapshot.Percentile(1), 1000UL);
+
+    histogram.Reset();
+    snapshot = histogram.Snapshot();
+    EXPECT_EQ(snapshot.count_, 0UL);
+    EXPECT_EQ(snapshot.sum_, 0UL);
+}
+
+TEST(HistogramTest, MergeTest) {
+    LatencyHistogram a;
+    LatencyHistogram b;
+    for (uint64_t i = 1; i <= 500; i++) {
+        a.Record(i);
+        b.Record(i + 500);
+    }
+    HistogramSnapshot snapshot;
+    snapshot += a.Snapshot();
+    snapshot += b.Snapshot();
+    EXPECT_EQ(snapshot.count_, 1000UL);
+    EXPECT_EQ(snapshot.max_, 1000UL);
+    EXPECT_DOUBLE_EQ(snapshot.Mean(), 500.5);
+    auto p50 = snapshot.Percentile(0.5);
+    EXPECT_GE(p50, 500UL);
+    EXPECT_LE(p50, 625UL);
+}
+
+TEST(HistogramTest, ConcurrentTest) {
+    LatencyHistogram histogram;
+    const int thread_num = 8;
+    const uint64_t record_num = 100000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_num; i++) {
+        threads.emplace_back([&, i]() {
+            for (uint64_t j = 0; j < record_num; j++) {
+                histogram.Record(j + i);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    auto snapshot = histogram.Snapshot();
+    EXPECT_EQ(snapshot.count_, thread_num * record_num);
+    EXPECT_EQ(snapshot.max_, record_num - 1 + thread_num - 1);
+    uint64_t sum = 0;
+    for (int i = 0; i < thread_num; i++) {
+        sum += (record_num - 1) * record_num / 2 + i * record_num;
+    }
+    EXPECT_EQ(snapshot.sum_, sum);
+}
+
+}
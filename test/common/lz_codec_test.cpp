@@ -0,0 +1,95 @@
+/**
+ * @file lz_codec_test.cpp
+ * @author sheep
+ * @brief test for lz codec
+ * @version 0.1
+ * @date 2022-06-14
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "common/lz_codec.h"
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace TinyDB {
+
+// compress then decompress, return the compressed size
+size_t RoundTrip(const std::vector<char> &data) {
+    std::vector<char> compressed(LZCodec::MaxCompressedSize(data.size()));
+    size_t compressed_size = LZCodec::Compress(data.data(), data.size(), compressed.data(), compressed.size());
+    EXPECT_GT(compressed_size, 0UL);
+
+    std::vector<char> decompressed(data.size() + 1);
+    auto size = LZCodec::Decompress(compressed.data(), compressed_size, decompressed.data(), decompressed.size());
+    EXPECT_EQ(size, static_cast<int64_t>(data.size()));
+    EXPECT_EQ(memcmp(decompressed.data(), data.data(), data.size()), 0);
+    return compressed_size;
+}
+
+TEST(LZCodecTest, RoundTripTest) {
+    // empty and tiny input
+    RoundTrip({});
+    RoundTrip({'a'});
+    RoundTrip({'a', 'b', 'c', 'd', 'a', 'b', 'c', 'd', 'a'});
+
+    // zero page shrinks to almost nothing
+    std::vector<char> zero(4096, 0);
+    EXPECT_LT(RoundTrip(zero), 64UL);
+
+    // repeated records, like the tuples of a table
+    std::vector<char> records;
+    for (int i = 0; i < 200; i++) {
+        std::string record = "order " + std::to_string(100000 + i) + ", status: shipped, amount: 42.00;";
+        records.insert(records.end(), record.begin(), record.end());
+    }
+    EXPECT_LT(RoundTrip(records), records.size() / 2);
+
+    // random data doesn't compress, but should survive
+    std::mt19937 mt(0);
+    std::vector<char> random(65536);
+    for (auto &byte : random) {
+        byte = static_cast<char>(mt());
+    }
+    EXPECT_LE(RoundTrip(random), LZCodec::MaxCompressedSize(random.size()));
+
+    // long literals and long matches need the length extension
+    std::vector<char> mixed(random.begin(), random.begin() + 1000);
+    mixed.insert(mixed.end(), 3000, 'x');
+    mixed.insert(mixed.end(), random.begin(), random.begin() + 1000);
+    RoundTrip(mixed);
+}
+
+TEST(LZCodecTest, BoundaryTest) {
+    std::mt19937 mt(0);
+    std::vector<char> random(4096);
+    for (auto &byte : random) {
+        byte = static_cast<char>(mt());
+    }
+    std::vector<char> compressed(LZCodec::MaxCompressedSize(random.size()));
+
+    // dst is too small
+    EXPECT_EQ(LZCodec::Compress(random.data(), random.size(), compressed.data(), 2048), 0UL);
+
+    // original data doesn't fit
+    size_t compressed_size = LZCodec::Compress(random.data(), random.size(), compressed.data(), compressed.size());
+    std::vector<char> decompressed(random.size());
+    EXPECT_EQ(LZCodec::Decompress(compressed.data(), compressed_size, decompressed.data(), 100), -1);
+
+    // corrupted data never takes us out of the buffers
+    std::vector<char> zero(4096, 0);
+    compressed_size = LZCodec::Compress(zero.data(), zero.size(), compressed.data(), compressed.size());
+    for (size_t i = 0; i < compressed_size; i++) {
+        auto corrupted = compressed;
+        corrupted[i] = static_cast<char>(0xff);
+        LZCodec::Decompress(corrupted.data(), compressed_size, decompressed.data(), decompressed.size());
+        LZCodec::Decompress(corrupted.data(), i, decompressed.data(), decompressed.size());
+    }
+}
+
+}
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
 #include <thread>
 #include <vector>
 
@@ -82,4 +84,81 @@ TEST(RWLatchTest, WaitTest) {
     EXPECT_EQ(counter, 1);
 }
 
-}
\ No newline at end of file
+TEST(RWLatchTest, TryLockTest) {
+    ReaderWriterLatch latch;
+    EXPECT_TRUE(latch.TryWLock());
+    EXPECT_FALSE(latch.TryWLock());
+    EXPECT_FALSE(latch.TryRLock());
+    latch.WUnlock();
+
+    EXPECT_TRUE(latch.TryRLock());
+    EXPECT_TRUE(latch.TryRLock());
+    EXPECT_FALSE(latch.TryWLock());
+    latch.RUnlock();
+    latch.RUnlock();
+    EXPECT_TRUE(latch.TryWLock());
+    latch.WUnlock();
+}
+
+TEST(RWLatchTest, WriterPreferenceTest) {
+    ReaderWriterLatch latch;
+    std::atomic<bool> written(false);
+    latch.RLock();
+    std::thread writer([&]() {
+        latch.WLock();
+        written.store(true);
+        latch.WUnlock();
+    });
+
+    // once the writer is waiting, new readers have to wait behind it
+    bool blocked = false;
+    for (int i = 0; i < 1000 && !blocked; i++) {
+        if (latch.TryRLock()) {
+            latch.RUnlock();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } else {
+            blocked = true;
+        }
+    }
+    EXPECT_TRUE(blocked);
+    EXPECT_FALSE(written.load());
+
+    latch.RUnlock();
+    writer.join();
+    EXPECT_TRUE(written.load());
+    EXPECT_TRUE(latch.TryRLock());
+    latch.RUnlock();
+}
+
+TEST(RWLatchTest, ParkTest) {
+    // latch is held long enough that waiters go to sleep
+    const int num_threads = 16;
+    const int round_num = 200;
+    ReaderWriterLatch latch;
+    int64_t a = 0;
+    int64_t b = 0;
+    std::vector<std::thread> thread_list;
+    for (int i = 0; i < num_threads; i++) {
+        thread_list.emplace_back([&, i]() {
+            for (int j = 0; j < round_num; j++) {
+                if ((i + j) % 4 == 0) {
+                    WriterGuard guard(latch);
+                    a++;
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    b++;
+                } else {
+                    ReaderGuard guard(latch);
+                    EXPECT_EQ(a, b);
+                    std::this_thread::sleep_for(std::chrono::microseconds(10));
+                }
+            }
+        });
+    }
+    for (auto &thread : thread_list) {
+        thread.join();
+    }
+    EXPECT_EQ(num_threads * round_num / 4, a);
+    EXPECT_EQ(a, b);
+}
+
+}
@@ -18,6 +18,8 @@
 #include "execution/expressions/constant_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/operator_expression.h"
+#include "storage/disk/file_disk_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 #include <memory>
 #include <gtest/gtest.h>
@@ -148,10 +150,10 @@ bool PerformWrite(ExecutionContext *context, int from, int to, int money, bool e
 TEST(TwoPhaseLockingTest, BasicTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 3;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("ID", TypeId::INTEGER);
     auto colC = Column("Money", TypeId::INTEGER);
@@ -234,7 +236,7 @@ TEST(TwoPhaseLockingTest, BasicTest) {
     }
     LOG_INFO("Commit %d abort %d", commit_num.load(), iteration_num * worker_num - commit_num.load());
 
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
     delete txn_manager;
     delete disk_manager;
     delete bpm;
@@ -13,6 +13,8 @@
 #include "execution/executors/insert_executor.h"
 #include "storage/table/table_heap.h"
 #include "common/logger.h"
+#include "storage/disk/file_disk_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 #include <gtest/gtest.h>
 
@@ -21,10 +23,10 @@ namespace TinyDB {
 TEST(InsertExecutorTest, BasicTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 3;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     auto colB = Column("colB", TypeId::VARCHAR, 20);
@@ -93,16 +95,16 @@ TEST(InsertExecutorTest, BasicTest) {
     delete scan_executor;
     delete bpm;
     delete disk_manager;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 TEST(InsertExecutorTest, BasicTest2) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 3;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     auto colB = Column("colB", TypeId::VARCHAR, 20);
@@ -194,7 +196,7 @@ TEST(InsertExecutorTest, BasicTest2) {
 
     delete bpm;
     delete disk_manager;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 }
\ No newline at end of file
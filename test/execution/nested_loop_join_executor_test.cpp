@@ -20,6 +20,8 @@
 #include "storage/table/table_heap.h"
 #include "common/logger.h"
 #include "type/value_factory.h"
+#include "storage/disk/file_disk_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 #include <gtest/gtest.h>
 
@@ -28,10 +30,10 @@ namespace TinyDB {
 TEST(UpdateExecutorTest, BasicTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 3;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
     auto catalog = Catalog(bpm);
     {
         auto colA = Column("colA", TypeId::BIGINT);
@@ -157,7 +159,7 @@ TEST(UpdateExecutorTest, BasicTest) {
 
     delete bpm;
     delete disk_manager;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 }
\ No newline at end of file
@@ -12,6 +12,8 @@
 #include "execution/executors/seq_scan_executor.h"
 #include "storage/table/table_heap.h"
 #include "common/logger.h"
+#include "storage/disk/file_disk_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 #include <gtest/gtest.h>
 
@@ -20,10 +22,10 @@ namespace TinyDB {
 TEST(SeqScanExecutorTest, BasicTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 3;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     auto colB = Column("colB", TypeId::VARCHAR, 20);
@@ -88,7 +90,7 @@ TEST(SeqScanExecutorTest, BasicTest) {
     delete executor;
     delete bpm;
     delete disk_manager;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 }
\ No newline at end of file
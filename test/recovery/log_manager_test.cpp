@@ -10,7 +10,7 @@
  */
 
 #include "recovery/log_manager.h"
-#include "storage/disk/disk_manager.h"
+#include "storage/disk/file_disk_manager.h"
 
 #include <memory>
 #include <random>
@@ -48,9 +48,8 @@ LogRecord GenerateRandomLogRecord(LogRecordType type) {
 }
 
 TEST(LogManagerTest, BasicFlushTest) {
-    remove("test.db");
-    remove("test.log");
-    auto dm = new DiskManager("test.db");
+    RemoveDatabaseFiles("test.db");
+    auto dm = new FileDiskManager("test.db");
     auto lm = new LogManager(dm);
     std::random_device rd;
     std::mt19937 mt(rd());
@@ -92,9 +91,9 @@ TEST(LogManagerTest, BasicFlushTest) {
 
     std::vector<LogRecord> new_log_list;
     // restart it
-    dm = new DiskManager("test.db");
+    dm = new FileDiskManager("test.db");
     char log_buffer[LOG_BUFFER_SIZE];
-    int offset = 0;
+    int64_t offset = 0;
     std::chrono::milliseconds deserialization_time{0};
     // then read the log
     while (dm->ReadLog(log_buffer, LOG_BUFFER_SIZE, offset)) {
@@ -128,14 +127,12 @@ TEST(LogManagerTest, BasicFlushTest) {
 
     delete dm;
 
-    remove("test.db");
-    remove("test.log");
+    RemoveDatabaseFiles("test.db");
 }
 
 TEST(LogManagerTest, ForceFlushTest) {
-    remove("test.db");
-    remove("test.log");
-    auto dm = new DiskManager("test.db");
+    RemoveDatabaseFiles("test.db");
+    auto dm = new FileDiskManager("test.db");
     auto lm = new LogManager(dm);
     std::random_device rd;
     std::mt19937 mt(rd());
@@ -177,9 +174,9 @@ TEST(LogManagerTest, ForceFlushTest) {
 
     std::vector<LogRecord> new_log_list;
     // restart it
-    dm = new DiskManager("test.db");
+    dm = new FileDiskManager("test.db");
     char log_buffer[LOG_BUFFER_SIZE];
-    int offset = 0;
+    int64_t offset = 0;
     std::chrono::milliseconds deserialization_time{0};
     // then read the log
     while (dm->ReadLog(log_buffer, LOG_BUFFER_SIZE, offset)) {
@@ -213,8 +210,7 @@ TEST(LogManagerTest, ForceFlushTest) {
 
     delete dm;
 
-    remove("test.db");
-    remove("test.log");
+    RemoveDatabaseFiles("test.db");
 }
 
 
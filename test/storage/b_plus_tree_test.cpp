@@ -11,7 +11,11 @@
 
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/generic_key.h"
+#include "storage/disk/file_disk_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/memory_disk_manager.h"
 
+#include <functional>
 #include <thread>
 #include <gtest/gtest.h>
 #include <random>
@@ -19,13 +23,46 @@
 
 namespace TinyDB {
 
+// once armed, the next page fetched is write latched, so that the iterator fails to
+// step onto it. when the iterator gives up its current page, the latch is released
+// and the hook runs before the iterator re-scans the tree
+class IteratorRaceBufferPool : public BufferPoolManagerInstance {
+public:
+    IteratorRaceBufferPool(size_t pool_size, DiskManager *disk_manager)
+        : BufferPoolManagerInstance(pool_size, disk_manager) {}
+
+    Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) override {
+        auto page = BufferPoolManagerInstance::FetchPage(page_id, strategy);
+        if (armed_ && latched_ == nullptr && page != nullptr) {
+            page->WLatch();
+            latched_ = page;
+        }
+        return page;
+    }
+
+    bool UnpinPage(page_id_t page_id, bool is_dirty) override {
+        bool result = BufferPoolManagerInstance::UnpinPage(page_id, is_dirty);
+        if (latched_ != nullptr && latched_->GetPageId() != page_id) {
+            armed_ = false;
+            latched_->WUnlatch();
+            latched_ = nullptr;
+            hook_();
+        }
+        return result;
+    }
+
+    bool armed_{false};
+    Page *latched_{nullptr};
+    std::function<void()> hook_;
+};
+
 TEST(BPlusTreeTest, SequentialInsertTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 50;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     std::vector<Column> cols;
@@ -79,16 +116,16 @@ TEST(BPlusTreeTest, SequentialInsertTest) {
 
     delete disk_manager;
     delete bpm;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 TEST(BPlusTreeTest, RandomInsertTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 50;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     std::vector<Column> cols;
@@ -158,16 +195,16 @@ TEST(BPlusTreeTest, RandomInsertTest) {
 
     delete disk_manager;
     delete bpm;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 TEST(BPlusTreeTest, ConcurrentBasicTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 50;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     std::vector<Column> cols;
@@ -262,16 +299,16 @@ TEST(BPlusTreeTest, ConcurrentBasicTest) {
 
     delete disk_manager;
     delete bpm;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 TEST(BPlusTreeTest, ConcurrentStrictTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 50;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     std::vector<Column> cols;
@@ -384,16 +421,16 @@ TEST(BPlusTreeTest, ConcurrentStrictTest) {
 
     delete disk_manager;
     delete bpm;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 TEST(BPlusTreeTest, BasicIteratorTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 50;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     std::vector<Column> cols;
@@ -465,16 +502,16 @@ TEST(BPlusTreeTest, BasicIteratorTest) {
 
     delete disk_manager;
     delete bpm;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 TEST(BPlusTreeTest, ConcurrentIteratorTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 50;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     std::vector<Column> cols;
@@ -586,7 +623,54 @@ TEST(BPlusTreeTest, ConcurrentIteratorTest) {
 
     delete disk_manager;
     delete bpm;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
-}
\ No newline at end of file
+TEST(BPlusTreeTest, IteratorEmptiedTreeTest) {
+    MemoryDiskManager disk_manager;
+    IteratorRaceBufferPool bpm(50, &disk_manager);
+
+    auto colA = Column("colA", TypeId::BIGINT);
+    std::vector<Column> cols;
+    cols.push_back(colA);
+    auto schema = Schema(cols);
+
+    // small nodes, so that there are several leaves
+    GenericComparator<8> comparator(&schema);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("basic_test", &bpm, comparator, 4, 4);
+    GenericKey<8> index_key;
+    BPlusTreeExecutionContext context;
+
+    int key_num = 16;
+    for (int64_t key = 0; key < key_num; key++) {
+        context.Reset();
+        index_key.SetFromKey(Tuple({Value(TypeId::BIGINT, key)}, &schema));
+        EXPECT_TRUE(tree.Insert(index_key, RID(key), &context));
+    }
+
+    // the iterator fails to latch the second leaf and re-scans the tree, which is
+    // emptied by the time it gets there
+    bpm.hook_ = [&]() {
+        for (int64_t key = 0; key < key_num; key++) {
+            context.Reset();
+            index_key.SetFromKey(Tuple({Value(TypeId::BIGINT, key)}, &schema));
+            EXPECT_TRUE(tree.Remove(index_key, &context));
+        }
+    };
+    int ptr = 0;
+    auto it = tree.Begin();
+    bpm.armed_ = true;
+    for (; !it->IsEnd(); it->Advance()) {
+        EXPECT_EQ(it->Get(), RID(ptr));
+        ptr++;
+    }
+    EXPECT_GT(ptr, 0);
+    EXPECT_LT(ptr, key_num);
+    EXPECT_FALSE(bpm.armed_);
+    EXPECT_TRUE(tree.IsEmpty());
+
+    EXPECT_TRUE(bpm.CheckPinCount());
+    EXPECT_EQ(disk_manager.GetAllocateCount(), disk_manager.GetDeallocateCount());
+}
+
+}
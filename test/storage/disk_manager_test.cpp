@@ -2,15 +2,30 @@
 #include <string>
 #include <random>
 #include <cstring>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <set>
+#include <algorithm>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
-#include "storage/disk/disk_manager.h"
+#include "storage/disk/file_disk_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/latency_disk_manager.h"
+#include "storage/disk/compressed_disk_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/page/page.h"
 #include "common/logger.h"
+#include "common/exception.h"
 
 namespace TinyDB {
 
 TEST(DiskManagerTest, SimpleIOTest) {
     std::string filename = "test.db";
-    DiskManager diskManager(filename);
+    FileDiskManager diskManager(filename);
 
     std::string testString1 = "hello world";
     std::string testString2 = "hello tinydb";
@@ -38,7 +53,7 @@ TEST(DiskManagerTest, SimpleIOTest) {
     res = strcmp(readBuffer, testString2.c_str());
     EXPECT_EQ(0, res);
 
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 TEST(DiskManagerTest, StrongTest) {
@@ -46,7 +61,7 @@ TEST(DiskManagerTest, StrongTest) {
     std::mt19937 mt(rd());
     std::uniform_int_distribution<int> dis(0, 255);
     std::string filename = "test.db";
-    auto dm = new DiskManager(filename);
+    auto dm = new FileDiskManager(filename);
     const int test_num = 100;
     std::vector<char *> data_list(test_num);
 
@@ -65,7 +80,7 @@ TEST(DiskManagerTest, StrongTest) {
     delete dm;
 
     // reopen it and test whether the content is stable
-    auto dm2 = new DiskManager(filename);
+    auto dm2 = new FileDiskManager(filename);
 
     for (int i = 0; i < test_num; i++) {
         char buffer[PAGE_SIZE];
@@ -79,7 +94,957 @@ TEST(DiskManagerTest, StrongTest) {
 
     delete dm2;
 
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
-}
\ No newline at end of file
+TEST(DiskManagerTest, ConcurrentReadWriteTest) {
+    std::string filename = "test.db";
+    RemoveDatabaseFiles(filename);
+    auto dm = new FileDiskManager(filename);
+
+    const int worker_num = 8;
+    const int page_per_worker = 64;
+    const int iteration_num = 20;
+
+    // every worker owns a range of pages, and will stamp the page id and
+    // a version number into it, so we can check the content after reading
+    std::vector<page_id_t> page_list(worker_num * page_per_worker);
+    for (size_t i = 0; i < page_list.size(); i++) {
+        page_list[i] = dm->AllocatePage();
+    }
+
+    auto fill_page = [](char *data, page_id_t page_id, int version) {
+        auto *words = reinterpret_cast<int32_t *> (data);
+        for (uint32_t i = 0; i < PAGE_SIZE / sizeof(int32_t); i += 2) {
+            words[i] = page_id;
+            words[i + 1] = version;
+        }
+    };
+
+    std::atomic<int> error_cnt(0);
+    std::atomic<int64_t> io_cnt(0);
+    std::vector<std::thread> worker_list;
+    auto t1 = std::chrono::steady_clock::now();
+    for (int worker = 0; worker < worker_num; worker++) {
+        worker_list.emplace_back(std::thread([&, worker]() {
+            std::mt19937 mt(worker);
+            std::uniform_int_distribution<int> dis(0, page_list.size() - 1);
+            char buffer[PAGE_SIZE];
+
+            for (int version = 0; version < iteration_num; version++) {
+                for (int i = 0; i < page_per_worker; i++) {
+                    page_id_t page_id = page_list[worker * page_per_worker + i];
+                    fill_page(buffer, page_id, version);
+                    dm->WritePage(page_id, buffer);
+
+                    // our own page should be exactly the same as what we've written
+                    dm->ReadPage(page_id, buffer);
+                    auto *words = reinterpret_cast<int32_t *> (buffer);
+                    if (words[0] != page_id || words[1] != version) {
+                        error_cnt++;
+                    }
+
+                    // reading other's page. the version might be any one of them,
+                    // but the page id should never be mixed up
+                    page_id_t other = page_list[dis(mt)];
+                    dm->ReadPage(other, buffer);
+                    for (uint32_t j = 0; j < PAGE_SIZE / sizeof(int32_t); j += 2) {
+                        if (words[j] != other && words[j] != 0) {
+                            error_cnt++;
+                            break;
+                        }
+                    }
+                    io_cnt += 3;
+                }
+            }
+        }));
+    }
+
+    for (auto &worker : worker_list) {
+        worker.join();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1);
+    LOG_INFO("%ld page I/Os with %d threads in %ld ms, %.0f IOPS",
+        io_cnt.load(), worker_num, interval.count(), io_cnt.load() * 1000.0 / std::max<int64_t>(interval.count(), 1));
+
+    EXPECT_EQ(error_cnt.load(), 0);
+
+    // the final version should be persisted
+    char buffer[PAGE_SIZE];
+    for (auto page_id : page_list) {
+        dm->ReadPage(page_id, buffer);
+        auto *words = reinterpret_cast<int32_t *> (buffer);
+        EXPECT_EQ(words[0], page_id);
+        EXPECT_EQ(words[1], iteration_num - 1);
+    }
+
+    delete dm;
+    RemoveDatabaseFiles(filename);
+}
+
+TEST(DiskManagerTest, AsyncIOTest) {
+    std::string filename = "test.db";
+    RemoveDatabaseFiles(filename);
+
+    for (auto type : {IOEngineType::THREAD_POOL, IOEngineType::AUTO}) {
+        auto dm = new FileDiskManager(filename, type);
+        const int page_num = 100;
+        std::vector<char> write_buffer(page_num * PAGE_SIZE);
+        std::vector<char> read_buffer(page_num * PAGE_SIZE);
+
+        std::vector<DiskRequest> requests;
+        for (int i = 0; i < page_num; i++) {
+            page_id_t page_id = dm->AllocatePage();
+            char *data = write_buffer.data() + i * PAGE_SIZE;
+            snprintf(data, PAGE_SIZE, "page %d", page_id);
+            requests.push_back(DiskRequest{true, page_id, data});
+        }
+        dm->SubmitBatch(requests);
+        for (auto &request : requests) {
+            EXPECT_TRUE(request.handle_->Wait());
+        }
+
+        std::vector<IOHandle> handles;
+        for (int i = 0; i < page_num; i++) {
+            handles.push_back(dm->SubmitRead(requests[i].page_id_, read_buffer.data() + i * PAGE_SIZE));
+        }
+        for (int i = 0; i < page_num; i++) {
+            EXPECT_TRUE(handles[i]->Wait());
+            EXPECT_EQ(std::memcmp(read_buffer.data() + i * PAGE_SIZE, write_buffer.data() + i * PAGE_SIZE, PAGE_SIZE), 0);
+        }
+
+        // synchronous read should see the asynchronous write
+        memset(write_buffer.data(), 'x', PAGE_SIZE);
+        EXPECT_TRUE(dm->SubmitWrite(requests[0].page_id_, write_buffer.data())->Wait());
+        dm->ReadPage(requests[0].page_id_, read_buffer.data());
+        EXPECT_EQ(std::memcmp(read_buffer.data(), write_buffer.data(), PAGE_SIZE), 0);
+
+        delete dm;
+        RemoveDatabaseFiles(filename);
+    }
+}
+
+TEST(DiskManagerTest, DirectIOTest) {
+    std::string filename = "test.db";
+    RemoveDatabaseFiles(filename);
+
+    // frames should be ready for direct I/O
+    auto frames = new Page[3];
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(frames[i].GetData()) % PAGE_ALIGNMENT, 0);
+    }
+
+    auto dm = new FileDiskManager(filename, IOEngineType::AUTO, true);
+    page_id_t page0 = dm->AllocatePage();
+    page_id_t page1 = dm->AllocatePage();
+    page_id_t page2 = dm->AllocatePage();
+
+    // aligned buffer
+    strcpy(frames[0].GetData(), "hello direct io");
+    dm->WritePage(page0, frames[0].GetData());
+    // unaligned buffer will go through bounce buffer
+    char unaligned[PAGE_SIZE + 1];
+    memset(unaligned, 0, sizeof(unaligned));
+    strcpy(unaligned + 1, "hello unaligned");
+    dm->WritePage(page1, unaligned + 1);
+    // asynchronous write with aligned frame
+    strcpy(frames[2].GetData(), "hello async");
+    EXPECT_TRUE(dm->SubmitWrite(page2, frames[2].GetData())->Wait());
+    delete dm;
+
+    // read them back with buffered I/O
+    dm = new FileDiskManager(filename);
+    char buffer[PAGE_SIZE];
+    dm->ReadPage(page0, buffer);
+    EXPECT_EQ(strcmp(buffer, "hello direct io"), 0);
+    dm->ReadPage(page1, buffer);
+    EXPECT_EQ(strcmp(buffer, "hello unaligned"), 0);
+    dm->ReadPage(page2, buffer);
+    EXPECT_EQ(strcmp(buffer, "hello async"), 0);
+    delete dm;
+
+    // and with direct I/O
+    dm = new FileDiskManager(filename, IOEngineType::AUTO, true);
+    dm->ReadPage(page0, frames[1].GetData());
+    EXPECT_EQ(strcmp(frames[1].GetData(), "hello direct io"), 0);
+    dm->ReadPage(page1, unaligned + 1);
+    EXPECT_EQ(strcmp(unaligned + 1, "hello unaligned"), 0);
+    EXPECT_TRUE(dm->SubmitRead(page2, frames[1].GetData())->Wait());
+    EXPECT_EQ(strcmp(frames[1].GetData(), "hello async"), 0);
+    delete dm;
+
+    delete[] frames;
+    RemoveDatabaseFiles(filename);
+}
+
+TEST(DiskManagerTest, PageReuseTest) {
+    std::string filename = "test.db";
+    RemoveDatabaseFiles(filename);
+
+    auto dm = new FileDiskManager(filename);
+    char buffer[PAGE_SIZE];
+    memset(buffer, 'x', sizeof(buffer));
+
+    std::vector<page_id_t> page_list;
+    for (int i = 0; i < 100; i++) {
+        page_list.push_back(dm->AllocatePage());
+        dm->WritePage(page_list.back(), buffer);
+    }
+    // file is preallocated in extents
+    EXPECT_EQ(dm->GetPageCount() % EXTENT_SIZE, 0);
+    EXPECT_GE(dm->GetPageCount(), 100);
+    page_id_t page_count = dm->GetPageCount();
+
+    for (int i = 0; i < 100; i += 2) {
+        dm->DeallocatePage(page_list[i]);
+    }
+    EXPECT_EQ(dm->GetDeallocateCount(), 50);
+    delete dm;
+
+    // allocation state survives restart
+    dm = new FileDiskManager(filename);
+    EXPECT_EQ(dm->GetPageCount(), page_count);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(dm->IsAllocated(page_list[i]), i % 2 == 1);
+    }
+
+    // freed pages are reused and wiped out
+    std::set<page_id_t> freed;
+    for (int i = 0; i < 100; i += 2) {
+        freed.insert(page_list[i]);
+    }
+    for (int i = 0; i < 50; i++) {
+        page_id_t page_id = dm->AllocatePage();
+        EXPECT_EQ(freed.count(page_id), 1);
+        dm->ReadPage(page_id, buffer);
+        for (uint32_t j = 0; j < PAGE_SIZE; j++) {
+            if (buffer[j] != 0) {
+                ADD_FAILURE() << "reused page " << page_id << " is not zero";
+                break;
+            }
+        }
+    }
+    // file didn't grow
+    EXPECT_EQ(dm->GetPageCount(), page_count);
+
+    // contiguous pages
+    page_id_t first = dm->AllocateExtent(EXTENT_SIZE * 2);
+    for (page_id_t i = first; i < first + static_cast<page_id_t>(EXTENT_SIZE) * 2; i++) {
+        EXPECT_TRUE(dm->IsAllocated(i));
+    }
+
+    delete dm;
+    RemoveDatabaseFiles(filename);
+}
+
+TEST(DiskManagerTest, VectoredIOTest) {
+    std::string filename = "test.db";
+    RemoveDatabaseFiles(filename);
+    auto dm = new FileDiskManager(filename);
+
+    const int page_num = 300;
+    // two contiguous runs with a gap in between, and shuffled
+    std::vector<page_id_t> page_ids;
+    for (int i = 0; i < page_num; i++) {
+        page_ids.push_back(i < page_num / 2 ? i : i + 10);
+    }
+    std::shuffle(page_ids.begin(), page_ids.end(), std::mt19937(0));
+
+    std::vector<Page> pages(page_num);
+    std::vector<const char *> write_buffers;
+    for (int i = 0; i < page_num; i++) {
+        snprintf(pages[i].GetData(), PAGE_SIZE, "page %d", page_ids[i]);
+        pages[i].GetData()[PAGE_SIZE - 1] = static_cast<char> (page_ids[i]);
+        write_buffers.push_back(pages[i].GetData());
+    }
+    dm->WritePages(page_ids, write_buffers);
+
+    // read them back one by one
+    char buffer[PAGE_SIZE];
+    for (int i = 0; i < page_num; i++) {
+        dm->ReadPage(page_ids[i], buffer);
+        EXPECT_EQ(memcmp(buffer, pages[i].GetData(), PAGE_SIZE), 0);
+    }
+
+    // read them back in another order, together with a page in the gap and one past the end of file
+    std::vector<page_id_t> read_ids(page_ids.rbegin(), page_ids.rend());
+    read_ids.push_back(page_num / 2 + 5);
+    read_ids.push_back(page_num + 100);
+    std::vector<Page> read_pages(read_ids.size());
+    std::vector<char *> read_buffers;
+    for (auto &page : read_pages) {
+        memset(page.GetData(), 'x', PAGE_SIZE);
+        read_buffers.push_back(page.GetData());
+    }
+    dm->ReadPages(read_ids, read_buffers);
+    for (int i = 0; i < page_num; i++) {
+        EXPECT_EQ(memcmp(read_buffers[i], pages[page_num - 1 - i].GetData(), PAGE_SIZE), 0);
+    }
+    memset(buffer, 0, sizeof(buffer));
+    EXPECT_EQ(memcmp(read_buffers[page_num], buffer, PAGE_SIZE), 0);
+    EXPECT_EQ(memcmp(read_buffers[page_num + 1], buffer, PAGE_SIZE), 0);
+
+    delete dm;
+    RemoveDatabaseFiles(filename);
+}
+
+// pages beyond 4GiB, file is sparse so it won't take much space
+TEST(DiskManagerTest, LargeFileTest) {
+    std::string filename = "test.db";
+    RemoveDatabaseFiles(filename);
+
+    // make sure file system could hold such a large file
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    ASSERT_GE(fd, 0);
+    bool supported = ftruncate(fd, (5LL << 30)) == 0;
+    close(fd);
+    RemoveDatabaseFiles(filename);
+    if (!supported) {
+        GTEST_SKIP() << "file system doesn't support large file";
+    }
+
+    const page_id_t boundary_2g = static_cast<page_id_t>((1LL << 31) / PAGE_SIZE);
+    const page_id_t boundary_4g = static_cast<page_id_t>((1LL << 32) / PAGE_SIZE);
+    std::vector<page_id_t> page_list = {
+        0, boundary_2g - 1, boundary_2g, boundary_4g - 1, boundary_4g, boundary_4g + 1, boundary_4g * 2 - 1
+    };
+
+    auto dm = new FileDiskManager(filename);
+    char buffer[PAGE_SIZE];
+    for (auto page_id : page_list) {
+        memset(buffer, 0, sizeof(buffer));
+        snprintf(buffer, sizeof(buffer), "page %d", page_id);
+        // mark the tail as well, so we can tell whether the whole page lands at right place
+        snprintf(buffer + PAGE_SIZE - 16, 16, "tail %d", page_id % 100000);
+        dm->WritePage(page_id, buffer);
+    }
+    delete dm;
+
+    struct stat stat_buf;
+    ASSERT_EQ(stat(filename.c_str(), &stat_buf), 0);
+    EXPECT_EQ(static_cast<int64_t>(stat_buf.st_size), static_cast<int64_t>(boundary_4g) * 2 * PAGE_SIZE);
+
+    // read them back after restart
+    dm = new FileDiskManager(filename);
+    char expected[PAGE_SIZE];
+    for (auto page_id : page_list) {
+        memset(expected, 0, sizeof(expected));
+        snprintf(expected, sizeof(expected), "page %d", page_id);
+        snprintf(expected + PAGE_SIZE - 16, 16, "tail %d", page_id % 100000);
+        dm->ReadPage(page_id, buffer);
+        EXPECT_EQ(memcmp(buffer, expected, PAGE_SIZE), 0) << "page " << page_id;
+    }
+
+    // asynchronous path uses the same offset
+    dm->ReadPage(boundary_4g + 2, buffer);
+    memset(expected, 0, sizeof(expected));
+    EXPECT_EQ(memcmp(buffer, expected, PAGE_SIZE), 0);
+    snprintf(buffer, sizeof(buffer), "async page");
+    EXPECT_TRUE(dm->SubmitWrite(boundary_4g + 2, buffer)->Wait());
+    memset(expected, 0, sizeof(expected));
+    EXPECT_TRUE(dm->SubmitRead(boundary_4g + 2, expected)->Wait());
+    EXPECT_EQ(memcmp(buffer, expected, PAGE_SIZE), 0);
+
+    delete dm;
+    RemoveDatabaseFiles(filename);
+}
+
+TEST(DiskManagerTest, StripingTest) {
+    std::string filename = "test.db";
+    std::vector<std::string> data_files = {"test.1.db", "test_stripe_dir/test.2.db"};
+    mkdir("test_stripe_dir", 0755);
+    RemoveDatabaseFiles(filename);
+
+    auto dm = new FileDiskManager(filename, IOEngineType::AUTO, false, data_files);
+    EXPECT_EQ(dm->GetDataFileNum(), 3);
+
+    const int page_num = EXTENT_SIZE * 3 * 4 + 10;
+    char buffer[PAGE_SIZE];
+    std::vector<page_id_t> page_ids;
+    std::vector<Page> pages(page_num);
+    std::vector<const char *> write_buffers;
+    for (int i = 0; i < page_num; i++) {
+        page_ids.push_back(dm->AllocatePage());
+        snprintf(pages[i].GetData(), PAGE_SIZE, "page %d", page_ids[i]);
+        write_buffers.push_back(pages[i].GetData());
+    }
+    // half of them through single page I/O, the rest through vectored I/O crossing stripes
+    for (int i = 0; i < page_num / 2; i++) {
+        dm->WritePage(page_ids[i], write_buffers[i]);
+    }
+    dm->WritePages(std::vector<page_id_t>(page_ids.begin() + page_num / 2, page_ids.end()),
+                   std::vector<const char *>(write_buffers.begin() + page_num / 2, write_buffers.end()));
+    delete dm;
+
+    // pages are spread evenly, stripe i is in file i % 3
+    struct stat stat_buf;
+    std::vector<std::string> all_files = {filename, data_files[0], data_files[1]};
+    for (const auto &file : all_files) {
+        ASSERT_EQ(stat(file.c_str(), &stat_buf), 0);
+        EXPECT_GE(stat_buf.st_size, static_cast<off_t>(EXTENT_SIZE) * 4 * PAGE_SIZE) << file;
+    }
+    int fd = open(data_files[1].c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(pread(fd, buffer, PAGE_SIZE, PAGE_SIZE), PAGE_SIZE);
+    close(fd);
+    EXPECT_EQ(std::string(buffer), "page " + std::to_string(EXTENT_SIZE * 2 + 1));
+
+    // layout is persisted, we don't need to tell it again
+    dm = new FileDiskManager(filename);
+    EXPECT_EQ(dm->GetDataFileNum(), 3);
+    for (int i = 0; i < page_num; i++) {
+        dm->ReadPage(page_ids[i], buffer);
+        EXPECT_EQ(memcmp(buffer, pages[i].GetData(), PAGE_SIZE), 0);
+    }
+    std::vector<Page> read_pages(page_num);
+    std::vector<char *> read_buffers;
+    for (auto &page : read_pages) {
+        read_buffers.push_back(page.GetData());
+    }
+    dm->ReadPages(page_ids, read_buffers);
+    for (int i = 0; i < page_num; i++) {
+        EXPECT_EQ(memcmp(read_buffers[i], pages[i].GetData(), PAGE_SIZE), 0);
+    }
+    for (int i = 0; i < 10; i++) {
+        EXPECT_TRUE(dm->SubmitRead(page_ids[page_num - 1 - i], buffer)->Wait());
+        EXPECT_EQ(memcmp(buffer, pages[page_num - 1 - i].GetData(), PAGE_SIZE), 0);
+    }
+    delete dm;
+
+    RemoveDatabaseFiles(filename);
+    rmdir("test_stripe_dir");
+}
+
+TEST(DiskManagerTest, ReopenStripedTest) {
+    std::string filename = "test.db";
+    std::vector<std::string> data_files = {"test.1.db"};
+    RemoveDatabaseFiles(filename);
+
+    // the first stripe is in db file, the second one is in test.1.db
+    auto dm = new FileDiskManager(filename, IOEngineType::AUTO, false, data_files);
+    std::vector<page_id_t> page_ids;
+    for (uint32_t i = 0; i < EXTENT_SIZE + 1; i++) {
+        page_ids.push_back(dm->AllocatePage());
+    }
+    Page page;
+    snprintf(page.GetData(), PAGE_SIZE, "page %d", page_ids.back());
+    dm->WritePage(page_ids.back(), page.GetData());
+    delete dm;
+
+    // db file is empty, but descriptor and metadata tell us the database exists.
+    // data files it lists shouldn't be truncated
+    ASSERT_EQ(truncate(filename.c_str(), 0), 0);
+    dm = new FileDiskManager(filename, IOEngineType::AUTO, false, data_files);
+    EXPECT_EQ(dm->GetDataFileNum(), 2);
+    EXPECT_TRUE(dm->IsAllocated(page_ids.back()));
+    char buffer[PAGE_SIZE];
+    dm->ReadPage(page_ids.back(), buffer);
+    EXPECT_EQ(memcmp(buffer, page.GetData(), PAGE_SIZE), 0);
+    delete dm;
+
+    // pages can't be recovered without metadata, don't pretend they are free
+    std::string meta_filename = GetDatabaseFileName(filename, ".meta");
+    ASSERT_EQ(truncate(meta_filename.c_str(), 16), 0);
+    EXPECT_THROW(FileDiskManager dm2(filename), Exception);
+    remove(meta_filename.c_str());
+    EXPECT_THROW(FileDiskManager dm2(filename), Exception);
+
+    RemoveDatabaseFiles(filename);
+}
+
+TEST(DiskManagerTest, MemoryDiskManagerTest) {
+    MemoryDiskManager dm;
+    char buffer[PAGE_SIZE];
+    char data[PAGE_SIZE];
+
+    // pages never written are zero
+    page_id_t page0 = dm.AllocatePage();
+    page_id_t page1 = dm.AllocatePage(page0);
+    EXPECT_EQ(page1, page0 + 1);
+    memset(buffer, 'x', sizeof(buffer));
+    dm.ReadPage(page0, buffer);
+    memset(data, 0, sizeof(data));
+    EXPECT_EQ(memcmp(buffer, data, PAGE_SIZE), 0);
+
+    snprintf(data, sizeof(data), "hello tinydb");
+    dm.WritePage(page1, data);
+    dm.ReadPage(page1, buffer);
+    EXPECT_EQ(memcmp(buffer, data, PAGE_SIZE), 0);
+
+    // deallocated page is reused and wiped out
+    dm.DeallocatePage(page1);
+    EXPECT_FALSE(dm.IsAllocated(page1));
+    EXPECT_EQ(dm.GetFreePageCount(), 1);
+    EXPECT_EQ(dm.AllocatePage(), page1);
+    dm.ReadPage(page1, buffer);
+    memset(data, 0, sizeof(data));
+    EXPECT_EQ(memcmp(buffer, data, PAGE_SIZE), 0);
+    EXPECT_EQ(dm.GetAllocateCount(), 3);
+    EXPECT_EQ(dm.GetDeallocateCount(), 1);
+
+    // log
+    char log[] = "some log records";
+    dm.WriteLog(log, sizeof(log));
+    dm.WriteLog(log, sizeof(log));
+    EXPECT_TRUE(dm.ReadLog(buffer, 64, sizeof(log)));
+    EXPECT_STREQ(buffer, log);
+    EXPECT_FALSE(dm.ReadLog(buffer, 64, sizeof(log) * 2));
+
+    // buffer pool runs on top of it
+    BufferPoolManagerInstance bpm(4, &dm);
+    std::vector<page_id_t> page_ids(16);
+    for (int i = 0; i < 16; i++) {
+        auto page = bpm.NewPage(&page_ids[i]);
+        ASSERT_NE(page, nullptr);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+        bpm.UnpinPage(page_ids[i], true);
+    }
+    for (int i = 0; i < 16; i++) {
+        auto page = bpm.FetchPage(page_ids[i]);
+        ASSERT_NE(page, nullptr);
+        EXPECT_EQ(std::string(page->GetData()), "page " + std::to_string(i));
+        bpm.UnpinPage(page_ids[i], false);
+    }
+}
+
+TEST(DiskManagerTest, LatencyDiskManagerTest) {
+    MemoryDiskManager memory_dm;
+    DeviceProfile profile;
+    profile.read_latency_ = std::chrono::microseconds(1000);
+    profile.write_latency_ = std::chrono::microseconds(500);
+    profile.sync_latency_ = std::chrono::microseconds(2000);
+    profile.queue_depth_ = 4;
+    LatencyDiskManager dm(&memory_dm, profile);
+
+    char buffer[PAGE_SIZE];
+    memset(buffer, 0, sizeof(buffer));
+    std::vector<page_id_t> page_ids;
+    for (int i = 0; i < 16; i++) {
+        page_ids.push_back(dm.AllocatePage());
+    }
+
+    auto elapsed = [](auto t1) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t1).count();
+    };
+
+    // every single page request pays the latency
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; i++) {
+        dm.ReadPage(page_ids[i], buffer);
+    }
+    EXPECT_GE(elapsed(t1), 10 * 1000);
+
+    t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; i++) {
+        dm.WritePage(page_ids[i], buffer);
+    }
+    EXPECT_GE(elapsed(t1), 10 * 500);
+
+    t1 = std::chrono::steady_clock::now();
+    dm.Sync();
+    EXPECT_GE(elapsed(t1), 2000);
+
+    // 8 random pages are 8 requests, served 4 at a time
+    std::vector<page_id_t> random_ids;
+    std::vector<char *> buffers;
+    std::vector<Page> pages(8);
+    for (int i = 0; i < 8; i++) {
+        random_ids.push_back(page_ids[i * 2]);
+        buffers.push_back(pages[i].GetData());
+    }
+    t1 = std::chrono::steady_clock::now();
+    dm.ReadPages(random_ids, buffers);
+    EXPECT_GE(elapsed(t1), 2 * 1000);
+
+    // 8 contiguous pages are a single request
+    std::vector<page_id_t> sequential_ids(page_ids.begin(), page_ids.begin() + 8);
+    t1 = std::chrono::steady_clock::now();
+    dm.ReadPages(sequential_ids, buffers);
+    auto sequential_time = elapsed(t1);
+    EXPECT_GE(sequential_time, 1000);
+
+    // queue is shared, 8 threads issuing 5 requests each are still served 4 at a time
+    t1 = std::chrono::steady_clock::now();
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 8; i++) {
+        readers.emplace_back([&, i]() {
+            char local_buffer[PAGE_SIZE];
+            for (int j = 0; j < 5; j++) {
+                dm.ReadPage(page_ids[i], local_buffer);
+            }
+        });
+    }
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_GE(elapsed(t1), 10 * 1000);
+
+    // bandwidth limit, 64 pages at 64 pages per 100ms
+    profile.read_latency_ = std::chrono::microseconds(0);
+    profile.read_bandwidth_ = static_cast<uint64_t>(PAGE_SIZE) * 640;
+    LatencyDiskManager slow_dm(&memory_dm, profile);
+    t1 = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&]() {
+            char local_buffer[PAGE_SIZE];
+            for (int j = 0; j < 16; j++) {
+                slow_dm.ReadPage(page_ids[j], local_buffer);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_GE(elapsed(t1), 100 * 1000);
+
+    // asynchronous submission returns before the device serves it, the device thread
+    // completes it. device is paused, so it can't complete before we look at it
+    dm.Pause();
+    t1 = std::chrono::steady_clock::now();
+    dm.ResetIOStats();
+    std::vector<DiskRequest> requests;
+    for (int i = 0; i < 4; i++) {
+        requests.push_back(DiskRequest{false, page_ids[i * 2], pages[i].GetData()});
+    }
+    requests.push_back(DiskRequest{true, page_ids[15], buffer});
+    dm.SubmitBatch(requests);
+    dm.WaitForStalled(1);
+    for (auto &request : requests) {
+        EXPECT_FALSE(request.handle_->IsDone());
+    }
+    dm.Resume();
+    for (auto &request : requests) {
+        EXPECT_TRUE(request.handle_->Wait());
+    }
+    // the batch shares the latency of the slowest request
+    EXPECT_GE(elapsed(t1), 1000);
+    auto stats = dm.GetIOStats();
+    EXPECT_EQ(stats.page_read_.ops_, 4UL);
+    EXPECT_EQ(stats.page_write_.ops_, 1UL);
+    EXPECT_GE(stats.page_read_.latency_.max_, 1000UL * 1000);
+
+    // sync queues behind the batches in flight. 8 random reads are served 4 at a time
+    requests.clear();
+    for (int i = 0; i < 8; i++) {
+        requests.push_back(DiskRequest{false, page_ids[i * 2], pages[i].GetData()});
+    }
+    t1 = std::chrono::steady_clock::now();
+    dm.SubmitBatch(requests);
+    dm.Sync();
+    EXPECT_GE(elapsed(t1), 2 * 1000 + 2000);
+    for (auto &request : requests) {
+        EXPECT_TRUE(request.handle_->Wait());
+    }
+
+    // sync and log writes are stalled by a paused device as well
+    dm.Pause();
+    std::atomic<int> done{0};
+    std::thread syncer([&]() {
+        dm.Sync();
+        done++;
+    });
+    std::thread logger([&]() {
+        char log[16] = "log";
+        dm.WriteLog(log, sizeof(log));
+        done++;
+    });
+    dm.WaitForStalled(2);
+    EXPECT_EQ(0, done.load());
+    dm.Resume();
+    syncer.join();
+    logger.join();
+    EXPECT_EQ(2, done.load());
+
+    // allocation is forwarded
+    dm.DeallocatePage(page_ids[0]);
+    EXPECT_FALSE(memory_dm.IsAllocated(page_ids[0]));
+    EXPECT_EQ(dm.GetAllocateCount(), 16);
+    EXPECT_EQ(dm.GetDeallocateCount(), 1);
+}
+
+TEST(DiskManagerTest, IOStatsTest) {
+    std::string filename = "test.db";
+    RemoveDatabaseFiles(filename);
+    auto dm = new FileDiskManager(filename);
+
+    std::vector<Page> pages(16);
+    std::vector<page_id_t> page_ids;
+    for (int i = 0; i < 16; i++) {
+        page_ids.push_back(dm->AllocatePage());
+    }
+    dm->ResetIOStats();
+
+    for (int i = 0; i < 8; i++) {
+        dm->WritePage(page_ids[i], pages[i].GetData());
+        dm->ReadPage(page_ids[i], pages[i].GetData());
+    }
+
+    // contiguous pages are transferred by a single request
+    std::vector<char *> buffers;
+    for (auto &page : pages) {
+        buffers.push_back(page.GetData());
+    }
+    dm->ReadPages(page_ids, buffers);
+
+    // asynchronous I/O is recorded once it's finished
+    auto handle = dm->SubmitWrite(page_ids[8], pages[8].GetData());
+    EXPECT_TRUE(handle->Wait());
+
+    char log_buffer[100];
+    memset(log_buffer, 0, sizeof(log_buffer));
+    dm->WriteLog(log_buffer, sizeof(log_buffer));
+    dm->Sync();
+    EXPECT_TRUE(dm->ReadLog(log_buffer, sizeof(log_buffer), 0));
+    // nothing to read
+    EXPECT_FALSE(dm->ReadLog(log_buffer, sizeof(log_buffer), sizeof(log_buffer)));
+
+    auto stats = dm->GetIOStats();
+    EXPECT_EQ(stats.page_read_.ops_, 9UL);
+    EXPECT_EQ(stats.page_read_.bytes_, 24UL * PAGE_SIZE);
+    EXPECT_EQ(stats.page_write_.ops_, 9UL);
+    EXPECT_EQ(stats.page_write_.bytes_, 9UL * PAGE_SIZE);
+    EXPECT_EQ(stats.log_write_.ops_, 1UL);
+    EXPECT_EQ(stats.log_write_.bytes_, sizeof(log_buffer));
+    EXPECT_EQ(stats.log_read_.ops_, 1UL);
+    EXPECT_EQ(stats.log_read_.bytes_, sizeof(log_buffer));
+    EXPECT_EQ(stats.sync_.ops_, 1UL);
+
+    // latency histogram should agree with the counters
+    EXPECT_EQ(stats.page_read_.latency_.count_, 9UL);
+    EXPECT_GT(stats.page_read_.latency_.max_, 0UL);
+    EXPECT_LE(stats.page_read_.latency_.Percentile(0.5), stats.page_read_.latency_.Percentile(0.99));
+    EXPECT_LE(stats.page_read_.latency_.Percentile(0.99), stats.page_read_.latency_.max_);
+    EXPECT_FALSE(stats.ToString().empty());
+
+    dm->ResetIOStats();
+    stats = dm->GetIOStats();
+    EXPECT_EQ(stats.page_read_.ops_, 0UL);
+    EXPECT_EQ(stats.page_write_.latency_.count_, 0UL);
+
+    // wrapper records latency it simulates
+    MemoryDiskManager memory_dm;
+    DeviceProfile profile;
+    profile.read_latency_ = std::chrono::microseconds(1000);
+    LatencyDiskManager latency_dm(&memory_dm, profile);
+    auto page_id = latency_dm.AllocatePage();
+    latency_dm.ReadPage(page_id, pages[0].GetData());
+    latency_dm.WriteLog(log_buffer, sizeof(log_buffer));
+    EXPECT_TRUE(latency_dm.ReadLog(log_buffer, sizeof(log_buffer), 0));
+    stats = latency_dm.GetIOStats();
+    EXPECT_EQ(stats.page_read_.ops_, 1UL);
+    EXPECT_GE(stats.page_read_.latency_.max_, 1000UL * 1000);
+    EXPECT_EQ(stats.log_read_.ops_, 1UL);
+    EXPECT_GE(stats.log_read_.latency_.max_, 1000UL * 1000);
+    EXPECT_EQ(memory_dm.GetIOStats().page_read_.ops_, 1UL);
+    EXPECT_EQ(memory_dm.GetIOStats().log_read_.ops_, 1UL);
+
+    delete dm;
+    RemoveDatabaseFiles(filename);
+}
+
+TEST(DiskManagerTest, CompressedDiskManagerTest) {
+    std::string filename = "test.db";
+    RemoveDatabaseFiles(filename);
+    auto dm = new CompressedDiskManager(filename);
+
+    // text pages compress well, random pages don't
+    std::mt19937 mt(0);
+    const int page_num = 64;
+    std::vector<std::vector<char>> pages(page_num, std::vector<char>(PAGE_SIZE));
+    std::vector<page_id_t> page_ids;
+    for (int i = 0; i < page_num; i++) {
+        page_ids.push_back(dm->AllocatePage());
+        if (i % 4 == 0) {
+            for (auto &byte : pages[i]) {
+                byte = static_cast<char>(mt());
+            }
+        } else {
+            for (uint32_t j = 0; j + 32 < PAGE_SIZE; j += 32) {
+                snprintf(pages[i].data() + j, 32, "page %d, tuple %u", i, j);
+            }
+        }
+        dm->WritePage(page_ids[i], pages[i].data());
+    }
+    EXPECT_LT(dm->GetStoredBytes(), static_cast<uint64_t>(page_num) * PAGE_SIZE / 2);
+
+    char buffer[PAGE_SIZE];
+    for (int i = 0; i < page_num; i++) {
+        dm->ReadPage(page_ids[i], buffer);
+        EXPECT_EQ(memcmp(buffer, pages[i].data(), PAGE_SIZE), 0);
+    }
+
+    // new page reads as zero
+    char zero[PAGE_SIZE];
+    memset(zero, 0, sizeof(zero));
+    auto new_page_id = dm->AllocatePage();
+    dm->ReadPage(new_page_id, buffer);
+    EXPECT_EQ(memcmp(buffer, zero, PAGE_SIZE), 0);
+
+    // page moves to another slot when its size changes, and slots are reused
+    std::swap(pages[0], pages[1]);
+    dm->WritePage(page_ids[0], pages[0].data());
+    dm->WritePage(page_ids[1], pages[1].data());
+    auto stored_bytes = dm->GetStoredBytes();
+    auto file_size = dm->GetDataFileSize();
+    for (int i = 0; i < 10; i++) {
+        std::swap(pages[0], pages[1]);
+        dm->WritePage(page_ids[0], pages[0].data());
+        dm->WritePage(page_ids[1], pages[1].data());
+    }
+    EXPECT_EQ(dm->GetStoredBytes(), stored_bytes);
+    EXPECT_LE(dm->GetDataFileSize(), file_size + 2 * PAGE_SIZE);
+
+    // deallocated page reads as zero when it's handed out again
+    dm->DeallocatePage(page_ids[2]);
+    EXPECT_EQ(dm->AllocatePage(), page_ids[2]);
+    dm->ReadPage(page_ids[2], buffer);
+    EXPECT_EQ(memcmp(buffer, zero, PAGE_SIZE), 0);
+    pages[2].assign(PAGE_SIZE, 0);
+
+    // page map survives restart
+    stored_bytes = dm->GetStoredBytes();
+    dm->Sync();
+    delete dm;
+    dm = new CompressedDiskManager(filename);
+    for (int i = 0; i < page_num; i++) {
+        dm->ReadPage(page_ids[i], buffer);
+        EXPECT_EQ(memcmp(buffer, pages[i].data(), PAGE_SIZE), 0);
+    }
+    EXPECT_EQ(dm->GetStoredBytes(), stored_bytes);
+    EXPECT_TRUE(dm->IsAllocated(new_page_id));
+
+    // bytes in stats are the compressed ones
+    dm->ResetIOStats();
+    dm->ReadPage(page_ids[3], buffer);
+    EXPECT_LT(dm->GetIOStats().page_read_.bytes_, static_cast<uint64_t>(PAGE_SIZE));
+
+    delete dm;
+    RemoveDatabaseFiles(filename);
+}
+
+TEST(DiskManagerTest, CompressedDiskManagerReopenTest) {
+    std::string filename = "test.db";
+    std::string map_filename = GetDatabaseFileName(filename, ".pagemap");
+    std::string meta_filename = GetDatabaseFileName(filename, ".meta");
+    RemoveDatabaseFiles(filename);
+
+    auto dm = new CompressedDiskManager(filename);
+    char data[PAGE_SIZE];
+    for (int i = 0; i < 4; i++) {
+        snprintf(data, PAGE_SIZE, "page %d", i);
+        dm->WritePage(dm->AllocatePage(), data);
+    }
+    dm->Sync();
+    delete dm;
+
+    // db file lost its data, page map and metadata shouldn't be reformatted
+    struct stat stat_buf;
+    ASSERT_EQ(stat(map_filename.c_str(), &stat_buf), 0);
+    auto map_size = stat_buf.st_size;
+    ASSERT_EQ(truncate(filename.c_str(), 0), 0);
+    EXPECT_THROW(CompressedDiskManager dm2(filename), Exception);
+    ASSERT_EQ(stat(map_filename.c_str(), &stat_buf), 0);
+    EXPECT_EQ(stat_buf.st_size, map_size);
+
+    // page map without metadata
+    remove(meta_filename.c_str());
+    EXPECT_THROW(CompressedDiskManager dm2(filename), Exception);
+
+    // data without page map and metadata
+    remove(map_filename.c_str());
+    int fd = open(filename.c_str(), O_WRONLY);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, data, PAGE_SIZE), PAGE_SIZE);
+    close(fd);
+    EXPECT_THROW(CompressedDiskManager dm2(filename), Exception);
+
+    RemoveDatabaseFiles(filename);
+}
+
+
+TEST(DiskManagerTest, CompressedDiskManagerConcurrentTest) {
+    std::string filename = "test.db";
+    RemoveDatabaseFiles(filename);
+    auto dm = new CompressedDiskManager(filename);
+
+    // every version of a page has its own content. text versions take a small slot
+    // and random ones take a whole page, so pages keep moving between slots
+    std::mt19937 mt(0);
+    auto make_versions = [&](int page) {
+        std::vector<std::vector<char>> versions(4, std::vector<char>(PAGE_SIZE));
+        for (int v = 0; v < 4; v++) {
+            if (v % 2 == 0) {
+                for (uint32_t j = 0; j + 32 < PAGE_SIZE; j += 32) {
+                    snprintf(versions[v].data() + j, 32, "page %d, version %d, %u", page, v, j);
+                }
+            } else {
+                for (auto &byte : versions[v]) {
+                    byte = static_cast<char>(mt());
+                }
+            }
+        }
+        return versions;
+    };
+    // page a is written by two threads at once, page b has the same sizes as page a,
+    // so it keeps picking up the slots page a gives back
+    auto page_a = dm->AllocatePage();
+    auto page_b = dm->AllocatePage();
+    auto versions_a = make_versions(page_a);
+    auto versions_b = make_versions(page_b);
+    dm->WritePage(page_a, versions_a[0].data());
+    dm->WritePage(page_b, versions_b[0].data());
+
+    auto check = [](const char *data, const std::vector<std::vector<char>> &versions) {
+        for (const auto &version : versions) {
+            if (memcmp(data, version.data(), PAGE_SIZE) == 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const int round = 500;
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 3; i++) {
+        writers.emplace_back([&, i]() {
+            auto page_id = i < 2 ? page_a : page_b;
+            const auto &versions = i < 2 ? versions_a : versions_b;
+            for (int j = 0; j < round; j++) {
+                dm->WritePage(page_id, versions[(i + j) % versions.size()].data());
+            }
+        });
+    }
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 2; i++) {
+        readers.emplace_back([&, i]() {
+            char buffer[PAGE_SIZE];
+            while (!stop.load()) {
+                dm->ReadPage(i == 0 ? page_a : page_b, buffer);
+                EXPECT_TRUE(check(buffer, i == 0 ? versions_a : versions_b));
+            }
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    stop.store(true);
+    for (auto &reader : readers) {
+        reader.join();
+    }
+
+    // no slot is lost or shared
+    char buffer[PAGE_SIZE];
+    dm->ReadPage(page_a, buffer);
+    EXPECT_TRUE(check(buffer, versions_a));
+    dm->ReadPage(page_b, buffer);
+    EXPECT_TRUE(check(buffer, versions_b));
+    EXPECT_LE(dm->GetStoredBytes(), static_cast<uint64_t>(2 * PAGE_SIZE));
+
+    delete dm;
+    RemoveDatabaseFiles(filename);
+}
+
+}
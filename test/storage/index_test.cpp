@@ -11,6 +11,8 @@
 
 #include "storage/index/index_builder.h"
 #include "storage/index/index.h"
+#include "storage/disk/file_disk_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 #include <gtest/gtest.h>
 #include <thread>
@@ -20,10 +22,10 @@ namespace TinyDB {
 TEST(IndexTest, InterfaceTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 50;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     std::vector<Column> cols;
@@ -135,7 +137,7 @@ TEST(IndexTest, InterfaceTest) {
 
     delete disk_manager;
     delete bpm;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 }
\ No newline at end of file
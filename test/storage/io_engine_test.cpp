@@ -0,0 +1,97 @@
+/**
+ * @file io_engine_test.cpp
+ * @author sheep
+ * @brief test for asynchronous io engines
+ * @version 0.1
+ * @date 2022-06-05
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/io_engine.h"
+#include "common/config.h"
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <vector>
+
+namespace TinyDB {
+
+// write pages in a batch and read them back in another batch
+void BatchReadWriteTest(IOEngine *engine) {
+    const std::string filename = "test_io_engine.db";
+    remove(filename.c_str());
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    ASSERT_GE(fd, 0);
+
+    // more than queue depth, so submission has to wait for completions
+    const int page_num = 200;
+    std::vector<char> write_buffer(page_num * PAGE_SIZE);
+    std::vector<char> read_buffer(page_num * PAGE_SIZE);
+    for (int i = 0; i < page_num; i++) {
+        memset(write_buffer.data() + i * PAGE_SIZE, i % 128, PAGE_SIZE);
+    }
+
+    std::vector<IORequest> requests;
+    for (int i = 0; i < page_num; i++) {
+        requests.push_back(IORequest{IOType::WRITE, fd, write_buffer.data() + i * PAGE_SIZE,
+            PAGE_SIZE, static_cast<off_t>(i) * PAGE_SIZE, std::make_shared<IOCompletion>()});
+    }
+    engine->Submit(requests);
+    for (auto &request : requests) {
+        EXPECT_TRUE(request.handle_->Wait());
+        EXPECT_TRUE(request.handle_->IsDone());
+    }
+
+    requests.clear();
+    // read in reverse order, plus a page past end of file
+    for (int i = page_num; i >= 0; i--) {
+        char *buffer = i == page_num ? write_buffer.data() : read_buffer.data() + i * PAGE_SIZE;
+        requests.push_back(IORequest{IOType::READ, fd, buffer,
+            PAGE_SIZE, static_cast<off_t>(i) * PAGE_SIZE, std::make_shared<IOCompletion>()});
+    }
+    engine->Submit(requests);
+    for (auto &request : requests) {
+        EXPECT_TRUE(request.handle_->Wait());
+    }
+
+    // reading past end of file should give us zero page
+    for (uint32_t i = 0; i < PAGE_SIZE; i++) {
+        EXPECT_EQ(write_buffer[i], 0);
+    }
+    for (int i = 1; i < page_num; i++) {
+        EXPECT_EQ(read_buffer[i * PAGE_SIZE], i % 128);
+        EXPECT_EQ(read_buffer[i * PAGE_SIZE + PAGE_SIZE - 1], i % 128);
+    }
+
+    close(fd);
+    remove(filename.c_str());
+}
+
+TEST(IOEngineTest, ThreadPoolTest) {
+    auto engine = IOEngine::Create(IOEngineType::THREAD_POOL, 4);
+    ASSERT_NE(engine, nullptr);
+    EXPECT_EQ(engine->GetType(), IOEngineType::THREAD_POOL);
+    BatchReadWriteTest(engine.get());
+}
+
+TEST(IOEngineTest, IOUringTest) {
+    auto engine = IOEngine::Create(IOEngineType::IO_URING, 16);
+    if (engine == nullptr) {
+        GTEST_SKIP() << "io_uring is not supported";
+    }
+    EXPECT_EQ(engine->GetType(), IOEngineType::IO_URING);
+    BatchReadWriteTest(engine.get());
+}
+
+TEST(IOEngineTest, AutoTest) {
+    // auto should always give us an engine
+    auto engine = IOEngine::Create(IOEngineType::AUTO, 8);
+    ASSERT_NE(engine, nullptr);
+    BatchReadWriteTest(engine.get());
+}
+
+}
@@ -0,0 +1,207 @@
+/**
+ * @file optimistic_latch_test.cpp
+ * @author sheep
+ * @brief unit test for optimistic page reads
+ * @version 0.1
+ * @date 2022-06-29
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/page.h"
+#include "storage/table/table_heap.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(OptimisticLatchTest, VersionTest) {
+    Page page;
+    uint64_t version;
+    ASSERT_TRUE(page.TryOptimisticRLatch(&version));
+    EXPECT_TRUE(page.ValidateOptimisticRLatch(version));
+
+    // readers don't change the version
+    page.RLatch();
+    uint64_t other;
+    EXPECT_TRUE(page.TryOptimisticRLatch(&other));
+    EXPECT_EQ(version, other);
+    page.RUnlatch();
+    EXPECT_TRUE(page.ValidateOptimisticRLatch(version));
+
+    // writer is in, optimistic readers have to wait
+    page.WLatch();
+    EXPECT_FALSE(page.TryOptimisticRLatch(&other));
+    EXPECT_FALSE(page.ValidateOptimisticRLatch(version));
+    page.WUnlatch();
+    EXPECT_FALSE(page.ValidateOptimisticRLatch(version));
+    ASSERT_TRUE(page.TryOptimisticRLatch(&other));
+    EXPECT_NE(version, other);
+    EXPECT_TRUE(page.ValidateOptimisticRLatch(other));
+}
+
+TEST(OptimisticLatchTest, BPlusTreeTest) {
+    MemoryDiskManager disk_manager;
+    // small pool, so that lookups have to load some pages
+    BufferPoolManagerInstance bpm(64, &disk_manager);
+
+    auto schema = Schema({Column("colA", TypeId::BIGINT)});
+    GenericComparator<8> comparator(&schema);
+    // small nodes to get a deep tree with lots of splits and merges
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("optimistic_test", &bpm, comparator, 8, 8);
+    auto make_key = [&](int64_t key) {
+        GenericKey<8> index_key;
+        index_key.SetFromKey(Tuple({Value(TypeId::BIGINT, key)}, &schema));
+        return index_key;
+    };
+
+    // even keys stay in the tree, odd keys come and go
+    const int64_t key_num = 2000;
+    BPlusTreeExecutionContext context;
+    for (int64_t key = 0; key < key_num; key += 2) {
+        context.Reset();
+        EXPECT_TRUE(tree.Insert(make_key(key), RID(key), &context));
+    }
+
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 2; i++) {
+        writers.emplace_back([&](int seed) {
+            std::mt19937 rng(seed);
+            BPlusTreeExecutionContext context;
+            while (!stop.load()) {
+                int64_t key = (rng() % (key_num / 2)) * 2 + 1;
+                context.Reset();
+                if (!tree.Insert(make_key(key), RID(key), &context)) {
+                    context.Reset();
+                    tree.Remove(make_key(key), &context);
+                }
+            }
+        }, i);
+    }
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&](int seed) {
+            std::mt19937 rng(seed);
+            for (int j = 0; j < 20000; j++) {
+                int64_t key = rng() % key_num;
+                std::vector<RID> result;
+                bool found = tree.GetValue(make_key(key), &result);
+                if (key % 2 == 0) {
+                    ASSERT_TRUE(found);
+                    ASSERT_EQ(1, result.size());
+                    EXPECT_EQ(RID(key), result[0]);
+                } else if (found) {
+                    ASSERT_EQ(1, result.size());
+                    EXPECT_EQ(RID(key), result[0]);
+                }
+            }
+        }, i + 100);
+    }
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    stop.store(true);
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(OptimisticLatchTest, StatsTest) {
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(64, &disk_manager);
+
+    auto schema = Schema({Column("colA", TypeId::BIGINT)});
+    GenericComparator<8> comparator(&schema);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("optimistic_stats_test", &bpm, comparator, 8, 8);
+    auto make_key = [&](int64_t key) {
+        GenericKey<8> index_key;
+        index_key.SetFromKey(Tuple({Value(TypeId::BIGINT, key)}, &schema));
+        return index_key;
+    };
+    BPlusTreeExecutionContext context;
+    for (int64_t key = 0; key < 4; key++) {
+        context.Reset();
+        EXPECT_TRUE(tree.Insert(make_key(key), RID(key), &context));
+    }
+
+    // peeking at a page doesn't count
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm.NewPage(&page_id));
+    EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    bpm.ResetStats();
+    ASSERT_NE(nullptr, bpm.FetchResidentPage(page_id));
+    EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    EXPECT_EQ(0, bpm.GetStats().hits_);
+
+    // tree is a single leaf, every lookup is one hit
+    for (int64_t key = 0; key < 4; key++) {
+        std::vector<RID> result;
+        EXPECT_TRUE(tree.GetValue(make_key(key), &result));
+    }
+    auto stats = bpm.GetStats();
+    EXPECT_EQ(4, stats.hits_);
+    EXPECT_EQ(0, stats.misses_);
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+TEST(OptimisticLatchTest, TableHeapTest) {
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(16, &disk_manager);
+
+    auto schema = Schema({Column("colA", TypeId::BIGINT), Column("colB", TypeId::VARCHAR, 20)});
+    // same size, so that updates are done in place
+    auto tuple_a = Tuple({Value(TypeId::BIGINT, static_cast<int64_t>(1)), Value(TypeId::VARCHAR, "hello world!")}, &schema);
+    auto tuple_b = Tuple({Value(TypeId::BIGINT, static_cast<int64_t>(2)), Value(TypeId::VARCHAR, "hello tinydb")}, &schema);
+
+    auto table = std::unique_ptr<TableHeap>(TableHeap::CreateNewTableHeap(&bpm));
+    const int tuple_num = 16;
+    std::vector<RID> rids(tuple_num);
+    for (auto &rid : rids) {
+        ASSERT_TRUE(table->InsertTuple(tuple_a, &rid).IsOk());
+    }
+
+    // writer keeps flipping the tuples, readers should never see half of each
+    std::atomic<bool> stop(false);
+    std::thread writer([&]() {
+        for (int i = 0; !stop.load(); i++) {
+            EXPECT_TRUE(table->UpdateTuple(i % 2 == 0 ? tuple_b : tuple_a, rids[i % tuple_num]).IsOk());
+        }
+    });
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&]() {
+            for (int j = 0; j < 20000; j++) {
+                Tuple tuple;
+                ASSERT_TRUE(table->GetTuple(rids[j % tuple_num], &tuple).IsOk());
+                EXPECT_TRUE(tuple == tuple_a || tuple == tuple_b);
+                EXPECT_EQ(rids[j % tuple_num], tuple.GetRID());
+            }
+        });
+    }
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    stop.store(true);
+    writer.join();
+
+    // deleted tuple is skipped
+    ASSERT_TRUE(table->MarkDelete(rids[0]).IsOk());
+    Tuple tuple;
+    EXPECT_FALSE(table->GetTuple(rids[0], &tuple).IsOk());
+    EXPECT_TRUE(bpm.CheckPinCount());
+}
+
+}
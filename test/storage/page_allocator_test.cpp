@@ -0,0 +1,201 @@
+/**
+ * @file page_allocator_test.cpp
+ * @author sheep
+ * @brief test for page allocator
+ * @version 0.1
+ * @date 2022-06-08
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#include "storage/disk/page_allocator.h"
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <set>
+#include <vector>
+
+namespace TinyDB {
+
+TEST(PageAllocatorTest, ReuseTest) {
+    const std::string filename = "test_allocator.meta";
+    remove(filename.c_str());
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    ASSERT_GE(fd, 0);
+
+    const uint32_t extent_size = 16;
+    std::vector<std::pair<page_id_t, page_id_t>> extend_list;
+    PageAllocator allocator(fd, extent_size, [&](page_id_t begin, page_id_t end) {
+        extend_list.emplace_back(begin, end);
+    });
+    allocator.Format(0);
+    EXPECT_EQ(allocator.GetPageCount(), 0);
+
+    // file grows in extents
+    for (page_id_t i = 0; i < 40; i++) {
+        EXPECT_EQ(allocator.AllocatePage(), i);
+    }
+    EXPECT_EQ(allocator.GetPageCount(), 48);
+    EXPECT_EQ(allocator.GetFreePageCount(), 8);
+    ASSERT_EQ(extend_list.size(), 3);
+    EXPECT_EQ(extend_list[0], std::make_pair(0, 16));
+    EXPECT_EQ(extend_list[2], std::make_pair(32, 48));
+
+    // deallocated pages are reused, lowest one first
+    EXPECT_TRUE(allocator.DeallocatePage(7));
+    EXPECT_TRUE(allocator.DeallocatePage(3));
+    EXPECT_FALSE(allocator.DeallocatePage(3));
+    EXPECT_FALSE(allocator.IsAllocated(3));
+    EXPECT_EQ(allocator.AllocatePage(), 3);
+    EXPECT_EQ(allocator.AllocatePage(), 7);
+    EXPECT_EQ(allocator.AllocatePage(), 40);
+    EXPECT_EQ(extend_list.size(), 3);
+
+    close(fd);
+    remove(filename.c_str());
+}
+
+TEST(PageAllocatorTest, ExtentTest) {
+    const std::string filename = "test_allocator.meta";
+    remove(filename.c_str());
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    ASSERT_GE(fd, 0);
+
+    const uint32_t extent_size = 8;
+    PageAllocator allocator(fd, extent_size, [](page_id_t begin, page_id_t end) {});
+    allocator.Format(0);
+
+    // leave some free extents behind, e.g. a table was dropped
+    page_id_t dropped = allocator.AllocateExtent(extent_size * 8);
+    for (page_id_t i = dropped; i < dropped + static_cast<page_id_t>(extent_size) * 8; i++) {
+        allocator.DeallocatePage(i);
+    }
+    EXPECT_EQ(allocator.GetFreePageCount(), allocator.GetPageCount());
+
+    // two chains allocating interleaved, each of them should stay sequential
+    // as long as there are free extents to start a new one
+    page_id_t chain_a = allocator.AllocatePage();
+    page_id_t chain_b = allocator.AllocatePage(chain_a);
+    EXPECT_EQ(chain_b, chain_a + 1);
+    std::vector<page_id_t> list_a{chain_a};
+    std::vector<page_id_t> list_b;
+    chain_b = allocator.AllocatePage(INVALID_PAGE_ID);
+    list_b.push_back(chain_b);
+    for (int i = 0; i < 20; i++) {
+        list_a.push_back(allocator.AllocatePage(list_a.back()));
+        list_b.push_back(allocator.AllocatePage(list_b.back()));
+    }
+    // within an extent, pages of a chain are contiguous
+    int contiguous = 0;
+    for (size_t i = 1; i < list_a.size(); i++) {
+        contiguous += list_a[i] == list_a[i - 1] + 1;
+    }
+    EXPECT_GE(contiguous, 14);
+    EXPECT_EQ(allocator.GetPageCount(), static_cast<page_id_t>(extent_size) * 8);
+
+    // contiguous extent, after the rest of free pages are used up
+    while (allocator.GetFreePageCount() > 0) {
+        allocator.AllocatePage();
+    }
+    page_id_t first = allocator.AllocateExtent(20);
+    for (page_id_t i = first; i < first + 20; i++) {
+        EXPECT_TRUE(allocator.IsAllocated(i));
+    }
+    EXPECT_GE(allocator.GetPageCount(), first + 20);
+
+    // extent could reuse the hole
+    for (page_id_t i = first + 5; i < first + 15; i++) {
+        allocator.DeallocatePage(i);
+    }
+    EXPECT_EQ(allocator.AllocateExtent(10), first + 5);
+
+    close(fd);
+    remove(filename.c_str());
+}
+
+TEST(PageAllocatorTest, PersistenceTest) {
+    const std::string filename = "test_allocator.meta";
+    remove(filename.c_str());
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    ASSERT_GE(fd, 0);
+
+    std::set<page_id_t> freed;
+    {
+        PageAllocator allocator(fd, 32, [](page_id_t begin, page_id_t end) {});
+        EXPECT_FALSE(allocator.Load());
+        allocator.Format(10);
+        for (int i = 0; i < 200; i++) {
+            allocator.AllocatePage();
+        }
+        for (page_id_t i = 0; i < 210; i += 7) {
+            allocator.DeallocatePage(i);
+            freed.insert(i);
+        }
+    }
+
+    PageAllocator allocator(fd, 1, [](page_id_t begin, page_id_t end) {});
+    ASSERT_TRUE(allocator.Load());
+    EXPECT_EQ(allocator.GetPageCount(), 224);
+    for (page_id_t i = 0; i < 210; i++) {
+        EXPECT_EQ(allocator.IsAllocated(i), freed.count(i) == 0);
+    }
+    // freed pages come back first
+    for (size_t i = 0; i < freed.size(); i++) {
+        EXPECT_EQ(freed.count(allocator.AllocatePage()), 1);
+    }
+    EXPECT_EQ(allocator.AllocatePage(), 210);
+
+    close(fd);
+    remove(filename.c_str());
+}
+
+TEST(PageAllocatorTest, HoleReuseTest) {
+    const std::string filename = "test_allocator.meta";
+    remove(filename.c_str());
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    ASSERT_GE(fd, 0);
+
+    const uint32_t extent_size = 16;
+    PageAllocator allocator(fd, extent_size, [](page_id_t begin, page_id_t end) {});
+    allocator.Format(0);
+
+    // a chain filling up the data file
+    std::vector<page_id_t> chain{allocator.AllocatePage()};
+    for (int i = 1; i < 64; i++) {
+        chain.push_back(allocator.AllocatePage(chain.back()));
+    }
+    EXPECT_EQ(allocator.GetPageCount(), 64);
+
+    // deletes leave scattered holes, none of the extents is free
+    std::set<page_id_t> freed;
+    for (page_id_t i = 3; i < 64; i += 5) {
+        allocator.DeallocatePage(i);
+        freed.insert(i);
+    }
+
+    // chain keeps growing from its last page, its extent is full. holes are refilled,
+    // lowest one first, before data file grows
+    for (auto page_id : freed) {
+        chain.push_back(allocator.AllocatePage(chain.back()));
+        EXPECT_EQ(chain.back(), page_id);
+    }
+    EXPECT_EQ(allocator.GetPageCount(), 64);
+    EXPECT_EQ(allocator.GetFreePageCount(), 0);
+    EXPECT_EQ(allocator.AllocatePage(chain.back()), 64);
+
+    // a free extent is preferred over holes, so that the chain stays sequential
+    for (page_id_t i = 16; i < 32; i++) {
+        allocator.DeallocatePage(i);
+    }
+    allocator.DeallocatePage(5);
+    EXPECT_EQ(allocator.AllocatePage(63), 16);
+    EXPECT_EQ(allocator.AllocatePage(16), 17);
+    EXPECT_EQ(allocator.AllocatePage(), 5);
+
+    close(fd);
+    remove(filename.c_str());
+}
+
+}
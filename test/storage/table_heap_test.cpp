@@ -10,6 +10,9 @@
  */
 
 #include "storage/table/table_heap.h"
+#include "storage/disk/file_disk_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 #include <gtest/gtest.h>
 
@@ -18,10 +21,10 @@ namespace TinyDB {
 TEST(TableHeapTest, BasicTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 3;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     auto colB = Column("colB", TypeId::VARCHAR, 20);
@@ -83,7 +86,7 @@ TEST(TableHeapTest, BasicTest) {
         EXPECT_EQ(table->GetTuple(tuple_list[i], &tmp).IsOk(), false);
     }
 
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
     delete table;
     delete bpm;
     delete disk_manager;
@@ -92,10 +95,10 @@ TEST(TableHeapTest, BasicTest) {
 TEST(TableHeapTest, IteratorTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 3;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     auto colB = Column("colB", TypeId::VARCHAR, 20);
@@ -162,10 +165,52 @@ TEST(TableHeapTest, IteratorTest) {
     it = table->Begin();
     EXPECT_EQ(it, table->End());
 
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
     delete table;
     delete bpm;
     delete disk_manager;
 }
 
-}
\ No newline at end of file
+TEST(TableHeapTest, AccessStrategyTest) {
+    const size_t buffer_pool_size = 32;
+    MemoryDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+
+    auto schema = Schema({Column("colA", TypeId::BIGINT), Column("colB", TypeId::VARCHAR, 100)});
+    auto tuple = Tuple({Value(TypeId::BIGINT, static_cast<int64_t> (42)), Value(TypeId::VARCHAR, std::string(80, 'x'))}, &schema);
+
+    // pages used by others
+    std::vector<page_id_t> hot(8);
+    for (auto &page_id : hot) {
+        ASSERT_NE(bpm.NewPage(&page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+    }
+
+    // bulk insert, table is several times larger than the buffer pool
+    TableHeap table(&bpm);
+    BufferAccessStrategy write_strategy(4);
+    int tuple_num = 4000;
+    for (int i = 0; i < tuple_num; i++) {
+        RID rid;
+        EXPECT_TRUE(table.InsertTuple(tuple, &rid, nullptr, nullptr, &write_strategy).IsOk());
+    }
+
+    // full scan
+    BufferAccessStrategy read_strategy(4);
+    int cnt = 0;
+    for (auto it = table.Begin(&read_strategy); it != table.End(); ++it, ++cnt) {
+        EXPECT_EQ(*it == tuple, true);
+    }
+    EXPECT_EQ(cnt, tuple_num);
+    EXPECT_TRUE(bpm.CheckPinCount());
+
+    // neither of them has pushed out the hot pages
+    disk_manager.ResetIOStats();
+    for (auto page_id : hot) {
+        EXPECT_NE(bpm.FetchPage(page_id), nullptr);
+        EXPECT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+    EXPECT_EQ(0, disk_manager.GetIOStats().page_read_.ops_);
+}
+
+}
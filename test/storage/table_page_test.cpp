@@ -10,7 +10,8 @@
  */
 
 #include "storage/page/table_page.h"
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk/file_disk_manager.h"
 
 #include <gtest/gtest.h>
 #include <random>
@@ -21,10 +22,10 @@ namespace TinyDB {
 TEST(TablePageTest, BasicTest) {
     const std::string filename = "test.db";
     const size_t buffer_pool_size = 1;
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 
-    auto disk_manager = new DiskManager(filename);
-    auto bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto disk_manager = new FileDiskManager(filename);
+    auto bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
     auto colA = Column("colA", TypeId::BIGINT);
     auto colB = Column("colB", TypeId::VARCHAR, 20);
@@ -146,7 +147,7 @@ TEST(TablePageTest, BasicTest) {
     delete bpm;
     delete disk_manager;
 
-    remove(filename.c_str());
+    RemoveDatabaseFiles(filename);
 }
 
 }
\ No newline at end of file